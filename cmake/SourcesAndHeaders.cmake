@@ -2,48 +2,119 @@ set(sources
   src/simple_3d_viewer/Viewer.cpp
   src/simple_3d_viewer/ImGuiWrapper.cpp
   src/simple_3d_viewer/Mediator.cpp
+  src/simple_3d_viewer/RenderThread.cpp
+  src/simple_3d_viewer/ViewerControls.cpp
   src/simple_3d_viewer/rendering/Camera.cpp
+  src/simple_3d_viewer/rendering/CameraPath.cpp
+  src/simple_3d_viewer/rendering/GpuProfiler.cpp
   src/simple_3d_viewer/rendering/Material.cpp
   src/simple_3d_viewer/rendering/Mesh.cpp
   src/simple_3d_viewer/rendering/Model.cpp
+  src/simple_3d_viewer/rendering/ModelCache.cpp
+  src/simple_3d_viewer/rendering/ModelRaycaster.cpp
+  src/simple_3d_viewer/rendering/ModelUploader.cpp
+  src/simple_3d_viewer/rendering/OcclusionQueries.cpp
   src/simple_3d_viewer/rendering/PostprocessPipeline.cpp
+  src/simple_3d_viewer/rendering/RenderGraph.cpp
   src/simple_3d_viewer/rendering/Renderer.cpp
+  src/simple_3d_viewer/rendering/ResolutionScaler.cpp
   src/simple_3d_viewer/rendering/Scene.cpp
+  src/simple_3d_viewer/opengl_object_wrappers/Framebuffer.cpp
   src/simple_3d_viewer/opengl_object_wrappers/Program.cpp
   src/simple_3d_viewer/opengl_object_wrappers/Texture.cpp
+  src/simple_3d_viewer/linear_algebra/boundingVolumeHierarchy.cpp
+  src/simple_3d_viewer/linear_algebra/boundingVolumes.cpp
+  src/simple_3d_viewer/linear_algebra/frustumCulling.cpp
   src/simple_3d_viewer/linear_algebra/meshGeneration.cpp
+  src/simple_3d_viewer/linear_algebra/meshOptimization.cpp
+  src/simple_3d_viewer/linear_algebra/meshSimplification.cpp
+  src/simple_3d_viewer/linear_algebra/occlusionCulling.cpp
   src/simple_3d_viewer/linear_algebra/Transform.cpp
+  src/simple_3d_viewer/linear_algebra/triangleHierarchy.cpp
+  src/simple_3d_viewer/linear_algebra/vertexCompression.cpp
   src/simple_3d_viewer/utils/fileOperations.cpp
   src/simple_3d_viewer/utils/Image.cpp
+  src/simple_3d_viewer/utils/jsonEscaping.cpp
+  src/simple_3d_viewer/utils/MappedFile.cpp
+  src/simple_3d_viewer/utils/processCpuTime.cpp
+  src/simple_3d_viewer/utils/Profiler.cpp
+  src/simple_3d_viewer/utils/RedrawScheduler.cpp
   src/simple_3d_viewer/utils/simpleIdGenerator.cpp
+  src/simple_3d_viewer/utils/ThreadPool.cpp
 )
 
 set(exe_sources
   src/simple_3d_viewer/main.cpp
 )
 
+set(benchmark_sources
+  src/simple_3d_viewer/benchmark.cpp
+  src/simple_3d_viewer/utils/HeadlessContext.cpp
+)
+
+set(microbench_sources
+  src/simple_3d_viewer/microbench.cpp
+  src/simple_3d_viewer/utils/HeadlessContext.cpp
+)
+
+set(test_sources
+  src/fileOperations_test.cpp
+  src/jsonEscaping_test.cpp
+  src/ModelCache_test.cpp
+  src/occlusionCulling_test.cpp
+)
+
 set(headers
   include/simple_3d_viewer/Viewer.hpp
+  include/simple_3d_viewer/FrameSnapshot.hpp
   include/simple_3d_viewer/ImGuiWrapper.hpp
   include/simple_3d_viewer/Mediator.hpp
+  include/simple_3d_viewer/RenderThread.hpp
+  include/simple_3d_viewer/ViewerControls.hpp
   include/simple_3d_viewer/rendering/Camera.hpp
+  include/simple_3d_viewer/rendering/CameraPath.hpp
+  include/simple_3d_viewer/rendering/GpuProfiler.hpp
   include/simple_3d_viewer/rendering/Material.hpp
   include/simple_3d_viewer/rendering/Mesh.hpp
   include/simple_3d_viewer/rendering/Model.hpp
+  include/simple_3d_viewer/rendering/ModelCache.hpp
+  include/simple_3d_viewer/rendering/ModelRaycaster.hpp
+  include/simple_3d_viewer/rendering/ModelUploader.hpp
+  include/simple_3d_viewer/rendering/OcclusionQueries.hpp
   include/simple_3d_viewer/rendering/PostprocessPipeline.hpp
+  include/simple_3d_viewer/rendering/RenderGraph.hpp
   include/simple_3d_viewer/rendering/Renderer.hpp
+  include/simple_3d_viewer/rendering/ResolutionScaler.hpp
   include/simple_3d_viewer/rendering/Scene.hpp
+  include/simple_3d_viewer/opengl_object_wrappers/Framebuffer.hpp
   include/simple_3d_viewer/opengl_object_wrappers/Program.hpp
   include/simple_3d_viewer/opengl_object_wrappers/Texture.hpp
+  include/simple_3d_viewer/linear_algebra/boundingVolumeHierarchy.hpp
+  include/simple_3d_viewer/linear_algebra/boundingVolumes.hpp
+  include/simple_3d_viewer/linear_algebra/frustumCulling.hpp
   include/simple_3d_viewer/linear_algebra/meshGeneration.hpp
+  include/simple_3d_viewer/linear_algebra/meshOptimization.hpp
+  include/simple_3d_viewer/linear_algebra/meshSimplification.hpp
+  include/simple_3d_viewer/linear_algebra/occlusionCulling.hpp
   include/simple_3d_viewer/linear_algebra/Transform.hpp
+  include/simple_3d_viewer/linear_algebra/triangleHierarchy.hpp
   include/simple_3d_viewer/linear_algebra/Vertex.hpp
+  include/simple_3d_viewer/linear_algebra/VertexLayout.hpp
+  include/simple_3d_viewer/linear_algebra/vertexCompression.hpp
   include/simple_3d_viewer/utils/constants.hpp
   include/simple_3d_viewer/utils/factories.hpp
   include/simple_3d_viewer/utils/fileOperations.hpp
   include/simple_3d_viewer/utils/glfwUtils.hpp
+  include/simple_3d_viewer/utils/HeadlessContext.hpp
   include/simple_3d_viewer/utils/Size.hpp
   include/simple_3d_viewer/utils/Image.hpp
+  include/simple_3d_viewer/utils/jsonEscaping.hpp
+  include/simple_3d_viewer/utils/MappedFile.hpp
+  include/simple_3d_viewer/utils/processCpuTime.hpp
+  include/simple_3d_viewer/utils/Profiler.hpp
+  include/simple_3d_viewer/utils/RedrawScheduler.hpp
   include/simple_3d_viewer/utils/simpleIdGenerator.hpp
   include/simple_3d_viewer/utils/StringHeterogeneousLookup.hpp
+  include/simple_3d_viewer/utils/ThreadPool.hpp
+  include/simple_3d_viewer/utils/TripleBuffer.hpp
 )
@@ -1,12 +1,17 @@
 # Project settings
 option(${PROJECT_NAME}_BUILD_EXECUTABLE "Build the project as an executable, rather than a library." ON)
+option(${PROJECT_NAME}_BUILD_BENCHMARK "Build the headless benchmark executable, which needs EGL." OFF)
+option(${PROJECT_NAME}_BUILD_MICROBENCH "Build the Google Benchmark suite of the CPU side hot paths, which needs EGL." OFF)
 option(${PROJECT_NAME}_USE_ALT_NAMES "Use alternative names for the project, such as naming the include directory all lowercase." ON)
 
 # Compiler options
 option(${PROJECT_NAME}_WARNINGS_AS_ERRORS "Treat compiler warnings as errors." OFF)
 
+# Profiling
+option(${PROJECT_NAME}_ENABLE_PROFILER "Record the zones of the CPU profiler, without it they compile to nothing." ON)
+
 # Unit testing
-option(${PROJECT_NAME}_ENABLE_UNIT_TESTING "Enable unit tests for the projects (from the `test` subfolder)." ON)
+option(${PROJECT_NAME}_ENABLE_UNIT_TESTING "Enable unit tests for the projects (from the `test` subfolder)." OFF)
 
 option(${PROJECT_NAME}_USE_GTEST "Use the GoogleTest project for creating unit tests." ON)
 option(${PROJECT_NAME}_USE_GOOGLE_MOCK "Use the GoogleMock project for extending the unit tests." OFF)
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <simple_3d_viewer/ImGuiWrapper.hpp>
+#include <simple_3d_viewer/linear_algebra/Transform.hpp>
+#include <simple_3d_viewer/rendering/Model.hpp>
+#include <simple_3d_viewer/rendering/ModelUploader.hpp>
+#include <simple_3d_viewer/rendering/PostprocessPipeline.hpp>
+#include <simple_3d_viewer/rendering/ResolutionScaler.hpp>
+#include <simple_3d_viewer/utils/RedrawScheduler.hpp>
+#include <simple_3d_viewer/utils/Size.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Simple3D
+{
+
+// Everything the render thread needs for a frame, built by the main thread
+// and not changed afterwards
+struct FrameSnapshot
+{
+  using Clock = std::chrono::steady_clock;
+
+  // Stay the same until the GUI changes them
+  struct Settings
+  {
+    // Whether each is active, the pipeline orders them by when they were
+    // turned on
+    std::vector<std::pair<PostprocessID, bool>> postprocesses;
+    glm::vec3 lightPosition{};
+    Transform modelTransform{ {}, {}, { 1.f, 1.f, 1.f } };
+    bool drawLight{ true };
+    bool frustumCulling{ true };
+    bool occlusionCulling{ false };
+    bool occlusionQueries{ false };
+    float maxLodError{ 1.f };
+    bool keepLastFrame{ false };
+    ResolutionScaler::Settings resolutionScaler{
+      ResolutionScaler::Mode::Automatic,
+      ResolutionScaler::kMaxScale,
+      ResolutionScaler::Duration(1000. / 60.)
+    };
+    Model::Configuration modelConfiguration;
+    ModelUploader::Budget modelUploadBudget{
+      32 * 1024 * 1024, std::chrono::milliseconds(4)
+    };
+  };
+
+  // Each request is counted, the render thread carries out the ones it
+  // hasn't seen yet. Only the latest one of a kind is kept.
+  struct Requests
+  {
+    uint64_t loadModelCount{};
+    std::filesystem::path modelPath;
+    uint64_t reloadProgramCount{};
+    uint64_t pickCount{};
+    // Relative to the framebuffer from (0, 0) in the top left corner to
+    // (1, 1) in the bottom right one
+    glm::vec2 pickPosition{};
+    uint64_t exportCpuTraceCount{};
+  };
+
+  Settings settings;
+  Requests requests;
+  glm::vec3 cameraPosition{};
+  glm::vec3 cameraOrientation{};
+  Size framebufferSize{};
+  RedrawScheduler::Redraw redraw{ RedrawScheduler::Redraw::Scene };
+  ImGuiWrapper::DrawData gui;
+  // When the input the frame reacts to was polled
+  Clock::time_point inputTime;
+};
+
+}  // namespace Simple3D
@@ -33,19 +33,28 @@ struct Checkbox
 
 using Checkboxes = std::vector<Checkbox>;
 
+using ReportLines = std::vector<std::string>;
+
 class ImGuiWrapper
 {
  public:
   enum class Event
   {
+    // At the start of every GUI frame, before any controls are drawn
+    NewFrame,
     PostprocessesControlsChange,
     LightingControlsChange,
     VisualizeLightPositionCheckboxChange,
     ModelControlsChange,
     ModelLoadingConfigurationChange,
+    ModelUploadControlsChange,
+    RenderingControlsChange,
     CameraControlsChange,
+    FramePacingControlsChange,
     LoadModel,
     ReloadProgram,
+    Pick,
+    ExportCpuTrace,
   };
 
   // We will notify the outside world about different events through an object
@@ -58,6 +67,48 @@ class ImGuiWrapper
     virtual void notify(Event e) = 0;
   };
 
+  // Produced while rendering, drawn into the settings window
+  struct Reports
+  {
+    ReportLines modelLoading;
+    ReportLines modelUpload;
+    ReportLines rendering;
+    // Plotted below the rendering report
+    std::vector<float> renderScaleHistory;
+    ReportLines picking;
+    ReportLines gpuTimings;
+    ReportLines cpuTrace;
+    ReportLines presentation;
+    // A new error opens the error popup
+    size_t errorsCount{};
+    std::string lastErrorMessage;
+  };
+
+  // Copy of the draw lists of a GUI frame, rendered on another thread while
+  // the next frame is being built
+  class DrawData
+  {
+   public:
+    void copy(const ImDrawData& drawData);
+
+    void render() const;
+
+   private:
+    struct DrawListDeleter
+    {
+      void operator()(ImDrawList* drawList) const
+      {
+        IM_DELETE(drawList);
+      }
+    };
+
+    std::vector<std::unique_ptr<ImDrawList, DrawListDeleter>> drawLists_;
+    std::vector<ImDrawList*> drawListsPointers_;
+    ImDrawData drawData_{};
+  };
+
+  // The OpenGL context has to be current, the GPU objects of the GUI are
+  // created right away so that later frames don't need it
   ImGuiWrapper(
       GLFWwindow* window,
       const std::vector<std::string>& postprocesses);
@@ -68,10 +119,11 @@ class ImGuiWrapper
 
   void release();
 
-  void render();
-
   void update();
 
+  // Ends the frame started by update
+  void finishFrame(DrawData& drawData);
+
   void setMediator(std::shared_ptr<Mediator> mediator)
   {
     mediator_ = std::move(mediator);
@@ -107,15 +159,44 @@ class ImGuiWrapper
     return modelTransformSliders_;
   }
 
+  [[nodiscard]] const Sliders& getModelUploadControlsSliders() const
+  {
+    return modelUploadControlsSliders_;
+  }
+
+  [[nodiscard]] const Sliders& getRenderingControlsSliders() const
+  {
+    return renderingControlsSliders_;
+  }
+
+  [[nodiscard]] const Checkboxes& getRenderingControlsCheckboxes() const
+  {
+    return renderingControlsCheckboxes_;
+  }
+
+  [[nodiscard]] const Checkboxes& getFramePacingControlsCheckboxes() const
+  {
+    return framePacingControlsCheckboxes_;
+  }
+
   [[nodiscard]] const Sliders& getCameraControlsSliders() const
   {
     return cameraControlsSliders_;
   }
 
-  void printError(std::string_view errorMessage)
+  // Of the last click which wasn't on the GUI, relative to the display from
+  // (0, 0) in the top left corner to (1, 1) in the bottom right one
+  [[nodiscard]] const ImVec2& getPickPosition() const
   {
-    cachedErrorMessage_ = errorMessage;
-    ImGui::OpenPopup("errorPopup");
+    return pickPosition_;
+  }
+
+  // Only during a frame, a new error is shown right away
+  void setReports(const Reports& reports);
+
+  void setFramePacingReport(ReportLines report)
+  {
+    framePacingReport_ = std::move(report);
   }
 
  private:
@@ -125,10 +206,24 @@ class ImGuiWrapper
   Checkboxes lightControlsCheckboxes_;
   Sliders modelTransformSliders_;
   Checkboxes modelLoadingConfigurationCheckboxes_;
+  Sliders modelUploadControlsSliders_;
+  Sliders renderingControlsSliders_;
+  Checkboxes renderingControlsCheckboxes_;
+  Checkboxes framePacingControlsCheckboxes_;
   Sliders cameraControlsSliders_;
   std::filesystem::path modelFilePath_;
+  Reports reports_;
+  ImVec2 pickPosition_;
+  ReportLines framePacingReport_;
   std::string cachedErrorMessage_;
 
+  void printError(std::string_view errorMessage)
+  {
+    cachedErrorMessage_ = errorMessage;
+    ImGui::OpenPopup("errorPopup");
+  }
+
   void drawSettingsWindow();
+  void checkPick();
 };
 }  // namespace Simple3D
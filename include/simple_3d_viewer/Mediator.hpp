@@ -3,10 +3,15 @@
 #include <memory>
 #include <simple_3d_viewer/ImGuiWrapper.hpp>
 #include <simple_3d_viewer/Viewer.hpp>
+#include <simple_3d_viewer/ViewerControls.hpp>
+#include <simple_3d_viewer/utils/TripleBuffer.hpp>
 
 namespace Simple3D
 {
 
+// The GUI events arrive on the main thread and change the controls, the
+// viewer events arrive on the render thread and update the reports, which
+// are handed over to the GUI at the start of its next frame
 class Mediator : public ImGuiWrapper::Mediator, public Viewer::Mediator
 {
  public:
@@ -14,9 +19,13 @@ class Mediator : public ImGuiWrapper::Mediator, public Viewer::Mediator
   using ViewerEvent = Viewer::Event;
   using ViewerError = Viewer::Error;
 
-  static void setupCommunication(ImGuiWrapper& imGuiWrapper, Viewer& viewer)
+  static void setupCommunication(
+      ImGuiWrapper& imGuiWrapper,
+      ViewerControls& viewerControls,
+      Viewer& viewer)
   {
-    auto mediator = std::make_shared<Mediator>(Mediator(imGuiWrapper, viewer));
+    auto mediator = std::make_shared<Mediator>(
+        Mediator(imGuiWrapper, viewerControls, viewer));
     imGuiWrapper.setMediator(mediator);
     viewer.setMediator(std::move(mediator));
   }
@@ -26,14 +35,28 @@ class Mediator : public ImGuiWrapper::Mediator, public Viewer::Mediator
   void notify(ViewerError e, const std::string& errorMessage) override;
 
  private:
-  Mediator(ImGuiWrapper& imGuiWrapper, Viewer& viewer)
+  Mediator(
+      ImGuiWrapper& imGuiWrapper,
+      ViewerControls& viewerControls,
+      Viewer& viewer)
       : viewer_(viewer),
+        viewerControls_(viewerControls),
         imGuiWrapper_(imGuiWrapper)
   {
   }
 
   Viewer& viewer_;
+  ViewerControls& viewerControls_;
   ImGuiWrapper& imGuiWrapper_;
+  // Only touched by the render thread
+  ImGuiWrapper::Reports reports_;
+  // Behind a pointer so the mediator stays movable
+  std::unique_ptr<TripleBuffer<ImGuiWrapper::Reports>> publishedReports_{
+    std::make_unique<TripleBuffer<ImGuiWrapper::Reports>>()
+  };
+
+  void reportError(const std::string& errorMessage);
+  void updateReports();
 };
 
-}  // namespace Simple3D
\ No newline at end of file
+}  // namespace Simple3D
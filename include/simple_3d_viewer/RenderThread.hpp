@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <GLFW/glfw3.h>
+
+#include <atomic>
+#include <simple_3d_viewer/FrameSnapshot.hpp>
+#include <simple_3d_viewer/Viewer.hpp>
+#include <simple_3d_viewer/utils/TripleBuffer.hpp>
+#include <thread>
+
+namespace Simple3D
+{
+
+// Renders the snapshots the main thread publishes, so that building the GUI
+// and handling the input overlap with rendering the previous frame. The
+// thread owns the OpenGL context of the window while it runs.
+class RenderThread
+{
+ public:
+  // Takes the context over from the calling thread
+  RenderThread(GLFWwindow* window, Viewer& viewer);
+  RenderThread(const RenderThread&) = delete;
+  RenderThread& operator=(const RenderThread&) = delete;
+  RenderThread(RenderThread&&) = delete;
+  RenderThread& operator=(RenderThread&&) = delete;
+  ~RenderThread()
+  {
+    stop();
+  }
+
+  // Blocks while the last published snapshot wasn't taken yet, which keeps
+  // the main thread at most a frame ahead
+  void waitForSnapshotTaken() const
+  {
+    snapshots_.waitForAcquire();
+  }
+
+  [[nodiscard]] FrameSnapshot& getSnapshotToWrite()
+  {
+    return snapshots_.getWriteBuffer();
+  }
+
+  void publishSnapshot()
+  {
+    snapshots_.publish();
+  }
+
+  // Gives the context back to the calling thread
+  void stop();
+
+ private:
+  GLFWwindow* window_;
+  Viewer& viewer_;
+  TripleBuffer<FrameSnapshot> snapshots_;
+  std::atomic<bool> stopRequested_{ false };
+  // Last, it starts running once everything else is set up
+  std::thread thread_;
+
+  void run();
+};
+
+}  // namespace Simple3D
@@ -4,29 +4,50 @@
 
 #include <GLFW/glfw3.h>
 
+#include <array>
+#include <chrono>
 #include <filesystem>
 #include <future>
+#include <glm/vec2.hpp>
 #include <memory>
+#include <optional>
+#include <simple_3d_viewer/FrameSnapshot.hpp>
+#include <simple_3d_viewer/rendering/ModelRaycaster.hpp>
+#include <simple_3d_viewer/rendering/ModelUploader.hpp>
 #include <simple_3d_viewer/rendering/Renderer.hpp>
 #include <simple_3d_viewer/rendering/Scene.hpp>
+#include <simple_3d_viewer/utils/Profiler.hpp>
+#include <simple_3d_viewer/utils/RedrawScheduler.hpp>
 
 namespace Simple3D
 {
 
+// The side of the viewer on the render thread, owns everything living in the
+// OpenGL context and turns the snapshots of the main thread into frames
 class Viewer
 {
  public:
   enum class Event
   {
-    ModelLoaded
+    ModelLoaded,
+    ModelUploadProgress,
+    FrameRendered,
+    // Also when only the GUI was drawn over the last frame, the last event
+    // of every frame
+    FramePresented,
+    ModelRaycasterReady,
+    ModelPicked,
+    CpuTraceExported
   };
 
   enum class Error
   {
     ReloadProgram,
-    LoadModel
+    LoadModel,
+    ExportCpuTrace
   };
 
+  // Notified on the render thread
   class Mediator
   {
    public:
@@ -36,79 +57,124 @@ class Viewer
     virtual void notify(Error e, const std::string& errorMessage) = 0;
   };
 
-  Viewer(GLFWwindow* window, const std::vector<std::string>& postprocessIDs);
+  struct Pick
+  {
+    std::optional<ModelRaycaster::Hit> hit;
+    // Only when both this and the previous pick hit the model
+    std::optional<float> distanceFromPreviousHit;
+    std::chrono::duration<double, std::micro> queryTime;
+  };
 
-  void processInput(float delta)
+  // Over the last kPresentationHistorySize frames
+  struct PresentationStatistics
   {
-    if (mediator_ == nullptr)
-    {
-      throw std::logic_error("Mediator should be setup by now");
-    }
+    using Duration = std::chrono::duration<double, std::milli>;
+
+    // From polling the input a frame reacts to until its buffers are swapped
+    Duration averageLatency;
+    Duration maxLatency;
+    // From starting on the snapshot until the buffers are swapped
+    Duration averageFrameTime;
+    Duration frameTimeDeviation;
+  };
 
-    scene_.camera.processInput(delta, window_);
-  }
+  static constexpr size_t kPresentationHistorySize = 120;
+
+  // The OpenGL context has to be current. The redraw scheduler belongs to the
+  // main thread, the viewer only requests redraws from it.
+  Viewer(
+      GLFWwindow* window,
+      const std::vector<std::string>& postprocessIDs,
+      RedrawScheduler& redrawScheduler);
 
-  void render(Size framebufferSize);
+  // Renders the scene, or presents the last frame when only the GUI needs a
+  // redraw, draws the GUI over it and swaps the buffers
+  void render(const FrameSnapshot& snapshot);
 
-  void setPostprocessActiveFlag(const std::string& ID, bool active)
+  void setMediator(std::shared_ptr<Mediator> mediator)
   {
-    renderer_.postprocessPipeline_.setPostprocessActiveFlag(ID, active);
+    mediator_ = std::move(mediator);
   }
 
-  void loadModel(const std::filesystem::path& pathToModel)
+  [[nodiscard]] const Renderer& getRenderer() const
   {
-    if (scene_.model)
-    {
-      scene_.model.reset();
-    }
-    modelFuture_ = std::async(
-        std::launch::async,
-        [pathToModel, modelConfig = modelConfig_]()
-        { return Model(pathToModel, modelConfig); });
+    return renderer_;
   }
 
-  void setModelTransform(const Transform& transform)
+  [[nodiscard]] const Scene& getScene() const
   {
-    if (scene_.model)
-    {
-      scene_.model->setTransform(transform);
-    }
+    return scene_;
   }
 
-  void setCameraSettings(Camera::Settings settings)
+  [[nodiscard]] const ModelUploader& getModelUploader() const
   {
-    scene_.camera.setSettings(settings);
+    return modelUploader_;
   }
 
-  void reloadProgram();
-
-  void setMediator(std::shared_ptr<Mediator> mediator)
+  // Built in the background once the model is loaded
+  [[nodiscard]] const std::optional<ModelRaycaster>& getModelRaycaster() const
   {
-    mediator_ = std::move(mediator);
+    return modelRaycaster_;
   }
 
-  [[nodiscard]] Renderer& getRenderer()
+  [[nodiscard]] const std::optional<Pick>& getLastPick() const
   {
-    return renderer_;
+    return lastPick_;
   }
 
-  [[nodiscard]] Scene& getScene()
+  [[nodiscard]] size_t getCpuTraceZonesCount() const
   {
-    return scene_;
+    return cpuTraceZonesCount_;
   }
 
-  [[nodiscard]] Model::Configuration& getModelConfiguration()
+  [[nodiscard]] const PresentationStatistics& getPresentationStatistics() const
   {
-    return modelConfig_;
+    return presentationStatistics_;
   }
 
  private:
+  using Clock = FrameSnapshot::Clock;
+
   GLFWwindow* window_;
+  RedrawScheduler& redrawScheduler_;
   std::future<Model> modelFuture_;
   std::shared_ptr<Mediator> mediator_;
   Scene scene_;
+  // After the scene so they are destroyed before the model they refer to,
+  // the destructor of the future waits for the raycaster being built
+  std::future<ModelRaycaster> modelRaycasterFuture_;
+  std::optional<ModelRaycaster> modelRaycaster_;
+  std::optional<Pick> lastPick_;
+  size_t cpuTraceZonesCount_{};
   Renderer renderer_;
-  Model::Configuration modelConfig_;
+  ModelUploader modelUploader_;
+  FrameSnapshot::Requests handledRequests_;
+  std::array<PresentationStatistics::Duration, kPresentationHistorySize>
+      latencies_{};
+  std::array<PresentationStatistics::Duration, kPresentationHistorySize>
+      frameTimes_{};
+  size_t presentedFramesCount_{};
+  PresentationStatistics presentationStatistics_{};
+
+  void update(const ModelUploader::Budget& modelUploadBudget);
+  void applySettings(const FrameSnapshot& snapshot);
+  void carryOutRequests(const FrameSnapshot& snapshot);
+  void loadModel(
+      const std::filesystem::path& pathToModel,
+      const Model::Configuration& modelConfig);
+  void reloadProgram();
+  // Casts a ray through the cursor position, does nothing until the model
+  // raycaster is ready
+  void pick(const glm::vec2& position, Size framebufferSize);
+  // Writes the zones of the CPU profiler to kCpuTracePath()
+  void exportCpuTrace();
+  void uploadModel(const ModelUploader::Budget& modelUploadBudget);
+  void resetModel();
+  // Also wakes up the main loop
+  void requestSceneRedraw();
+  void recordPresentation(
+      Clock::time_point inputTime,
+      Clock::time_point frameStart);
 };
 
 }  // namespace Simple3D
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <GLFW/glfw3.h>
+
+#include <filesystem>
+#include <simple_3d_viewer/FrameSnapshot.hpp>
+#include <simple_3d_viewer/rendering/Camera.hpp>
+#include <simple_3d_viewer/utils/Profiler.hpp>
+#include <simple_3d_viewer/utils/RedrawScheduler.hpp>
+#include <simple_3d_viewer/utils/Size.hpp>
+
+namespace Simple3D
+{
+
+// The side of the viewer on the main thread: the camera driven by the input,
+// the settings from the GUI and the requests for the render thread, which
+// gets all of them in a FrameSnapshot
+class ViewerControls
+{
+ public:
+  // Before the GUI, see RedrawScheduler::watch
+  explicit ViewerControls(GLFWwindow* window);
+
+  void processInput(float delta)
+  {
+    SIMPLE3D_PROFILE_ZONE("ViewerControls::processInput");
+    if (camera_.processInput(delta, window_))
+    {
+      redrawScheduler_.requestSceneRedraw();
+    }
+  }
+
+  // Everything but the GUI, also decides what the frame redraws
+  void writeSnapshot(
+      FrameSnapshot& snapshot,
+      Size framebufferSize,
+      FrameSnapshot::Clock::time_point inputTime);
+
+  void setPostprocessActiveFlag(const PostprocessID& ID, bool active);
+
+  void setCameraSettings(Camera::Settings settings)
+  {
+    camera_.setSettings(settings);
+  }
+
+  void loadModel(const std::filesystem::path& pathToModel)
+  {
+    requests_.modelPath = pathToModel;
+    ++requests_.loadModelCount;
+  }
+
+  void reloadProgram()
+  {
+    ++requests_.reloadProgramCount;
+  }
+
+  // Relative to the framebuffer from (0, 0) in the top left corner to (1, 1)
+  // in the bottom right one
+  void pick(float x, float y)
+  {
+    requests_.pickPosition = { x, y };
+    ++requests_.pickCount;
+  }
+
+  void exportCpuTrace()
+  {
+    ++requests_.exportCpuTraceCount;
+  }
+
+  [[nodiscard]] FrameSnapshot::Settings& getSettings()
+  {
+    return settings_;
+  }
+
+  [[nodiscard]] RedrawScheduler& getRedrawScheduler()
+  {
+    return redrawScheduler_;
+  }
+
+ private:
+  GLFWwindow* window_;
+  RedrawScheduler redrawScheduler_;
+  Camera camera_;
+  FrameSnapshot::Settings settings_;
+  FrameSnapshot::Requests requests_;
+};
+
+}  // namespace Simple3D
@@ -16,5 +16,8 @@ struct Transform
 
 glm::mat4x4 calculateModelTransform(const Transform& transform);
 glm::mat4x4 calculateProjectionTransform(Size size);
+// Length in pixels of a unit long segment facing the camera from unit
+// distance, for the projection calculateProjectionTransform creates
+float calculateProjectionScale(Size size);
 
 }  // namespace Simple3D
@@ -0,0 +1,302 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <simple_3d_viewer/linear_algebra/Vertex.hpp>
+#include <simple_3d_viewer/linear_algebra/vertexCompression.hpp>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace Simple3D
+{
+
+// Attributes which can make up a VertexLayout. Each one knows its shader
+// location, how OpenGL should read it and how it's encoded from a Vertex.
+namespace VertexAttributes
+{
+
+struct Position
+{
+  using Type = glm::vec3;
+  static constexpr GLuint location = 0;
+  static constexpr GLint componentsCount = 3;
+  static constexpr GLenum componentType = GL_FLOAT;
+  static constexpr GLboolean normalized = GL_FALSE;
+
+  static Type encode(const Vertex& vertex, const PositionQuantization&)
+  {
+    return vertex.position;
+  }
+};
+
+// 16 bit unorm relative to the mesh bounding box, the fourth component is
+// padding which keeps the following attributes 4 byte aligned
+struct QuantizedPosition
+{
+  using Type = std::array<uint16_t, 4>;
+  static constexpr GLuint location = 0;
+  static constexpr GLint componentsCount = 3;
+  static constexpr GLenum componentType = GL_UNSIGNED_SHORT;
+  static constexpr GLboolean normalized = GL_TRUE;
+
+  static Type encode(
+      const Vertex& vertex,
+      const PositionQuantization& positionQuantization)
+  {
+    const auto position = (vertex.position - positionQuantization.offset) /
+                          positionQuantization.scale;
+    return { glm::packUnorm1x16(position.x),
+             glm::packUnorm1x16(position.y),
+             glm::packUnorm1x16(position.z),
+             0 };
+  }
+};
+
+struct Normal
+{
+  using Type = glm::vec3;
+  static constexpr GLuint location = 1;
+  static constexpr GLint componentsCount = 3;
+  static constexpr GLenum componentType = GL_FLOAT;
+  static constexpr GLboolean normalized = GL_FALSE;
+
+  static Type encode(const Vertex& vertex, const PositionQuantization&)
+  {
+    return vertex.normal;
+  }
+};
+
+struct OctahedralNormal
+{
+  using Type = std::array<int16_t, 2>;
+  static constexpr GLuint location = 1;
+  static constexpr GLint componentsCount = 2;
+  static constexpr GLenum componentType = GL_SHORT;
+  static constexpr GLboolean normalized = GL_TRUE;
+
+  static Type encode(const Vertex& vertex, const PositionQuantization&)
+  {
+    const auto normal = encodeOctahedral(vertex.normal);
+    return { static_cast<int16_t>(glm::packSnorm1x16(normal.x)),
+             static_cast<int16_t>(glm::packSnorm1x16(normal.y)) };
+  }
+};
+
+struct Color
+{
+  using Type = glm::vec3;
+  static constexpr GLuint location = 2;
+  static constexpr GLint componentsCount = 3;
+  static constexpr GLenum componentType = GL_FLOAT;
+  static constexpr GLboolean normalized = GL_FALSE;
+
+  static Type encode(const Vertex& vertex, const PositionQuantization&)
+  {
+    return vertex.color;
+  }
+};
+
+struct PackedColor
+{
+  using Type = std::array<uint8_t, 4>;
+  static constexpr GLuint location = 2;
+  static constexpr GLint componentsCount = 3;
+  static constexpr GLenum componentType = GL_UNSIGNED_BYTE;
+  static constexpr GLboolean normalized = GL_TRUE;
+
+  static Type encode(const Vertex& vertex, const PositionQuantization&)
+  {
+    return { glm::packUnorm1x8(vertex.color.r),
+             glm::packUnorm1x8(vertex.color.g),
+             glm::packUnorm1x8(vertex.color.b),
+             glm::packUnorm1x8(1.f) };
+  }
+};
+
+template<unsigned int Channel>
+struct TexCoord
+{
+  static_assert(Channel < Vertex::maxUVChannels);
+
+  using Type = glm::vec2;
+  static constexpr GLuint location = 3 + Channel;
+  static constexpr GLint componentsCount = 2;
+  static constexpr GLenum componentType = GL_FLOAT;
+  static constexpr GLboolean normalized = GL_FALSE;
+
+  static Type encode(const Vertex& vertex, const PositionQuantization&)
+  {
+    return vertex.texCoords[Channel];
+  }
+};
+
+template<unsigned int Channel>
+struct HalfTexCoord
+{
+  static_assert(Channel < Vertex::maxUVChannels);
+
+  using Type = std::array<uint16_t, 2>;
+  static constexpr GLuint location = 3 + Channel;
+  static constexpr GLint componentsCount = 2;
+  static constexpr GLenum componentType = GL_HALF_FLOAT;
+  static constexpr GLboolean normalized = GL_FALSE;
+
+  static Type encode(const Vertex& vertex, const PositionQuantization&)
+  {
+    return { glm::packHalf1x16(vertex.texCoords[Channel].x),
+             glm::packHalf1x16(vertex.texCoords[Channel].y) };
+  }
+};
+
+}  // namespace VertexAttributes
+
+struct VertexAttributeDescription
+{
+  GLuint location;
+  GLint componentsCount;
+  GLenum componentType;
+  GLboolean normalized;
+  size_t offset;
+};
+
+// Type erased VertexLayout, lets Mesh pick its layout at runtime
+struct VertexLayoutDescription
+{
+  using PackFunction = void (*)(
+      std::span<const Vertex> vertices,
+      const PositionQuantization& positionQuantization,
+      std::byte* output);
+
+  std::span<const VertexAttributeDescription> attributes;
+  size_t stride;
+  bool quantizedPositions;
+  bool octahedralNormals;
+  // Writes the vertices interleaved, output has to hold
+  // vertices.size() * stride bytes
+  PackFunction pack;
+};
+
+// Interleaved vertex buffer made out of the given attributes in order, all of
+// the offsets are computed at compile time
+template<typename... Attributes>
+class VertexLayout
+{
+ private:
+  static constexpr size_t kAttributesCount = sizeof...(Attributes);
+  static constexpr std::array<size_t, kAttributesCount> kSizes{
+    sizeof(typename Attributes::Type)...
+  };
+
+ public:
+  static constexpr std::array<size_t, kAttributesCount> offsets = []()
+  {
+    std::array<size_t, kAttributesCount> result{};
+    size_t offset = 0;
+    for (size_t i = 0; i < kAttributesCount; ++i)
+    {
+      result[i] = offset;
+      offset += kSizes[i];
+    }
+    return result;
+  }();
+
+  static constexpr size_t stride =
+      (size_t{} + ... + sizeof(typename Attributes::Type));
+
+  static constexpr std::array<VertexAttributeDescription, kAttributesCount>
+      attributes = []<size_t... I>(std::index_sequence<I...>)
+  {
+    return std::array<VertexAttributeDescription, kAttributesCount>{
+      VertexAttributeDescription{ Attributes::location,
+                                  Attributes::componentsCount,
+                                  Attributes::componentType,
+                                  Attributes::normalized,
+                                  offsets[I] }...
+    };
+  }(std::index_sequence_for<Attributes...>{});
+
+  static void pack(
+      std::span<const Vertex> vertices,
+      const PositionQuantization& positionQuantization,
+      std::byte* output)
+  {
+    for (const auto& vertex : vertices)
+    {
+      packVertex(
+          vertex,
+          positionQuantization,
+          output,
+          std::index_sequence_for<Attributes...>{});
+      output += stride;
+    }
+  }
+
+  static constexpr VertexLayoutDescription description{
+    attributes,
+    stride,
+    (std::is_same_v<Attributes, VertexAttributes::QuantizedPosition> || ...),
+    (std::is_same_v<Attributes, VertexAttributes::OctahedralNormal> || ...),
+    &pack
+  };
+
+ private:
+  template<size_t... I>
+  static void packVertex(
+      const Vertex& vertex,
+      const PositionQuantization& positionQuantization,
+      std::byte* output,
+      std::index_sequence<I...> /*indices*/)
+  {
+    (writeAttribute<Attributes>(
+         vertex, positionQuantization, output + offsets[I]),
+     ...);
+  }
+
+  template<typename Attribute>
+  static void writeAttribute(
+      const Vertex& vertex,
+      const PositionQuantization& positionQuantization,
+      std::byte* output)
+  {
+    const typename Attribute::Type value =
+        Attribute::encode(vertex, positionQuantization);
+    std::memcpy(output, &value, sizeof(value));
+  }
+};
+
+// Everything model.vs reads
+using ModelVertexLayout = VertexLayout<
+    VertexAttributes::Position,
+    VertexAttributes::Normal,
+    VertexAttributes::Color,
+    VertexAttributes::TexCoord<0>,
+    VertexAttributes::TexCoord<1>,
+    VertexAttributes::TexCoord<2>,
+    VertexAttributes::TexCoord<3>,
+    VertexAttributes::TexCoord<4>>;
+static_assert(ModelVertexLayout::stride == 76);
+
+// Same streams as ModelVertexLayout, decoded by model.vs
+using CompactModelVertexLayout = VertexLayout<
+    VertexAttributes::QuantizedPosition,
+    VertexAttributes::OctahedralNormal,
+    VertexAttributes::PackedColor,
+    VertexAttributes::HalfTexCoord<0>,
+    VertexAttributes::HalfTexCoord<1>,
+    VertexAttributes::HalfTexCoord<2>,
+    VertexAttributes::HalfTexCoord<3>,
+    VertexAttributes::HalfTexCoord<4>>;
+static_assert(CompactModelVertexLayout::stride == 36);
+
+// For the light and the skybox whose shaders only read positions
+using PositionVertexLayout = VertexLayout<VertexAttributes::Position>;
+
+}  // namespace Simple3D
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <simple_3d_viewer/linear_algebra/boundingVolumes.hpp>
+#include <simple_3d_viewer/linear_algebra/frustumCulling.hpp>
+#include <span>
+#include <vector>
+
+namespace Simple3D
+{
+
+// Binary tree of boxes over a set of primitives which are only known by their
+// bounding boxes, e.g. the meshes of a model. Primitives are referred to by
+// their indices in the span the hierarchy was built from.
+class BoundingVolumeHierarchy
+{
+ public:
+  static constexpr size_t kMaxLeafPrimitivesCount = 4;
+
+  struct Node
+  {
+    AxisAlignedBox box;
+    // Index of the first child for inner nodes, the second child follows it.
+    // Offset into the primitive indices for leaves.
+    uint32_t firstChildOrPrimitive;
+    // Zero for inner nodes
+    uint32_t primitivesCount;
+
+    [[nodiscard]] bool isLeaf() const
+    {
+      return primitivesCount > 0;
+    }
+  };
+
+  struct RayHit
+  {
+    // Where the ray enters the box of the primitive
+    float distance;
+    uint32_t primitive;
+  };
+
+  BoundingVolumeHierarchy() = default;
+
+  // Splits with the surface area heuristic evaluated over centroid bins. The
+  // top of the tree is split on the calling thread, the subtrees below it are
+  // built in parallel on the thread pool.
+  explicit BoundingVolumeHierarchy(std::span<const AxisAlignedBox> boxes);
+
+  [[nodiscard]] bool empty() const
+  {
+    return nodes_.empty();
+  }
+
+  [[nodiscard]] const std::vector<Node>& getNodes() const
+  {
+    return nodes_;
+  }
+
+  // Primitives in the order the leaves refer to them
+  [[nodiscard]] const std::vector<uint32_t>& getPrimitiveIndices() const
+  {
+    return primitiveIndices_;
+  }
+
+  // Same output as BoundingBoxes::cull, visibility has to hold a value for
+  // every primitive. Subtrees outside of the frustum are skipped as a whole
+  // and planes a node is fully inside of aren't tested for its descendants.
+  void cull(const Frustum& frustum, std::span<uint8_t> visibility) const;
+
+  // Appends the primitives whose boxes the ray hits within [0, maxDistance],
+  // ordered by the distance at which the ray enters their boxes
+  void intersectRay(
+      const Ray& ray,
+      float maxDistance,
+      std::vector<RayHit>& hits) const;
+
+  // Appends the primitives whose boxes overlap the box
+  void intersectBox(
+      const AxisAlignedBox& box,
+      std::vector<uint32_t>& primitives) const;
+
+ private:
+  std::vector<Node> nodes_;
+  std::vector<uint32_t> primitiveIndices_;
+  // Boxes of the primitives in the order of primitiveIndices_, so the leaves
+  // read them contiguously
+  std::vector<AxisAlignedBox> primitiveBoxes_;
+};
+
+}  // namespace Simple3D
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <glm/common.hpp>
+#include <glm/vec3.hpp>
+#include <limits>
+#include <optional>
+#include <simple_3d_viewer/linear_algebra/Vertex.hpp>
+#include <span>
+
+namespace Simple3D
+{
+
+struct AxisAlignedBox
+{
+  glm::vec3 minimum{ 0.f, 0.f, 0.f };
+  glm::vec3 maximum{ 0.f, 0.f, 0.f };
+
+  [[nodiscard]] glm::vec3 getCenter() const
+  {
+    return (minimum + maximum) * 0.5f;
+  }
+
+  // Half of the size along every axis
+  [[nodiscard]] glm::vec3 getExtents() const
+  {
+    return (maximum - minimum) * 0.5f;
+  }
+
+  [[nodiscard]] float getSurfaceArea() const
+  {
+    const auto size = maximum - minimum;
+    return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+  }
+
+  void expand(const glm::vec3& point)
+  {
+    minimum = glm::min(minimum, point);
+    maximum = glm::max(maximum, point);
+  }
+
+  void expand(const AxisAlignedBox& box)
+  {
+    minimum = glm::min(minimum, box.minimum);
+    maximum = glm::max(maximum, box.maximum);
+  }
+
+  // Inverted box which any expand() call replaces
+  static AxisAlignedBox createEmpty()
+  {
+    return { glm::vec3(std::numeric_limits<float>::max()),
+             glm::vec3(std::numeric_limits<float>::lowest()) };
+  }
+};
+
+struct BoundingSphere
+{
+  glm::vec3 center{ 0.f, 0.f, 0.f };
+  float radius{};
+};
+
+// Points at origin + distance * direction, the direction doesn't have to be
+// normalized and distances are measured in its lengths
+struct Ray
+{
+  glm::vec3 origin{ 0.f, 0.f, 0.f };
+  glm::vec3 direction{ 0.f, 0.f, 1.f };
+};
+
+AxisAlignedBox calculateAxisAlignedBox(std::span<const Vertex> vertices);
+
+// Centered on the bounding box of the vertices, not the minimal sphere but
+// close to it for typical meshes and cheap to compute
+BoundingSphere calculateBoundingSphere(
+    std::span<const Vertex> vertices,
+    const AxisAlignedBox& box);
+
+// Slab test, returns the distance at which the ray enters the box or
+// std::nullopt when it misses the box within [0, maxDistance]. The inverse
+// direction is passed in so it's computed only once per ray.
+std::optional<float> intersectRayBox(
+    const glm::vec3& origin,
+    const glm::vec3& inverseDirection,
+    const AxisAlignedBox& box,
+    float maxDistance);
+
+}  // namespace Simple3D
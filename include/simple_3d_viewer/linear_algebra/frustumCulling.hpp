@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <simple_3d_viewer/linear_algebra/boundingVolumes.hpp>
+#include <span>
+#include <vector>
+
+namespace Simple3D
+{
+
+// Planes as (normal, distance), points inside of the frustum are on the
+// positive side of all of them. The planes aren't normalized, none of the
+// tests need them to be.
+struct Frustum
+{
+  static constexpr size_t kPlanesCount = 6;
+
+  std::array<glm::vec4, kPlanesCount> planes;
+};
+
+// Gribb and Hartmann, "Fast Extraction of Viewing Frustum Planes from the
+// World-View-Projection Matrix". The planes are in the space the matrix
+// transforms from.
+Frustum extractFrustum(const glm::mat4x4& projectionView);
+
+// Moves the planes into the space the transform maps into the frustum space,
+// e.g. the model space for the model transform
+Frustum transformFrustum(const Frustum& frustum, const glm::mat4x4& transform);
+
+// Boxes stored as one array per component of their centers and extents, so
+// the culling tests a whole SIMD register of boxes against a plane at once.
+// The arrays are padded to whole batches with empty boxes.
+class BoundingBoxes
+{
+ public:
+  static constexpr size_t kBatchSize = 4;
+
+  void assign(std::span<const AxisAlignedBox> boxes);
+
+  [[nodiscard]] size_t size() const
+  {
+    return count_;
+  }
+
+  // Writes 1 for every box which intersects the frustum and 0 for the ones
+  // fully outside of it, visibility has to hold size() values
+  void cull(const Frustum& frustum, std::span<uint8_t> visibility) const;
+
+ private:
+  size_t count_{};
+  std::vector<float> centersX_;
+  std::vector<float> centersY_;
+  std::vector<float> centersZ_;
+  std::vector<float> extentsX_;
+  std::vector<float> extentsY_;
+  std::vector<float> extentsZ_;
+};
+
+}  // namespace Simple3D
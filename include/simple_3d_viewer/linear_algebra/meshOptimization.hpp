@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <simple_3d_viewer/linear_algebra/Vertex.hpp>
+#include <span>
+#include <vector>
+
+namespace Simple3D
+{
+
+// Size of the simulated FIFO post-transform cache, both when optimizing and
+// when analyzing
+inline constexpr size_t kVertexCacheSize = 16;
+
+struct VertexCacheStatistics
+{
+  size_t transformedVerticesCount{};
+  size_t trianglesCount{};
+  size_t referencedVerticesCount{};
+
+  // Average cache miss ratio, transformed vertices per triangle. 0.5 is the
+  // best possible for big regular meshes, 3 the worst.
+  [[nodiscard]] double getACMR() const
+  {
+    return trianglesCount > 0 ? static_cast<double>(transformedVerticesCount) /
+                                    static_cast<double>(trianglesCount)
+                              : 0.;
+  }
+
+  // Average transform to vertex ratio, 1 is the best possible
+  [[nodiscard]] double getATVR() const
+  {
+    return referencedVerticesCount > 0
+               ? static_cast<double>(transformedVerticesCount) /
+                     static_cast<double>(referencedVerticesCount)
+               : 0.;
+  }
+
+  VertexCacheStatistics& operator+=(const VertexCacheStatistics& other)
+  {
+    transformedVerticesCount += other.transformedVerticesCount;
+    trianglesCount += other.trianglesCount;
+    referencedVerticesCount += other.referencedVerticesCount;
+    return *this;
+  }
+};
+
+// Non empty, made out of whole triangles and not indexing past the vertices
+bool isTriangleList(std::span<const uint32_t> indices, size_t verticesCount);
+
+VertexCacheStatistics analyzeVertexCache(
+    std::span<const uint32_t> indices,
+    size_t verticesCount);
+
+// Reorders the triangles for post-transform cache locality with Tipsify
+// (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced
+// Overdraw"). Returns the index offsets at which the clusters of triangles
+// start, the clusters are what optimizeOverdraw reorders.
+std::vector<size_t> optimizeVertexCache(
+    std::vector<uint32_t>& indices,
+    size_t verticesCount);
+
+// Sorts the clusters so the ones facing outwards from the mesh center are
+// drawn first, as they tend to occlude the rest of the mesh. The order of
+// triangles within a cluster is kept.
+void optimizeOverdraw(
+    std::vector<uint32_t>& indices,
+    std::span<const Vertex> vertices,
+    std::span<const size_t> clusterStarts);
+
+// Renumbers the vertices in the order the indices first reference them, so
+// the vertex fetch walks memory mostly linearly. Unreferenced vertices are
+// moved to the end.
+void optimizeVertexFetch(
+    std::vector<Vertex>& vertices,
+    std::vector<uint32_t>& indices);
+
+// Runs the whole pipeline above, indices which don't form a triangle list
+// are left alone
+void optimizeMesh(
+    std::vector<Vertex>& vertices,
+    std::vector<uint32_t>& indices);
+
+}  // namespace Simple3D
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <simple_3d_viewer/linear_algebra/Vertex.hpp>
+#include <span>
+#include <vector>
+
+namespace Simple3D
+{
+
+// Levels of detail kept per mesh, including the full detail one
+inline constexpr size_t kMaxLodsCount = 5;
+
+// Range of the mesh indices which makes up a single level of detail
+struct MeshLod
+{
+  size_t indicesOffset;
+  size_t indicesCount;
+  // Root mean square distance of the level from the full detail surface, in
+  // the mesh space
+  float error;
+};
+
+struct SimplifiedIndices
+{
+  std::vector<uint32_t> indices;
+  float error;
+};
+
+// Collapses edges in the order of their quadric error (Garland and Heckbert,
+// "Surface Simplification Using Quadric Error Metrics") until at most
+// targetIndicesCount indices are left or no edge can be collapsed anymore.
+// Vertices are only ever merged into other vertices of the mesh, so the result
+// indexes the same vertex array. Vertices on open borders never move, which
+// keeps the holes from growing.
+SimplifiedIndices simplifyMesh(
+    std::span<const Vertex> vertices,
+    std::span<const uint32_t> indices,
+    size_t targetIndicesCount);
+
+// Simplifies the mesh level by level, each level to about half of the triangles
+// of the previous one, and appends the indices of the new levels to indices.
+// Returns the levels starting with the full detail one, the chain ends early
+// when a level can't be simplified meaningfully. The new levels are reordered
+// for the vertex cache when optimizeLevels is set.
+std::vector<MeshLod> generateLods(
+    std::span<const Vertex> vertices,
+    std::vector<uint32_t>& indices,
+    bool optimizeLevels);
+
+// The coarsest level whose error, times pixelsPerUnit, stays within maxError.
+// The levels come in the order generateLods returns them, no levels stand for
+// the full detail only.
+size_t selectLodLevel(
+    std::span<const MeshLod> lods,
+    float pixelsPerUnit,
+    float maxError);
+
+}  // namespace Simple3D
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <simple_3d_viewer/linear_algebra/Vertex.hpp>
+#include <simple_3d_viewer/linear_algebra/boundingVolumes.hpp>
+#include <simple_3d_viewer/linear_algebra/meshSimplification.hpp>
+#include <simple_3d_viewer/utils/Size.hpp>
+#include <span>
+#include <vector>
+
+namespace Simple3D
+{
+
+// Low resolution depth buffer the occluders are rasterized into on the CPU,
+// with the farthest depth of every block of pixels and of every tile kept as
+// a hierarchy for the visibility tests. Depths are the window space ones,
+// from 0 at the near plane to 1 at the far plane.
+class OcclusionBuffer
+{
+ public:
+  static constexpr int kWidth = 256;
+  static constexpr int kBlockSize = 8;
+  // Tiles are rasterized in parallel, every one holds whole blocks
+  static constexpr int kTileWidth = 64;
+  static constexpr int kTileHeight = 32;
+  // In pixels of the buffer. A simplified triangle can bridge a concave part
+  // or a hole of the mesh and cover what the mesh leaves visible, so the
+  // occluders only use levels of detail well under a pixel off.
+  static constexpr float kMaxOccluderLodError = 0.5f;
+
+  // Keeps the aspect ratio of the framebuffer, with the height rounded to
+  // whole tiles
+  void resize(Size framebufferSize);
+
+  // Clears the depths and the added occluders
+  void clear();
+
+  // Transforms the triangles into the window space, clips them against the
+  // near plane and bins them into the tiles they overlap
+  void addOccluder(
+      std::span<const Vertex> vertices,
+      std::span<const uint32_t> indices,
+      const glm::mat4x4& clipTransform);
+
+  // The coarsest level of detail the mesh can be added as an occluder with.
+  // The distance is from the camera to the closest point of the mesh, in the
+  // units of the errors of the levels.
+  [[nodiscard]] size_t selectOccluderLod(
+      std::span<const MeshLod> lods,
+      float distance) const;
+
+  // Rasterizes the triangles of every tile and builds the hierarchy, the
+  // tiles are spread over the thread pool
+  void rasterize();
+
+  // False only when the whole box is behind the occluders, or outside of the
+  // buffer. The transform is from the space of the box to the clip space.
+  [[nodiscard]] bool isVisible(
+      const AxisAlignedBox& box,
+      const glm::mat4x4& clipTransform) const;
+
+  [[nodiscard]] Size getSize() const
+  {
+    return { kWidth, height_ };
+  }
+
+  // Of all occluders since the last clear, after the clipping
+  [[nodiscard]] size_t getTrianglesCount() const
+  {
+    return triangles_.size();
+  }
+
+ private:
+  struct Triangle
+  {
+    // Window space x and y in pixels, and the depth
+    std::array<glm::vec3, 3> vertices;
+  };
+
+  int height_{};
+  int tilesX_{};
+  int tilesY_{};
+  std::vector<float> depths_;
+  // Farthest depth of every block and of every tile, row by row
+  std::vector<float> blocksDepths_;
+  std::vector<float> tilesDepths_;
+  std::vector<Triangle> triangles_;
+  // Indices of the triangles which overlap each tile
+  std::vector<std::vector<uint32_t>> tilesTriangles_;
+
+  void addTriangle(const Triangle& triangle);
+  void rasterizeTile(int tileX, int tileY);
+};
+
+}  // namespace Simple3D
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <optional>
+#include <simple_3d_viewer/linear_algebra/Vertex.hpp>
+#include <simple_3d_viewer/linear_algebra/boundingVolumes.hpp>
+#include <span>
+#include <vector>
+
+namespace Simple3D
+{
+
+// Bounding volume hierarchy over the triangles of a single mesh for ray
+// queries. Built as a binary tree with the surface area heuristic and then
+// collapsed into nodes with four children, whose boxes are tested against a
+// ray at once.
+class TriangleHierarchy
+{
+ public:
+  static constexpr size_t kWidth = 4;
+
+  struct Hit
+  {
+    // In lengths of the ray direction
+    float distance;
+    // The triangle made of the indices or vertices [3 * i, 3 * i + 3)
+    uint32_t triangleIndex;
+    // Barycentric coordinates of the second and the third vertex
+    float u;
+    float v;
+  };
+
+  TriangleHierarchy() = default;
+
+  // Triangles are consecutive triples of the indices, or of the vertices when
+  // there are no indices
+  TriangleHierarchy(
+      std::span<const Vertex> vertices,
+      std::span<const uint32_t> indices);
+
+  [[nodiscard]] bool empty() const
+  {
+    return nodes_.empty();
+  }
+
+  [[nodiscard]] size_t getNodesCount() const
+  {
+    return nodes_.size();
+  }
+
+  // Nearest hit within [0, maxDistance], triangles are hit from both sides
+  [[nodiscard]] std::optional<Hit> intersectClosest(
+      const Ray& ray,
+      float maxDistance) const;
+
+  // Whether anything is hit within [0, maxDistance], stops at the first hit
+  // found so it's cheaper than intersectClosest, e.g. for occlusion rays
+  [[nodiscard]] bool intersectAny(const Ray& ray, float maxDistance) const;
+
+ private:
+  // Boxes of the children as one array per component. Unused children have
+  // inverted boxes, which no ray hits.
+  struct alignas(16) Node
+  {
+    std::array<float, kWidth> minimumX;
+    std::array<float, kWidth> minimumY;
+    std::array<float, kWidth> minimumZ;
+    std::array<float, kWidth> maximumX;
+    std::array<float, kWidth> maximumY;
+    std::array<float, kWidth> maximumZ;
+    // Index of the child node, or of the first triangle for leaves
+    std::array<uint32_t, kWidth> children;
+    // Zero for inner nodes
+    std::array<uint32_t, kWidth> trianglesCount;
+  };
+
+  // Stored with two edges instead of the last two vertices, which is what
+  // the intersection test works with
+  struct Triangle
+  {
+    glm::vec3 vertex;
+    glm::vec3 edge1;
+    glm::vec3 edge2;
+  };
+
+  std::vector<Node> nodes_;
+  // In the order the leaves refer to them
+  std::vector<Triangle> triangles_;
+  std::vector<uint32_t> triangleIndices_;
+
+  template<bool kAnyHit>
+  std::optional<Hit> traverse(const Ray& ray, float maxDistance) const;
+};
+
+}  // namespace Simple3D
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <simple_3d_viewer/linear_algebra/Vertex.hpp>
+#include <span>
+
+namespace Simple3D
+{
+
+// Maps the unorm positions back into the mesh space:
+// position = quantized * scale + offset
+struct PositionQuantization
+{
+  glm::vec3 scale{ 1.f, 1.f, 1.f };
+  glm::vec3 offset{ 0.f, 0.f, 0.f };
+
+  bool operator==(const PositionQuantization&) const = default;
+};
+
+PositionQuantization calculatePositionQuantization(
+    std::span<const Vertex> vertices);
+
+// Zero vectors map to the encoding of +Z, decoded by decodeOctahedral in
+// model.vs
+glm::vec2 encodeOctahedral(glm::vec3 normal);
+
+}  // namespace Simple3D
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <simple_3d_viewer/utils/Size.hpp>
+
+namespace Simple3D
+{
+
+// Color and depth with stencil in renderbuffers, for drawing offscreen and
+// copying the result somewhere else
+class Framebuffer
+{
+ public:
+  explicit Framebuffer(Size size);
+  Framebuffer(const Framebuffer&) = delete;
+  Framebuffer& operator=(const Framebuffer&) = delete;
+  Framebuffer(Framebuffer&&) = delete;
+  Framebuffer& operator=(Framebuffer&&) = delete;
+  ~Framebuffer()
+  {
+    release();
+  }
+
+  // The contents are undefined afterwards
+  void resize(Size size);
+
+  // Copies the color into the framebuffer, which is bound afterwards
+  void blitTo(uint framebuffer) const;
+
+  [[nodiscard]] uint get() const
+  {
+    return framebuffer_;
+  }
+
+  [[nodiscard]] Size getSize() const
+  {
+    return size_;
+  }
+
+  void release();
+
+ private:
+  uint framebuffer_{};
+  // Color and depth with stencil
+  std::array<uint, 2> renderbuffers_{};
+  Size size_;
+};
+
+}  // namespace Simple3D
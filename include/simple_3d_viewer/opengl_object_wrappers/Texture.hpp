@@ -87,6 +87,14 @@ class Texture
 
   void use(uint32_t textureSlot = 0);
 
+  [[nodiscard]] bool isComplete() const
+  {
+    return textureHandle_ != 0;
+  }
+
+  // Size of the decoded images which are still waiting to be uploaded
+  [[nodiscard]] size_t getPendingDataSize() const;
+
   [[nodiscard]] const std::filesystem::path& getPath() const
   {
     return paths_.front();
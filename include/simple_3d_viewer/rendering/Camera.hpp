@@ -40,6 +40,10 @@ class Camera
   {
     return position_;
   }
+  [[nodiscard]] const glm::vec3& getOrientation() const
+  {
+    return orientation_;
+  }
   [[nodiscard]] glm::mat4 getViewTransform() const
   {
     return glm::lookAt(position_, position_ + orientation_, up_);
@@ -49,7 +53,11 @@ class Camera
     settings_ = settings;
   }
 
-  void processInput(float delta, GLFWwindow* window);
+  // Returns whether the camera moved or turned
+  bool processInput(float delta, GLFWwindow* window);
+
+  // Places the camera without any input, e.g. along a scripted path
+  void lookAt(const glm::vec3& position, const glm::vec3& target);
 
  private:
   glm::vec3 position_{ 0.f, 0.f, 5.f };
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <glm/vec3.hpp>
+#include <simple_3d_viewer/linear_algebra/boundingVolumes.hpp>
+#include <vector>
+
+namespace Simple3D
+{
+
+struct CameraKeyframe
+{
+  glm::vec3 position;
+  glm::vec3 target;
+};
+
+// Keyframes the camera moves through at a constant rate, for repeatable
+// measurements
+class CameraPath
+{
+ public:
+  explicit CameraPath(std::vector<CameraKeyframe> keyframes);
+
+  // Circles the box once at a distance from which all of it is in view
+  static CameraPath createOrbit(
+      const AxisAlignedBox& box,
+      size_t keyframesCount);
+
+  // One keyframe per line, as the position followed by the target, six
+  // numbers separated by spaces. Empty lines and lines starting with # are
+  // skipped.
+  static CameraPath load(const std::filesystem::path& filePath);
+
+  // Linear between the keyframes, from the first one at 0 to the last one
+  // at 1
+  [[nodiscard]] CameraKeyframe sample(float progress) const;
+
+  [[nodiscard]] const std::vector<CameraKeyframe>& getKeyframes() const
+  {
+    return keyframes_;
+  }
+
+ private:
+  std::vector<CameraKeyframe> keyframes_;
+};
+
+}  // namespace Simple3D
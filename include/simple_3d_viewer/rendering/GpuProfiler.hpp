@@ -0,0 +1,115 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Simple3D
+{
+
+// Measures how long the GPU takes for the passes of a frame with
+// GL_TIME_ELAPSED queries. The queries of a frame are only read a few frames
+// later, from a ring of frames, and only once they are available, so the
+// measuring never waits for the GPU.
+class GpuProfiler
+{
+ public:
+  using Duration = std::chrono::duration<double, std::milli>;
+
+  // Frames whose queries can be in flight at once. A frame which still isn't
+  // finished when its slot comes around again is dropped.
+  static constexpr size_t kFramesInFlight = 4;
+  // Measurements kept per pass for the averages and the percentiles
+  static constexpr size_t kHistorySize = 128;
+
+  struct PassTimings
+  {
+    std::string name;
+    Duration last;
+    Duration average;
+    Duration median;
+    Duration percentile95;
+    Duration percentile99;
+  };
+
+  GpuProfiler();
+  GpuProfiler(const GpuProfiler&) = delete;
+  GpuProfiler& operator=(const GpuProfiler&) = delete;
+  GpuProfiler(GpuProfiler&&) = delete;
+  GpuProfiler& operator=(GpuProfiler&&) = delete;
+  ~GpuProfiler()
+  {
+    release();
+  }
+
+  void release();
+
+  // Collects the finished frames and starts measuring a new one
+  void beginFrame();
+
+  // Passes can't be nested, GL_TIME_ELAPSED queries can't overlap
+  void measure(std::string_view pass, const std::function<void()>& operations);
+
+  // In the order the passes were first measured, passes without any
+  // measurements yet are left out
+  [[nodiscard]] std::vector<PassTimings> getTimings() const;
+
+  // False when the context reports no bits for the timer queries, nothing
+  // is measured then
+  [[nodiscard]] bool isSupported() const
+  {
+    return supported_;
+  }
+
+  [[nodiscard]] size_t getDroppedFramesCount() const
+  {
+    return droppedFramesCount_;
+  }
+
+  // Sum of the passes of the latest collected frame, the count tells when a
+  // new one came in
+  [[nodiscard]] Duration getLastFrameTime() const
+  {
+    return lastFrameTime_;
+  }
+
+  [[nodiscard]] size_t getCollectedFramesCount() const
+  {
+    return collectedFramesCount_;
+  }
+
+ private:
+  struct Pass
+  {
+    std::string name;
+    // Ring of the last measurements
+    std::array<Duration, kHistorySize> history;
+    size_t measurementsCount;
+  };
+
+  struct Frame
+  {
+    std::vector<GLuint> queries;
+    // Index into passes_ for every used query
+    std::vector<size_t> passes;
+  };
+
+  bool supported_;
+  std::vector<Pass> passes_;
+  std::array<Frame, kFramesInFlight> frames_;
+  size_t currentFrame_{};
+  size_t droppedFramesCount_{};
+  Duration lastFrameTime_{};
+  size_t collectedFramesCount_{};
+
+  [[nodiscard]] size_t findPass(std::string_view pass);
+  [[nodiscard]] bool collect(Frame& frame);
+};
+
+}  // namespace Simple3D
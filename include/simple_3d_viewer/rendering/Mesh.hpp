@@ -1,10 +1,15 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <simple_3d_viewer/linear_algebra/Vertex.hpp>
+#include <simple_3d_viewer/linear_algebra/VertexLayout.hpp>
+#include <simple_3d_viewer/linear_algebra/boundingVolumes.hpp>
+#include <simple_3d_viewer/linear_algebra/meshSimplification.hpp>
+#include <simple_3d_viewer/linear_algebra/vertexCompression.hpp>
 #include <simple_3d_viewer/opengl_object_wrappers/Program.hpp>
 #include <simple_3d_viewer/opengl_object_wrappers/Texture.hpp>
 #include <simple_3d_viewer/rendering/Camera.hpp>
@@ -34,7 +39,8 @@ class Mesh
       std::vector<GLuint> indices,
       bool issueRenderingAPICalls = true)
       : vertices_(std::move(vertices)),
-        indices_(std::move(indices))
+        indices_(std::move(indices)),
+        indexType_(selectIndexType(indices_))
   {
     if (issueRenderingAPICalls)
     {
@@ -48,6 +54,7 @@ class Mesh
       bool issueRenderingAPICalls = true)
       : vertices_(std::move(vertices)),
         indices_(std::move(indices)),
+        indexType_(selectIndexType(indices_)),
         material_(material)
   {
     if (issueRenderingAPICalls)
@@ -55,12 +62,35 @@ class Mesh
       init();
     }
   }
+  // Uploads only the streams of the given layout instead of ModelVertexLayout
+  template<typename... Attributes>
+  Mesh(
+      VertexLayout<Attributes...> /*layout*/,
+      std::vector<Vertex> vertices,
+      std::vector<GLuint> indices = {},
+      bool issueRenderingAPICalls = true)
+      : vertices_(std::move(vertices)),
+        indices_(std::move(indices)),
+        indexType_(selectIndexType(indices_)),
+        vertexLayout_(&VertexLayout<Attributes...>::description)
+  {
+    if (issueRenderingAPICalls)
+    {
+      init();
+    }
+  }
   Mesh(const Mesh& mesh) = delete;
   Mesh& operator=(const Mesh&) = delete;
   Mesh(Mesh&& mesh) noexcept
       : vertices_(std::move(mesh.vertices_)),
         indices_(std::move(mesh.indices_)),
+        indexType_(mesh.indexType_),
+        lods_(std::move(mesh.lods_)),
+        boundingBox_(mesh.boundingBox_),
+        boundingSphere_(mesh.boundingSphere_),
         material_(mesh.material_),
+        vertexLayout_(mesh.vertexLayout_),
+        positionQuantization_(mesh.positionQuantization_),
         vao_(mesh.vao_),
         vbo_(mesh.vbo_),
         ebo_(mesh.ebo_)
@@ -86,7 +116,13 @@ class Mesh
     swap(ebo_, other.ebo_);
     swap(vertices_, other.vertices_);
     swap(indices_, other.indices_);
+    swap(indexType_, other.indexType_);
+    swap(lods_, other.lods_);
+    swap(boundingBox_, other.boundingBox_);
+    swap(boundingSphere_, other.boundingSphere_);
     swap(material_, other.material_);
+    swap(vertexLayout_, other.vertexLayout_);
+    swap(positionQuantization_, other.positionQuantization_);
 
     return *this;
   }
@@ -96,8 +132,25 @@ class Mesh
   }
 
   std::vector<Vertex> vertices_;
+  // The CPU copy is always 32 bit, the GPU copy uses the narrowest type which
+  // fits the largest index
   std::vector<uint32_t> indices_;
+  GLenum indexType_{ GL_UNSIGNED_INT };
+  // Levels of detail starting with the full detail one, their indices are
+  // stored one after another in indices_. Empty when the mesh has only the
+  // full detail.
+  std::vector<MeshLod> lods_;
+  // Both in the mesh space, filled in by Model
+  AxisAlignedBox boundingBox_;
+  BoundingSphere boundingSphere_;
   Material* material_{ nullptr };
+  // GPU encoding of the vertices, has to be set before the mesh is completed.
+  // The CPU copy is always full Vertex.
+  const VertexLayoutDescription* vertexLayout_{
+    &ModelVertexLayout::description
+  };
+  // Identity unless the layout has quantized positions
+  PositionQuantization positionQuantization_;
   uint vao_{};
   uint vbo_{};
   uint ebo_{};
@@ -106,6 +159,47 @@ class Mesh
 
   void release();
 
+  [[nodiscard]] bool isComplete() const
+  {
+    return vao_ != 0;
+  }
+
+  [[nodiscard]] size_t getLodsCount() const
+  {
+    return std::max(lods_.size(), size_t{ 1 });
+  }
+
+  [[nodiscard]] MeshLod getLod(size_t level) const
+  {
+    return lods_.empty() ? MeshLod{ 0, indices_.size(), 0.f } : lods_[level];
+  }
+
+  // Size of a single vertex on the GPU
+  [[nodiscard]] size_t getVertexSize() const
+  {
+    return vertexLayout_->stride;
+  }
+
+  // Size of a single index on the GPU
+  [[nodiscard]] size_t getIndexSize() const
+  {
+    switch (indexType_)
+    {
+      case GL_UNSIGNED_BYTE: return sizeof(GLubyte);
+      case GL_UNSIGNED_SHORT: return sizeof(GLushort);
+      default: return sizeof(GLuint);
+    }
+  }
+
+  // Size of the vertex and index data on the GPU
+  [[nodiscard]] size_t getDataSize() const
+  {
+    return vertices_.size() * getVertexSize() +
+           indices_.size() * getIndexSize();
+  }
+
+  static GLenum selectIndexType(const std::vector<uint32_t>& indices);
+
  private:
   void init();
 };
@@ -7,13 +7,18 @@
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 #include <bitset>
+#include <chrono>
 #include <cstddef>
 #include <filesystem>
 #include <glm/glm.hpp>
 #include <simple_3d_viewer/linear_algebra/Transform.hpp>
+#include <simple_3d_viewer/linear_algebra/boundingVolumeHierarchy.hpp>
+#include <simple_3d_viewer/linear_algebra/frustumCulling.hpp>
+#include <simple_3d_viewer/linear_algebra/meshOptimization.hpp>
 #include <simple_3d_viewer/opengl_object_wrappers/Texture.hpp>
 #include <simple_3d_viewer/rendering/Material.hpp>
 #include <simple_3d_viewer/rendering/Mesh.hpp>
+#include <simple_3d_viewer/rendering/ModelCache.hpp>
 #include <stb_image.h>
 #include <stdexcept>
 #include <string>
@@ -31,6 +36,13 @@ class Model
     enum class Flag
     {
       FlipUVs,
+      UseModelCache,
+      CompactVertexFormat,
+      OptimizeMeshes,
+      GenerateLods,
+      // Decodes the textures once more on the loading thread alone, only to
+      // compare its time with the parallel decode
+      MeasureSerialTextureDecoding,
       FlagsCount,
     };
 
@@ -64,16 +76,78 @@ class Model
       return flags;
     }
 
+    // Flags which change the output of the loading, used to key the model
+    // cache. The vertex format only changes what is uploaded to the GPU.
+    [[nodiscard]] uint64_t getOutputAffectingFlags() const
+    {
+      auto flags = flags_;
+      flags.reset(static_cast<size_t>(Flag::UseModelCache));
+      flags.reset(static_cast<size_t>(Flag::CompactVertexFormat));
+      flags.reset(static_cast<size_t>(Flag::MeasureSerialTextureDecoding));
+      return flags.to_ullong();
+    }
+
    private:
-    std::bitset<static_cast<size_t>(Flag::FlagsCount)> flags_{};
+    // Mesh optimization only changes the order of the vertices and the
+    // triangles, and the levels of detail are only used within the maximum
+    // error set for the renderer, so both are on unless turned off
+    static constexpr unsigned long long kDefaultFlags =
+        (1ULL << static_cast<size_t>(Flag::OptimizeMeshes)) |
+        (1ULL << static_cast<size_t>(Flag::GenerateLods));
+
+    std::bitset<static_cast<size_t>(Flag::FlagsCount)> flags_{ kDefaultFlags };
     static const std::unordered_map<Flag, aiPostProcessSteps> flagToAssimpFlag_;
   };
 
+  struct LoadStatistics
+  {
+    using Duration = std::chrono::duration<double, std::milli>;
+
+    bool loadedFromCache{};
+    // Time spent in the Model constructor, excluding the cache writing and
+    // building the meshes hierarchy
+    Duration loadingTime{};
+    Duration cacheWritingTime{};
+    size_t texturesCount{};
+    size_t texturesDecodingThreadsCount{};
+    // Wall-clock time of the parallel decode
+    Duration texturesDecodingTime{};
+    // Sum of the decode times of the individual textures measured during the
+    // parallel decode. Contention between the workers inflates it, so it's
+    // an upper bound of a serial decode rather than its time.
+    Duration texturesDecodingSummedTime{};
+    // Only filled in with Flag::MeasureSerialTextureDecoding, wall-clock time
+    // of decoding the same textures one after another on the loading thread
+    bool texturesSerialDecodingMeasured{};
+    Duration texturesSerialDecodingTime{};
+    size_t meshesCount{};
+    // Wall-clock time of flattening the node tree and converting the meshes
+    Duration meshesConversionTime{};
+    // Only filled in when the meshes were optimized during this loading
+    bool meshesOptimized{};
+    Duration meshesOptimizationTime{};
+    VertexCacheStatistics vertexCacheBeforeOptimization;
+    VertexCacheStatistics vertexCacheAfterOptimization;
+    // Levels of detail of all meshes, including the full detail ones
+    size_t lodsCount{};
+    // Only filled in when the levels of detail were generated during this
+    // loading
+    bool lodsGenerated{};
+    Duration lodsGenerationTime{};
+    size_t meshesHierarchyNodesCount{};
+    Duration meshesHierarchyBuildTime{};
+  };
+
   Model(
       const std::filesystem::path& modelFilePath,
       const Configuration& configuration)
   {
     loadModel(modelFilePath, configuration);
+    buildMeshesBounds();
+    setVertexLayout(
+        configuration.get(Configuration::Flag::CompactVertexFormat)
+            ? CompactModelVertexLayout::description
+            : ModelVertexLayout::description);
   }
 
   glm::mat4x4 transform_{ calculateModelTransform(
@@ -81,6 +155,10 @@ class Model
   std::vector<Mesh> meshes_;
   std::vector<Material> materials_;
   std::vector<Texture> textures_;
+  // Bounding boxes of meshes_ in the same order, for culling
+  BoundingBoxes meshesBounds_;
+  // Over the same boxes, primitives are the indices of meshes_
+  BoundingVolumeHierarchy meshesHierarchy_;
 
   void complete()
   {
@@ -94,6 +172,15 @@ class Model
     }
   }
 
+  // Only affects meshes which haven't been completed yet
+  void setVertexLayout(const VertexLayoutDescription& vertexLayout)
+  {
+    for (auto& mesh : meshes_)
+    {
+      mesh.vertexLayout_ = &vertexLayout;
+    }
+  }
+
   void setTransform(const Transform& transform)
   {
     transform_ = calculateModelTransform(transform);
@@ -104,23 +191,45 @@ class Model
     return id_;
   }
 
+  [[nodiscard]] const LoadStatistics& getLoadStatistics() const
+  {
+    return loadStatistics_;
+  }
+
  private:
   uint64_t id_ = generateSimpleId();
+  LoadStatistics loadStatistics_;
 
   void loadModel(
       const std::filesystem::path& modelFilePath,
       const Configuration& configuration);
+  void loadFromCache(
+      const CachedModel& cachedModel,
+      bool measureSerialTextureDecoding);
   void processMaterials(
       const aiScene& scene,
-      const std::filesystem::path& modelDirectory);
-  void processNode(const aiNode& node, const aiScene& scene);
-  void loadMaterialTextures(
+      const std::filesystem::path& modelDirectory,
+      bool measureSerialTextureDecoding);
+  void processNodes(const aiScene& scene);
+  void optimizeMeshes();
+  void generateLods(bool optimizeLevels);
+  void buildMeshesBounds();
+  static void collectNodeMeshes(
+      const aiNode& node,
+      const aiScene& scene,
+      std::vector<const aiMesh*>& assimpMeshes);
+  void collectMaterialTexturePaths(
       const aiMaterial& assimpMaterial,
-      const std::filesystem::path& modelDirectory);
-  void loadMaterialTexturesOfType(
+      const std::filesystem::path& modelDirectory,
+      std::vector<std::filesystem::path>& texturePaths);
+  void collectMaterialTexturePathsOfType(
       const aiMaterial& assimpMaterial,
       aiTextureType type,
-      const std::filesystem::path& modelDirectory);
+      const std::filesystem::path& modelDirectory,
+      std::vector<std::filesystem::path>& texturePaths);
+  void loadTextures(
+      const std::vector<std::filesystem::path>& texturePaths,
+      bool measureSerialDecoding);
   Material processMaterial(
       const aiMaterial& assimpMaterial,
       const std::filesystem::path& modelDirectory);
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <simple_3d_viewer/linear_algebra/Vertex.hpp>
+#include <simple_3d_viewer/linear_algebra/meshSimplification.hpp>
+#include <simple_3d_viewer/utils/MappedFile.hpp>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Simple3D
+{
+
+class Model;
+
+// Identifies the output of a single model import, a cache entry is only used
+// when all of the fields match
+struct ModelCacheKey
+{
+  std::filesystem::path modelFilePath;
+  int64_t lastWriteTime;
+  uint64_t fileSize;
+  uint64_t configurationFlags;
+};
+
+// Views into a memory mapped cache file, the vertex and index arrays point
+// straight into the mapping so they can be copied or uploaded without any
+// per vertex work
+struct CachedModel
+{
+  struct TextureReference
+  {
+    uint32_t textureIndex;
+    // Negative when the material doesn't specify an UV channel
+    int32_t uvChannel;
+  };
+
+  struct Material
+  {
+    glm::vec3 ambientColor;
+    glm::vec3 diffuseColor;
+    glm::vec3 specularColor;
+    glm::vec3 emissiveColor;
+    float opacity;
+    float shininess;
+    float shininessStrength;
+    std::vector<TextureReference> diffuseTextures;
+    std::vector<TextureReference> specularTextures;
+    std::vector<TextureReference> emissiveTextures;
+    std::vector<TextureReference> normalsTextures;
+    std::vector<TextureReference> metalnessTextures;
+    std::vector<TextureReference> diffuseRoughnessTextures;
+  };
+
+  struct Mesh
+  {
+    static constexpr uint32_t kNoMaterial = UINT32_MAX;
+
+    uint32_t materialIndex;
+    std::span<const Vertex> vertices;
+    std::span<const uint32_t> indices;
+    std::vector<MeshLod> lods;
+  };
+
+  MappedFile file;
+  std::vector<std::filesystem::path> texturePaths;
+  std::vector<Material> materials;
+  std::vector<Mesh> meshes;
+};
+
+// Where the entry of the key is, whether it exists or not
+std::filesystem::path getModelCacheFilePath(const ModelCacheKey& key);
+
+// Returns std::nullopt when the model file can't be inspected
+std::optional<ModelCacheKey> createModelCacheKey(
+    const std::filesystem::path& modelFilePath,
+    uint64_t configurationFlags);
+
+// Returns std::nullopt when there is no valid cache entry for the key
+std::optional<CachedModel> readModelCache(const ModelCacheKey& key);
+
+// Failing to write the cache isn't an error, the model just won't be cached
+void writeModelCache(const ModelCacheKey& key, const Model& model);
+
+// Does nothing when there is no cache entry for the key
+void removeModelCache(const ModelCacheKey& key);
+
+}  // namespace Simple3D
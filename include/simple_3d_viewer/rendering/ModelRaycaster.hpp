@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <optional>
+#include <simple_3d_viewer/linear_algebra/boundingVolumes.hpp>
+#include <simple_3d_viewer/linear_algebra/triangleHierarchy.hpp>
+#include <simple_3d_viewer/rendering/Model.hpp>
+#include <vector>
+
+namespace Simple3D
+{
+
+// Ray queries against the full detail triangles of a model. The meshes are
+// found through the meshes hierarchy of the model and their triangles through
+// a triangle hierarchy per mesh, which the constructor builds. The model has
+// to outlive the raycaster.
+class ModelRaycaster
+{
+ public:
+  using Duration = std::chrono::duration<double, std::milli>;
+
+  struct Hit
+  {
+    size_t meshIndex;
+    uint32_t triangleIndex;
+    // In lengths of the ray direction
+    float distance;
+    // In the space of the ray
+    glm::vec3 position;
+  };
+
+  explicit ModelRaycaster(const Model& model);
+
+  // The ray is in the world space, the current transform of the model is
+  // applied to it
+  [[nodiscard]] std::optional<Hit> intersectClosest(
+      const Ray& ray,
+      float maxDistance) const;
+  [[nodiscard]] bool intersectAny(const Ray& ray, float maxDistance) const;
+
+  [[nodiscard]] size_t getNodesCount() const
+  {
+    return nodesCount_;
+  }
+
+  [[nodiscard]] Duration getBuildTime() const
+  {
+    return buildTime_;
+  }
+
+ private:
+  const Model* model_;
+  // Same order as the meshes of the model
+  std::vector<TriangleHierarchy> meshesHierarchies_;
+  size_t nodesCount_{};
+  Duration buildTime_{};
+
+  [[nodiscard]] Ray toModelSpace(const Ray& ray) const;
+};
+
+}  // namespace Simple3D
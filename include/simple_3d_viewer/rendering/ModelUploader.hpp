@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <simple_3d_viewer/rendering/Model.hpp>
+
+namespace Simple3D
+{
+
+// Spreads the OpenGL uploads of a loaded model over multiple frames, so a big
+// model doesn't stall a single frame. Every mesh is uploaded after the textures
+// of its material, which means a complete mesh can be drawn right away.
+class ModelUploader
+{
+ public:
+  using Duration = std::chrono::duration<double, std::milli>;
+
+  struct Budget
+  {
+    size_t bytesPerFrame;
+    Duration timePerFrame;
+  };
+
+  struct Statistics
+  {
+    size_t uploadedMeshesCount{};
+    size_t meshesCount{};
+    size_t uploadedTexturesCount{};
+    size_t texturesCount{};
+    size_t uploadedBytes{};
+    size_t totalBytes{};
+    // Vertex data on the GPU and what it would take with full float vertices
+    size_t vertexBytes{};
+    size_t fullFormatVertexBytes{};
+    // Index data on the GPU and what it would take with 32 bit indices
+    size_t indexBytes{};
+    size_t fullWidthIndexBytes{};
+    size_t framesCount{};
+    // Sum of the time spent uploading over all of the frames
+    Duration uploadTime{};
+    Duration lastFrameUploadTime{};
+    Duration maxFrameUploadTime{};
+  };
+
+  void start(const Model& model);
+
+  // Uploads until either part of the budget is used up, at least one texture
+  // or mesh gets uploaded per call so the upload always progresses
+  void upload(Model& model, const Budget& budget);
+
+  [[nodiscard]] bool isFinished() const
+  {
+    return finished_;
+  }
+
+  [[nodiscard]] const Statistics& getStatistics() const
+  {
+    return statistics_;
+  }
+
+ private:
+  bool finished_ = true;
+  size_t nextMeshIndex_{};
+  size_t nextTextureIndex_{};
+  Statistics statistics_;
+
+  // Returns the amount of uploaded bytes
+  size_t uploadNext(Model& model);
+};
+
+}  // namespace Simple3D
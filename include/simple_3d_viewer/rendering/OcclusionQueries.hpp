@@ -0,0 +1,115 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <random>
+#include <simple_3d_viewer/opengl_object_wrappers/Program.hpp>
+#include <simple_3d_viewer/rendering/Mesh.hpp>
+#include <simple_3d_viewer/rendering/Model.hpp>
+#include <span>
+#include <vector>
+
+namespace Simple3D
+{
+
+// Hardware occlusion queries over the nodes of the meshes hierarchy of a
+// model, scheduled after Mattausch et al., "CHC++: Coherent Hierarchical
+// Culling Revisited". The visibility of the previous frames decides what is
+// drawn: visible leaves are drawn and only requeried every few frames,
+// occluded subtrees are skipped and queried with their boxes. Results are
+// read only once they are available, so nothing ever waits for the GPU and
+// a result which takes several frames, like on software rasterizers, just
+// keeps the old visibility around for longer.
+class OcclusionQueries
+{
+ public:
+  struct Statistics
+  {
+    size_t queriesIssuedCount{};
+    // Queries whose results weren't available yet when checked, each one
+    // would have been a stall if waited for
+    size_t stallsAvoidedCount{};
+    // Meshes inside of the frustum which weren't drawn because their
+    // subtree was occluded
+    size_t skippedMeshesCount{};
+  };
+
+  using DrawMesh = std::function<void(size_t meshIndex)>;
+
+  OcclusionQueries();
+  OcclusionQueries(const OcclusionQueries&) = delete;
+  OcclusionQueries& operator=(const OcclusionQueries&) = delete;
+  OcclusionQueries(OcclusionQueries&&) = delete;
+  OcclusionQueries& operator=(OcclusionQueries&&) = delete;
+  ~OcclusionQueries()
+  {
+    release();
+  }
+
+  void release();
+
+  // Draws the complete meshes which passed the earlier culling, given by
+  // visibility, and weren't found occluded. The state is kept per model and
+  // starts over when a different one is rendered.
+  void render(
+      const Model& model,
+      std::span<const uint8_t> visibility,
+      const glm::mat4x4& projectionView,
+      const glm::vec3& cameraPosition,
+      const DrawMesh& drawMesh);
+
+  // False when the context reports no bits for the queries, everything is
+  // drawn then
+  [[nodiscard]] bool isSupported() const
+  {
+    return supported_;
+  }
+
+  [[nodiscard]] const Statistics& getStatistics() const
+  {
+    return statistics_;
+  }
+
+ private:
+  struct NodeState
+  {
+    GLuint query;
+    bool visible;
+    bool queryPending;
+    // Whether the pending query was issued around the draws of a visible
+    // leaf, rather than with the box of an occluded node
+    bool queryWithDraws;
+    uint64_t nextQueryFrame;
+  };
+
+  bool supported_;
+  Mesh box_;
+  Program boxProgram_;
+  uint64_t modelId_{};
+  uint64_t frame_{};
+  std::vector<NodeState> nodesStates_;
+  std::vector<uint32_t> parents_;
+  // Complete meshes inside of the frustum, per subtree
+  std::vector<uint32_t> nodesMeshesCounts_;
+  // In the order the queries were issued, which is the order they finish in
+  std::vector<uint32_t> pendingNodes_;
+  std::vector<uint32_t> boxQueryNodes_;
+  std::vector<uint32_t> stack_;
+  std::minstd_rand random_;
+  Statistics statistics_;
+
+  void reset(const Model& model);
+  void countMeshes(const Model& model, std::span<const uint8_t> visibility);
+  void readResults(const Model& model);
+  void setVisible(const Model& model, uint32_t nodeIndex);
+  void setOccluded(const Model& model, uint32_t nodeIndex);
+  void beginQuery(uint32_t nodeIndex, bool withDraws);
+  void queryBoxes(const Model& model, const glm::mat4x4& projectionView);
+};
+
+}  // namespace Simple3D
@@ -2,7 +2,9 @@
 
 #include "simple_3d_viewer/utils/StringHeterogeneousLookup.hpp"
 #include <simple_3d_viewer/opengl_object_wrappers/Program.hpp>
+#include <simple_3d_viewer/rendering/RenderGraph.hpp>
 #include <simple_3d_viewer/utils/Size.hpp>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -11,28 +13,22 @@ namespace Simple3D
 
 struct Postprocess
 {
-  Postprocess(Program pProgram, bool pActive)
-      : program(std::move(pProgram)),
-        active(pActive)
-  {
-  }
-
-  Program program;
-  bool active;
+  // Point-wise postprocesses only read the color of their own pixel, e.g.
+  // grayscale. Their shader defines vec4 apply(vec4 color) instead of main,
+  // so consecutive ones can be fused into a single pass. The others, e.g.
+  // FXAA, read the neighborhood and are complete fragment shaders.
+  bool pointWise;
+  std::string fragmentShader;
+  bool active{ false };
 };
 
-struct Framebuffers
+// One fullscreen draw, of a single postprocess or of consecutive point-wise
+// ones fused together
+struct PostprocessPass
 {
-  explicit Framebuffers(size_t framebuffersCount)
-      : framebuffers(framebuffersCount),
-        colorBuffers(framebuffersCount),
-        renderBuffers(framebuffersCount)
-  {
-  }
-
-  std::vector<uint> framebuffers;
-  std::vector<uint> colorBuffers;
-  std::vector<uint> renderBuffers;
+  // IDs of the postprocesses joined by +
+  std::string name;
+  Program* program;
 };
 
 struct ScreenQuad
@@ -56,8 +52,10 @@ class PostprocessPipeline
   PostprocessPipeline(PostprocessPipeline&& other) noexcept
       : idToPostprocess_(std::move(other.idToPostprocess_)),
         postprocessesOrder_(std::move(other.postprocessesOrder_)),
-        postprocessesToUpdate_(std::move(other.postprocessesToUpdate_)),
-        framebuffers_(std::move(other.framebuffers_)),
+        passPrograms_(std::move(other.passPrograms_)),
+        passes_(std::move(other.passes_)),
+        passProgramsToUpdate_(std::move(other.passProgramsToUpdate_)),
+        framebufferSize_(other.framebufferSize_),
         screenQuad_(other.screenQuad_)
   {
     other.screenQuad_.vbo = 0;
@@ -69,22 +67,43 @@ class PostprocessPipeline
     release();
   }
 
-  void start();
-
-  void finalize();
+  // Each pass reads the output of the previous one, starting from the input
+  // of the resize size, and the last one writes the output. When the output
+  // is larger the last pass also upscales, without postprocesses a pass
+  // doing only that is added.
+  void addPasses(
+      RenderGraph& renderGraph,
+      RenderGraph::ResourceID input,
+      RenderGraph::ResourceID output,
+      Size outputSize);
 
   void setPostprocessActiveFlag(const PostprocessID& id, bool active);
 
   void resize(Size framebufferSize);
 
+  [[nodiscard]] const std::vector<PostprocessPass>& getPasses() const
+  {
+    return passes_;
+  }
+
   void release();
 
  private:
   StringHeterogeneousLookupUnorderedMap<Postprocess> idToPostprocess_;
   std::vector<PostprocessID> postprocessesOrder_;
-  std::vector<PostprocessID> postprocessesToUpdate_;
-  Framebuffers framebuffers_;
+  // By pass name, fused programs are compiled the first time their
+  // combination is active and kept for later
+  StringHeterogeneousLookupUnorderedMap<Program> passPrograms_;
+  std::vector<PostprocessPass> passes_;
+  std::vector<std::string> passProgramsToUpdate_;
+  Size framebufferSize_;
   ScreenQuad screenQuad_;
+
+  // Groups postprocessesOrder_ into passes_
+  void updatePasses();
+  Program& getPassProgram(
+      const std::string& name,
+      const std::vector<const Postprocess*>& postprocesses);
 };
 
 }  // namespace Simple3D
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <glm/vec4.hpp>
+#include <map>
+#include <optional>
+#include <simple_3d_viewer/rendering/GpuProfiler.hpp>
+#include <simple_3d_viewer/utils/Size.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Simple3D
+{
+
+// Passes declare the textures they read and write, from which the graph
+// decides which passes run, how long each transient texture lives and which
+// of them can share memory. It is built again every frame, the textures and
+// framebuffers behind it are kept between the frames.
+class RenderGraph
+{
+ public:
+  using ResourceID = size_t;
+
+  enum class Format
+  {
+    RGBA8,
+    Depth24Stencil8
+  };
+
+  struct TextureDescription
+  {
+    Size size;
+    Format format;
+
+    friend bool operator==(
+        const TextureDescription& lhs,
+        const TextureDescription& rhs) = default;
+  };
+
+  enum class LoadOperation
+  {
+    // Keeps what the earlier passes wrote
+    Load,
+    Clear,
+    // The pass overwrites every pixel, so there is nothing to load or clear
+    DontCare
+  };
+
+  enum class Filter
+  {
+    Nearest,
+    // For reading a texture of a different size than the target
+    Linear
+  };
+
+  struct Read
+  {
+    ResourceID resource;
+    uint textureUnit;
+    Filter filter{ Filter::Nearest };
+  };
+
+  struct Write
+  {
+    ResourceID resource;
+    LoadOperation loadOperation{ LoadOperation::Load };
+    // Only for the color, the depth is cleared to the far plane
+    glm::vec4 clearColor{ 0.f, 0.f, 0.f, 1.f };
+  };
+
+  struct Pass
+  {
+    std::string name;
+    std::vector<Read> reads;
+    // At most one color and one depth texture, or a single imported
+    // framebuffer, all of the same size which is also the viewport
+    std::vector<Write> writes;
+    std::function<void()> execute;
+  };
+
+  struct Statistics
+  {
+    size_t passesCount{};
+    size_t culledPassesCount{};
+    size_t transientTexturesCount{};
+    size_t physicalTexturesCount{};
+    // Of the physical textures, and what giving every transient texture its
+    // own would take
+    size_t memoryBytes{};
+    size_t unaliasedMemoryBytes{};
+    size_t clearsCount{};
+    size_t framebufferBindsCount{};
+  };
+
+  RenderGraph() = default;
+  RenderGraph(const RenderGraph&) = delete;
+  RenderGraph& operator=(const RenderGraph&) = delete;
+  RenderGraph(RenderGraph&&) = delete;
+  RenderGraph& operator=(RenderGraph&&) = delete;
+  ~RenderGraph()
+  {
+    release();
+  }
+
+  // Forgets the passes and the resources of the previous frame
+  void reset();
+
+  ResourceID createTexture(
+      std::string name,
+      const TextureDescription& description);
+
+  // Framebuffer with its own color and depth which outlives the frame, e.g.
+  // the default one. Whatever ends up in it is the result of the graph, so
+  // only passes contributing to some imported framebuffer are kept.
+  ResourceID importFramebuffer(std::string name, uint framebuffer, Size size);
+
+  void addPass(Pass pass);
+
+  // Culls the passes, assigns the physical textures and decides where to
+  // bind and clear
+  void compile();
+
+  // Every pass is measured under its name
+  void execute(GpuProfiler& profiler);
+
+  [[nodiscard]] const Statistics& getStatistics() const
+  {
+    return statistics_;
+  }
+
+  void release();
+
+ private:
+  struct Resource
+  {
+    std::string name;
+    TextureDescription description;
+    std::optional<uint> importedFramebuffer;
+    // Range of the executed passes using it and the physical texture behind
+    // it, set by compile
+    size_t firstPass;
+    size_t lastPass;
+    uint physicalTexture;
+  };
+
+  struct PhysicalTexture
+  {
+    TextureDescription description;
+    uint texture;
+    // Last pass of the resources aliased to it in this frame
+    std::optional<size_t> busyUntil;
+  };
+
+  struct CompiledPass
+  {
+    size_t passIndex;
+    uint framebuffer;
+    Size viewport;
+    uint clearMask;
+    glm::vec4 clearColor;
+  };
+
+  std::vector<Resource> resources_;
+  std::vector<Pass> passes_;
+  std::vector<CompiledPass> compiledPasses_;
+  std::vector<PhysicalTexture> physicalTextures_;
+  // By the color and the depth texture, 0 for a missing attachment
+  std::map<std::pair<uint, uint>, uint> framebuffers_;
+  // Sampler object overriding the filtering of the textures, created on the
+  // first linear read
+  uint linearSampler_{ 0 };
+  Statistics statistics_;
+
+  void validate(const Pass& pass) const;
+  [[nodiscard]] std::vector<uint8_t> cullPasses() const;
+  void assignPhysicalTextures(const std::vector<size_t>& executedPasses);
+  [[nodiscard]] uint getFramebuffer(const Pass& pass);
+};
+
+}  // namespace Simple3D
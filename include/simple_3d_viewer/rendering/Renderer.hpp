@@ -2,13 +2,24 @@
 
 #include <glad/glad.h>
 
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <simple_3d_viewer/linear_algebra/frustumCulling.hpp>
+#include <simple_3d_viewer/linear_algebra/occlusionCulling.hpp>
+#include <simple_3d_viewer/opengl_object_wrappers/Framebuffer.hpp>
 #include <simple_3d_viewer/opengl_object_wrappers/Program.hpp>
 #include <simple_3d_viewer/opengl_object_wrappers/Texture.hpp>
+#include <simple_3d_viewer/rendering/GpuProfiler.hpp>
 #include <simple_3d_viewer/rendering/Mesh.hpp>
 #include <simple_3d_viewer/rendering/Model.hpp>
+#include <simple_3d_viewer/rendering/OcclusionQueries.hpp>
 #include <simple_3d_viewer/rendering/PostprocessPipeline.hpp>
+#include <simple_3d_viewer/rendering/RenderGraph.hpp>
+#include <simple_3d_viewer/rendering/ResolutionScaler.hpp>
 #include <simple_3d_viewer/rendering/Scene.hpp>
 #include <simple_3d_viewer/utils/Size.hpp>
+#include <utility>
 
 namespace Simple3D
 {
@@ -16,6 +27,22 @@ namespace Simple3D
 class Renderer
 {
  public:
+  struct Statistics
+  {
+    // Model triangles drawn in the last frame and what drawing the same
+    // meshes in full detail would take
+    size_t submittedTrianglesCount{};
+    size_t fullDetailTrianglesCount{};
+    // Includes the occluded meshes
+    size_t culledMeshesCount{};
+    size_t drawCallsCount{};
+    size_t occludedMeshesCount{};
+    size_t occludersCount{};
+    size_t occluderTrianglesCount{};
+    std::chrono::duration<double, std::milli> occlusionCullingTime{};
+    OcclusionQueries::Statistics occlusionQueries;
+  };
+
   Renderer(
       const std::vector<PostprocessID>& postprocessIDs,
       Size framebufferSize)
@@ -24,10 +51,61 @@ class Renderer
   }
 
   PostprocessPipeline postprocessPipeline_;
+  // The scene and the postprocesses are rendered at a fraction of the
+  // framebuffer size and upscaled by the last pass
+  ResolutionScaler resolutionScaler_;
   bool drawLight_{ true };
+  bool frustumCulling_{ true };
+  bool occlusionCulling_{ false };
+  // Uses the visibility of the previous frames, so newly visible meshes can
+  // show up a frame late
+  bool occlusionQueries_{ false };
+  // Largest error in pixels a level of detail can have on the screen to be
+  // picked, zero always picks the full detail
+  float maxLodError_{ 1.f };
+  // Renders into a framebuffer of its own which is then copied to the
+  // output, so presentLastFrame can show the frame again
+  bool keepLastFrame_{ false };
 
   void render(Scene& scene, Size framebufferSize);
 
+  // Copies the kept frame to the output, false when there is none of the
+  // size to copy
+  [[nodiscard]] bool presentLastFrame(Size framebufferSize);
+
+  // Where the frame ends up, the default framebuffer unless rendering
+  // offscreen
+  void setOutputFramebuffer(uint framebuffer)
+  {
+    outputFramebuffer_ = framebuffer;
+  }
+
+  [[nodiscard]] const Statistics& getStatistics() const
+  {
+    return statistics_;
+  }
+
+  [[nodiscard]] const GpuProfiler& getGpuProfiler() const
+  {
+    return gpuProfiler_;
+  }
+
+  [[nodiscard]] const RenderGraph& getRenderGraph() const
+  {
+    return renderGraph_;
+  }
+
+  // Of the last frame
+  [[nodiscard]] Size getFramebufferSize() const
+  {
+    return cache_.framebufferSize.value;
+  }
+
+  [[nodiscard]] Size getRenderSize() const
+  {
+    return cache_.renderSize.value;
+  }
+
  private:
   template<typename T>
   struct CachePair
@@ -61,6 +139,10 @@ class Renderer
 
       CachePair<IDType> modelProgramID{ idTypeMaxValue, false };
       CachePair<IDType> materialID{ idTypeMaxValue, false };
+      // Whether the normals are octahedral encoded and the position scale and
+      // offset
+      using VertexDecoding = std::pair<bool, PositionQuantization>;
+      CachePair<std::optional<VertexDecoding>> vertexDecoding{};
       CachePair<glm::mat4x4> modelTransform{};
       CachePair<std::pair<glm::mat4x4, glm::mat4x4>> projectionViewTransform{};
       CachePair<glm::vec3> cameraPosition{
@@ -76,6 +158,7 @@ class Renderer
       {
         modelProgramID.value = idTypeMaxValue;
         materialID.value = idTypeMaxValue;
+        vertexDecoding.value = std::nullopt;
         modelTransform.value = {};
         projectionViewTransform.value = {};
         cameraPosition.value = { floatMaxValue, floatMaxValue, floatMaxValue };
@@ -84,12 +167,47 @@ class Renderer
     };
     ModelProgramUniformsCache modelProgramUniformsCache;
     CachePair<Size> framebufferSize{};
+    CachePair<Size> renderSize{};
+    size_t gpuFramesCount{};
   };
   Cache cache_;
 
-  void performCacheChecks(Scene& scene, Size framebufferSize);
-  void render(Model& model, Program& program);
-  void render(Mesh& mesh, Program& program);
+  struct LodSelection
+  {
+    glm::vec3 cameraPosition;
+    float projectionScale;
+  };
+
+  Statistics statistics_;
+  GpuProfiler gpuProfiler_;
+  // Rebuilt every frame from the scene passes and the active postprocesses
+  RenderGraph renderGraph_;
+  uint outputFramebuffer_{ 0 };
+  std::optional<Framebuffer> lastFrame_;
+  // World space, updated whenever the projection or the view changes
+  Frustum frustum_{};
+  // Per mesh results of the culling, kept around to avoid allocating them
+  // every frame
+  std::vector<uint8_t> meshesVisibility_;
+  OcclusionBuffer occlusionBuffer_;
+  // Updated together with the frustum
+  glm::mat4x4 projectionView_{};
+  OcclusionQueries occlusionQueriesScheduler_;
+
+  void
+  performCacheChecks(Scene& scene, Size framebufferSize, Size renderSize);
+  void render(Model& model, Program& program, const LodSelection& lodSelection);
+  void cullOccludedMeshes(
+      const Model& model,
+      float modelScale,
+      const glm::vec3& cameraPosition);
+  [[nodiscard]] size_t selectLod(
+      const Mesh& mesh,
+      const glm::mat4x4& modelTransform,
+      float modelScale,
+      const LodSelection& lodSelection) const;
+  void setVertexDecoding(const Mesh& mesh, Program& program);
+  void render(Mesh& mesh, Program& program, size_t lodLevel = 0);
   void
   renderSkybox(Mesh& skybox, Program& skyboxProgram, Texture& skyboxTexture);
 };
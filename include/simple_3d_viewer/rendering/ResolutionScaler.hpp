@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <simple_3d_viewer/rendering/GpuProfiler.hpp>
+#include <simple_3d_viewer/utils/Size.hpp>
+#include <vector>
+
+namespace Simple3D
+{
+
+// Picks the fraction of the framebuffer size the scene is rendered at from
+// how long the GPU took for the recent frames. The cost of a frame is mostly
+// proportional to its pixels, so the scale follows the square root of the
+// ratio between the target and the measured frame time.
+class ResolutionScaler
+{
+ public:
+  using Duration = GpuProfiler::Duration;
+
+  static constexpr float kMinScale = 0.5f;
+  static constexpr float kMaxScale = 1.f;
+  // The controller only picks multiples of it, so the render targets aren't
+  // reallocated for every small change
+  static constexpr float kScaleStep = 0.05f;
+  static constexpr size_t kHistorySize = 256;
+
+  enum class Mode
+  {
+    Automatic,
+    Pinned
+  };
+
+  struct Settings
+  {
+    Mode mode;
+    float pinnedScale;
+    Duration targetFrameTime;
+
+    friend bool operator==(const Settings& lhs, const Settings& rhs) = default;
+  };
+
+  // Called once per frame, with the GPU time of a frame if a new one was
+  // measured since the last call
+  void update(std::optional<Duration> frameTime);
+
+  [[nodiscard]] Size apply(Size framebufferSize) const;
+
+  void setSettings(const Settings& settings);
+
+  [[nodiscard]] const Settings& getSettings() const
+  {
+    return settings_;
+  }
+
+  [[nodiscard]] float getScale() const
+  {
+    return scale_;
+  }
+
+  // Smoothed over the measurements since the scale last changed
+  [[nodiscard]] Duration getFrameTime() const
+  {
+    return frameTime_;
+  }
+
+  // Scales of the last frames, the oldest first
+  [[nodiscard]] std::vector<float> getHistory() const;
+
+ private:
+  Settings settings_{ Mode::Automatic, kMaxScale, Duration(1000. / 60.) };
+  float scale_{ kMaxScale };
+  Duration frameTime_{};
+  size_t measurementsCount_{};
+  std::array<float, kHistorySize> history_{};
+  size_t framesCount_{};
+
+  void adjust(Duration frameTime);
+  void setScale(float scale);
+};
+
+}  // namespace Simple3D
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <EGL/egl.h>
+
+namespace Simple3D
+{
+
+// OpenGL 3.3 core context made current without any window or surface, for
+// the benchmarks. Rendering has to go into framebuffer objects. Mesa provides
+// it without a display server or a GPU through llvmpipe.
+class HeadlessContext
+{
+ public:
+  HeadlessContext();
+  HeadlessContext(const HeadlessContext&) = delete;
+  HeadlessContext& operator=(const HeadlessContext&) = delete;
+  HeadlessContext(HeadlessContext&&) = delete;
+  HeadlessContext& operator=(HeadlessContext&&) = delete;
+  ~HeadlessContext()
+  {
+    release();
+  }
+
+ private:
+  EGLDisplay display_{ EGL_NO_DISPLAY };
+  EGLContext context_{ EGL_NO_CONTEXT };
+
+  void create();
+  void release();
+};
+
+}  // namespace Simple3D
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace Simple3D
+{
+
+// Read only memory mapping of a whole file
+class MappedFile
+{
+ public:
+  MappedFile() = delete;
+  explicit MappedFile(const std::filesystem::path& filePath);
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  ~MappedFile()
+  {
+    release();
+  }
+
+  void release();
+
+  [[nodiscard]] std::span<const std::byte> getData() const
+  {
+    return { data_, size_ };
+  }
+
+ private:
+  const std::byte* data_ = nullptr;
+  size_t size_ = 0;
+#ifdef _WIN32
+  void* fileHandle_ = nullptr;
+  void* mappingHandle_ = nullptr;
+#endif
+};
+
+}  // namespace Simple3D
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <string>
+
+// Zones are only recorded when SIMPLE3D_ENABLE_PROFILER is defined, which the
+// Simple3DViewer_ENABLE_PROFILER CMake option does. Otherwise the macros
+// compile to nothing, their argument is only named in a branch that is never
+// taken, so variables used just for it don't count as unused. An unevaluated
+// sizeof wouldn't do for captures of lambdas.
+#ifdef SIMPLE3D_ENABLE_PROFILER
+#define SIMPLE3D_PROFILER_CONCAT_IMPL(first, second) first##second
+#define SIMPLE3D_PROFILER_CONCAT(first, second) \
+  SIMPLE3D_PROFILER_CONCAT_IMPL(first, second)
+// Records the time from here to the end of the enclosing scope, the name has
+// to be a string literal
+#define SIMPLE3D_PROFILE_ZONE(name)                           \
+  const ::Simple3D::Profiler::Zone SIMPLE3D_PROFILER_CONCAT( \
+      simple3DProfilerZone, __LINE__)                         \
+  {                                                           \
+    name                                                      \
+  }
+#define SIMPLE3D_PROFILE_THREAD(name) \
+  ::Simple3D::Profiler::setThreadName(name)
+#else
+#define SIMPLE3D_PROFILER_IGNORE(name) \
+  static_cast<void>(false && (static_cast<void>(name), true))
+#define SIMPLE3D_PROFILE_ZONE(name) SIMPLE3D_PROFILER_IGNORE(name)
+#define SIMPLE3D_PROFILE_THREAD(name) SIMPLE3D_PROFILER_IGNORE(name)
+#endif
+
+namespace Simple3D
+{
+
+// Scoped zones of the CPU work, recorded into a ring buffer per thread. Only
+// the owning thread writes into a buffer, without any locking, and exporting
+// reads them concurrently, dropping whatever got overwritten meanwhile. The
+// buffers of threads that have ended are reused by the new ones.
+class Profiler
+{
+ public:
+  using Clock = std::chrono::steady_clock;
+
+#ifdef SIMPLE3D_ENABLE_PROFILER
+  static constexpr bool kEnabled = true;
+#else
+  static constexpr bool kEnabled = false;
+#endif
+  // Per thread, older zones get overwritten
+  static constexpr size_t kZonesCapacity = size_t{ 1 } << 15;
+
+  class Zone
+  {
+   public:
+    explicit Zone(const char* name)
+        : name_(name),
+          start_(Clock::now())
+    {
+    }
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+    Zone(Zone&&) = delete;
+    Zone& operator=(Zone&&) = delete;
+    ~Zone()
+    {
+      Profiler::record(name_, start_, Clock::now());
+    }
+
+   private:
+    const char* name_;
+    Clock::time_point start_;
+  };
+
+  // Shown instead of the thread ID in the trace
+  static void setThreadName(std::string name);
+
+  // Writes the zones of all threads as Chrome Trace Event JSON, which can be
+  // opened in chrome://tracing or Perfetto. Returns the number of zones
+  // written.
+  static size_t exportChromeTrace(const std::filesystem::path& path);
+
+ private:
+  struct ThreadZones;
+  struct Registry;
+
+  static void
+  record(const char* name, Clock::time_point start, Clock::time_point end);
+  static ThreadZones& getThreadZones();
+  static Registry& getRegistry();
+};
+
+}  // namespace Simple3D
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <GLFW/glfw3.h>
+
+#include <atomic>
+#include <simple_3d_viewer/utils/processCpuTime.hpp>
+
+namespace Simple3D
+{
+
+// Decides whether the next frame has to render the scene, can show the last
+// rendered one again under a new GUI or can be skipped, in which case the
+// main loop sleeps until an event arrives. Redraws can be requested from any
+// thread, everything else is for the main thread.
+class RedrawScheduler
+{
+ public:
+  enum class Redraw
+  {
+    None,
+    // Only the GUI changed, the last frame of the scene can be presented
+    Gui,
+    Scene
+  };
+
+  // Frames drawn after a request, the GUI takes a few frames to settle after
+  // the input, e.g. a hovered widget lights up only on the next one
+  static constexpr int kSettleFramesCount = 3;
+  // Waiting for events is cut short after it, so the reports stay current
+  static constexpr double kMaxWaitSeconds = 1.;
+
+  // Measured over about a second
+  struct Statistics
+  {
+    double renderedFramesPerSecond;
+    double presentedFramesPerSecond;
+    // Fraction of the time spent waiting for events
+    double idleFraction;
+    // Process CPU time over the wall time, 1 for a fully used core
+    double cpuUsage;
+  };
+
+  // Otherwise the scene is rendered every frame
+  bool onDemand_{ true };
+
+  RedrawScheduler() = default;
+  // The window callbacks point to it
+  RedrawScheduler(const RedrawScheduler&) = delete;
+  RedrawScheduler& operator=(const RedrawScheduler&) = delete;
+  RedrawScheduler(RedrawScheduler&&) = delete;
+  RedrawScheduler& operator=(RedrawScheduler&&) = delete;
+  ~RedrawScheduler() = default;
+
+  // Installs the window callbacks requesting the redraws, before ImGui
+  // installs its own so that it passes the input on to them
+  void watch(GLFWwindow* window);
+
+  // Other threads should wake the main loop afterwards with
+  // glfwPostEmptyEvent
+  void requestSceneRedraw()
+  {
+    sceneRedrawRequested_.store(true, std::memory_order_relaxed);
+    requestGuiRedraw();
+  }
+
+  void requestGuiRedraw()
+  {
+    guiFramesLeft_.store(kSettleFramesCount, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] Redraw getRedraw() const;
+
+  // The requests made so far are covered by the frame, the ones made while
+  // it's being drawn lead to another one
+  void startFrame(Redraw redraw);
+
+  // Blocks until an event arrives or kMaxWaitSeconds pass, events from other
+  // threads are posted with glfwPostEmptyEvent
+  void waitForEvents();
+
+  [[nodiscard]] const Statistics& getStatistics() const
+  {
+    return statistics_;
+  }
+
+ private:
+  std::atomic<bool> sceneRedrawRequested_{ true };
+  std::atomic<int> guiFramesLeft_{ kSettleFramesCount };
+  Statistics statistics_{};
+  // Since the statistics were last updated
+  double periodStart_{ glfwGetTime() };
+  double periodCpuStart_{ getProcessCpuTime() };
+  int renderedFramesCount_{};
+  int presentedFramesCount_{};
+  double idleTime_{};
+
+  void updateStatistics();
+};
+
+}  // namespace Simple3D
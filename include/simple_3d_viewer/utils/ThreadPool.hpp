@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Simple3D
+{
+
+// Fixed size pool of worker threads. The only supported kind of work is a
+// blocking parallel for loop, the calling thread takes part in executing its
+// own loop so nested or concurrent calls can't deadlock the pool.
+class ThreadPool
+{
+ public:
+  explicit ThreadPool(size_t workersCount);
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ThreadPool(ThreadPool&&) = delete;
+  ThreadPool& operator=(ThreadPool&&) = delete;
+  ~ThreadPool();
+
+  // Calls function(i) for every i in [0, count) and returns once all calls
+  // have finished. The first exception thrown by any of the calls is
+  // rethrown on the calling thread.
+  void parallelFor(size_t count, const std::function<void(size_t)>& function);
+
+  [[nodiscard]] size_t getWorkersCount() const
+  {
+    return workers_.size();
+  }
+
+  // Number of threads that can work on a single parallelFor call, workers
+  // plus the calling thread
+  [[nodiscard]] size_t getConcurrency() const
+  {
+    return workers_.size() + 1;
+  }
+
+ private:
+  struct Job
+  {
+    const std::function<void(size_t)>* function;
+    size_t count;
+    std::atomic<size_t> nextIndex{ 0 };
+    std::atomic<size_t> finishedCount{ 0 };
+    std::mutex exceptionMutex;
+    std::exception_ptr exception;
+  };
+
+  std::vector<std::jthread> workers_;
+  std::mutex jobsMutex_;
+  std::condition_variable jobsCondition_;
+  std::deque<std::shared_ptr<Job>> jobs_;
+  bool stopping_{ false };
+
+  void workerLoop();
+  static void execute(Job& job);
+};
+
+// Pool shared by the whole application, sized to the number of hardware
+// threads
+ThreadPool& getThreadPool();
+
+}  // namespace Simple3D
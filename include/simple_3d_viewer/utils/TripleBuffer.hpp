@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace Simple3D
+{
+
+// Hands values from one producer thread to one consumer thread without any
+// locking. The producer writes into a buffer of its own and publishes it,
+// the consumer reads the latest published one, so neither waits for the
+// other to finish with a buffer. A value published before the consumer got
+// to the previous one replaces it.
+template<typename T>
+class TripleBuffer
+{
+ public:
+  TripleBuffer() = default;
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+  TripleBuffer(TripleBuffer&&) = delete;
+  TripleBuffer& operator=(TripleBuffer&&) = delete;
+  ~TripleBuffer() = default;
+
+  // Producer, holds whatever was written into it a few publishes ago
+  [[nodiscard]] T& getWriteBuffer()
+  {
+    return buffers_[writeIndex_];
+  }
+
+  // Producer
+  void publish()
+  {
+    const auto previousState =
+        state_.exchange(writeIndex_ | kPublishedBit, std::memory_order_acq_rel);
+    writeIndex_ = previousState & kIndexMask;
+    state_.notify_all();
+  }
+
+  // Producer, blocks while the last published value wasn't acquired yet
+  void waitForAcquire() const
+  {
+    for (auto state = state_.load(std::memory_order_acquire);
+         (state & kPublishedBit) != 0;
+         state = state_.load(std::memory_order_acquire))
+    {
+      state_.wait(state, std::memory_order_acquire);
+    }
+  }
+
+  // Consumer, returns whether a new value was published since the last call
+  bool acquire()
+  {
+    if ((state_.load(std::memory_order_relaxed) & kPublishedBit) == 0)
+    {
+      return false;
+    }
+
+    const auto previousState =
+        state_.exchange(readIndex_, std::memory_order_acq_rel);
+    readIndex_ = previousState & kIndexMask;
+    state_.notify_all();
+    return true;
+  }
+
+  // Consumer, blocks until a new value is published
+  void waitForPublish() const
+  {
+    for (auto state = state_.load(std::memory_order_acquire);
+         (state & kPublishedBit) == 0;
+         state = state_.load(std::memory_order_acquire))
+    {
+      state_.wait(state, std::memory_order_acquire);
+    }
+  }
+
+  // Consumer, the last acquired value
+  [[nodiscard]] const T& getReadBuffer() const
+  {
+    return buffers_[readIndex_];
+  }
+
+ private:
+  // The state holds the index of the buffer in between the producer and the
+  // consumer, and whether it was published since the consumer last took it
+  static constexpr uint8_t kIndexMask = 0b011;
+  static constexpr uint8_t kPublishedBit = 0b100;
+
+  std::array<T, 3> buffers_{};
+  std::atomic<uint8_t> state_{ 1 };
+  // Each only touched by its own thread
+  uint8_t writeIndex_{ 0 };
+  uint8_t readIndex_{ 2 };
+};
+
+}  // namespace Simple3D
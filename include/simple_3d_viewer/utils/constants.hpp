@@ -3,6 +3,7 @@
 #include <filesystem>
 #include <glm/ext/vector_float2.hpp>
 #include <glm/ext/vector_float3.hpp>
+#include <simple_3d_viewer/utils/fileOperations.hpp>
 #include <vector>
 
 namespace Simple3D
@@ -20,6 +21,20 @@ inline const std::filesystem::path& kTexturesDirPath()
   return result;
 }
 
+// Next to the executable, so the viewer finds its cache wherever it's
+// launched from
+inline const std::filesystem::path& kModelCacheDirPath()
+{
+  static auto result = getExecutableDirPath() / "cache/models/";
+  return result;
+}
+
+inline const std::filesystem::path& kCpuTracePath()
+{
+  static auto result = std::filesystem::current_path() / "cpu_trace.json";
+  return result;
+}
+
 inline const std::vector<std::filesystem::path>& kSkyboxImagesPaths()
 {
   static std::vector<std::filesystem::path> result = {
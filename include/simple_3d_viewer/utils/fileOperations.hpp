@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 #include <simple_3d_viewer/utils/Image.hpp>
+#include <simple_3d_viewer/utils/Size.hpp>
 #include <string>
 
 namespace Simple3D
@@ -9,6 +11,14 @@ namespace Simple3D
 
 std::string loadFileIntoString(const std::filesystem::path& filePath);
 
+// The directory of the running executable, or the working directory when the
+// platform doesn't tell
+std::filesystem::path getExecutableDirPath();
+
+// Safe to call from multiple threads at once
 Image loadImage(const std::filesystem::path& filePath, bool flipVertically);
 
+// Flips the rows of a tightly packed 8 bit per channel image in place
+void flipImageVertically(uint8_t* image, Size size, int colorChannelCount);
+
 }  // namespace Simple3D
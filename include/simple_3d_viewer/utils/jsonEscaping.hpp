@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace Simple3D
+{
+
+// Escapes the text for a JSON string, quotes, backslashes and control
+// characters. Other bytes are kept, so UTF-8 stays as it is.
+std::string escapeJson(std::string_view text);
+
+}  // namespace Simple3D
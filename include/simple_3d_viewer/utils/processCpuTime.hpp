@@ -0,0 +1,10 @@
+#pragma once
+
+namespace Simple3D
+{
+
+// CPU time used by all threads of the process so far, in seconds. Unlike
+// std::clock it doesn't count the wall time on Windows.
+double getProcessCpuTime();
+
+}  // namespace Simple3D
@@ -1,13 +1,7 @@
-#version 330 core
-
-in vec2 TexCoord;
-uniform sampler2D screenTexture;
-
-out vec4 FragColor;
-
-void main()
+// Point-wise, the pipeline generates main and fuses this pass with the
+// point-wise passes next to it
+vec4 apply(vec4 color)
 {
-  FragColor = texture(screenTexture, TexCoord);
-  float average = 0.2126 * FragColor.r + 0.7152 * FragColor.g + 0.0722 * FragColor.b;
-  FragColor = vec4(average, average, average, 1.0);
-}   
\ No newline at end of file
+  float average = 0.2126 * color.r + 0.7152 * color.g + 0.0722 * color.b;
+  return vec4(average, average, average, 1.0);
+}
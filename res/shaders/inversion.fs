@@ -1,11 +1,6 @@
-#version 330 core
-
-in vec2 TexCoord;
-uniform sampler2D screenTexture;
-
-out vec4 FragColor;
-
-void main()
+// Point-wise, the pipeline generates main and fuses this pass with the
+// point-wise passes next to it
+vec4 apply(vec4 color)
 {
-  FragColor = vec4(vec3(1.0 - texture(screenTexture, TexCoord)), 1.0);
-}  
\ No newline at end of file
+  return vec4(vec3(1.0 - color), 1.0);
+}
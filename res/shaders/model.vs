@@ -19,16 +19,31 @@ out vec2 TexCoord4;
 
 uniform mat4 model;
 uniform mat4 pv;
+// Decoding of the compact vertex format, identity for full float vertices
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+uniform bool octahedralNormals;
+
+vec3 decodeOctahedral(vec2 encodedNormal)
+{
+  vec3 normal = vec3(encodedNormal, 1.0 - abs(encodedNormal.x) - abs(encodedNormal.y));
+  float fold = max(-normal.z, 0.0);
+  normal.x += normal.x >= 0.0 ? -fold : fold;
+  normal.y += normal.y >= 0.0 ? -fold : fold;
+  return normalize(normal);
+}
 
 void main()
 {
-  FragPosition = vec3(model * vec4(iPos, 1.0));
-  Normal = mat3(transpose(inverse(model))) * iNormal;
+  vec3 position = iPos * positionScale + positionOffset;
+  vec3 normal = octahedralNormals ? decodeOctahedral(iNormal.xy) : iNormal;
+  FragPosition = vec3(model * vec4(position, 1.0));
+  Normal = mat3(transpose(inverse(model))) * normal;
   Color = iColor;
   TexCoord0 = iTexCoord0;    
   TexCoord1 = iTexCoord1;    
   TexCoord2 = iTexCoord2;    
   TexCoord3 = iTexCoord3;    
   TexCoord4 = iTexCoord4;    
-  gl_Position = pv * model * vec4(iPos, 1.0);
+  gl_Position = pv * model * vec4(position, 1.0);
 }
\ No newline at end of file
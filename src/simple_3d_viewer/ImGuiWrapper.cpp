@@ -7,6 +7,7 @@
 #include <mutex>
 #include <optional>
 #include <simple_3d_viewer/ImGuiWrapper.hpp>
+#include <simple_3d_viewer/utils/Profiler.hpp>
 #include <stdexcept>
 
 namespace Simple3D
@@ -26,6 +27,9 @@ void init(GLFWwindow* window)
   ImGui_ImplGlfw_InitForOpenGL(window, true);
   const char* glslVersion = "#version 330";
   ImGui_ImplOpenGL3_Init(glslVersion);
+  // Creates the shaders and the font texture, the later calls don't touch
+  // OpenGL, which the GUI frames are built without
+  ImGui_ImplOpenGL3_NewFrame();
 }
 
 void sync(ImGuiWrapper::Mediator& mediator)
@@ -36,6 +40,9 @@ void sync(ImGuiWrapper::Mediator& mediator)
   mediator.notify(VisualizeLightPositionCheckboxChange);
   mediator.notify(CameraControlsChange);
   mediator.notify(ModelLoadingConfigurationChange);
+  mediator.notify(ModelUploadControlsChange);
+  mediator.notify(RenderingControlsChange);
+  mediator.notify(FramePacingControlsChange);
 }
 
 bool BeginPopupCentered(const std::string& name)
@@ -88,6 +95,14 @@ bool drawSliders(Sliders& sliders)
   return changed;
 }
 
+void drawReport(const ReportLines& report)
+{
+  for (const auto& line : report)
+  {
+    ImGui::TextUnformatted(line.c_str());
+  }
+}
+
 void resetSliders(Sliders& sliders)
 {
   for (auto& slider : sliders)
@@ -105,6 +120,40 @@ void drawMainArea()
   ImGui::Separator();
 }
 
+void drawFramePacingArea(
+    Checkboxes& framePacingControlsCheckboxes,
+    const ReportLines& framePacingReport,
+    const ReportLines& presentationReport,
+    ImGuiWrapper::Mediator& mediator)
+{
+  ImGui::Text("Frame pacing:");
+  if (drawCheckboxes(framePacingControlsCheckboxes))
+  {
+    mediator.notify(ImGuiWrapper::Event::FramePacingControlsChange);
+  }
+  drawReport(framePacingReport);
+  drawReport(presentationReport);
+  ImGui::Separator();
+}
+
+void drawProfilingArea(
+    const ReportLines& gpuTimingsReport,
+    const ReportLines& cpuTraceReport,
+    ImGuiWrapper::Mediator& mediator)
+{
+  ImGui::Text("GPU timings:");
+  drawReport(gpuTimingsReport);
+  if constexpr (Profiler::kEnabled)
+  {
+    if (ImGui::Button("Export CPU trace"))
+    {
+      mediator.notify(ImGuiWrapper::Event::ExportCpuTrace);
+    }
+    drawReport(cpuTraceReport);
+  }
+  ImGui::Separator();
+}
+
 void drawPostprocessesArea(
     Checkboxes& postprocessesCheckboxes,
     ImGuiWrapper::Mediator& mediator)
@@ -173,6 +222,7 @@ std::optional<std::filesystem::path> loadModelDialog()
 std::optional<std::filesystem::path> drawModelArea(
     Sliders& modelTransformSliders,
     Checkboxes& modelLoadingConfigurationCheckboxes,
+    const ReportLines& modelLoadingReport,
     ImGuiWrapper::Mediator& mediator)
 {
   ImGui::Text("Model controls:");
@@ -199,11 +249,84 @@ std::optional<std::filesystem::path> drawModelArea(
   {
     mediator.notify(ImGuiWrapper::Event::ReloadProgram);
   }
+
+  if (!modelLoadingReport.empty())
+  {
+    ImGui::Spacing();
+    ImGui::Text("Last model loading:");
+    drawReport(modelLoadingReport);
+  }
   ImGui::Separator();
 
   return result;
 }
 
+void drawModelUploadArea(
+    Sliders& modelUploadControlsSliders,
+    const ReportLines& modelUploadReport,
+    ImGuiWrapper::Mediator& mediator)
+{
+  ImGui::Text("Model upload controls (budget per frame):");
+  if (drawSliders(modelUploadControlsSliders))
+  {
+    mediator.notify(ImGuiWrapper::Event::ModelUploadControlsChange);
+  }
+
+  if (!modelUploadReport.empty())
+  {
+    ImGui::Spacing();
+    ImGui::Text("Last model upload:");
+    drawReport(modelUploadReport);
+  }
+  ImGui::Separator();
+}
+
+void drawRenderingArea(
+    Sliders& renderingControlsSliders,
+    Checkboxes& renderingControlsCheckboxes,
+    const ReportLines& renderingReport,
+    const std::vector<float>& renderScaleHistory,
+    ImGuiWrapper::Mediator& mediator)
+{
+  ImGui::Text("Rendering controls:");
+  // Both are always drawn, a short-circuit would hide the checkboxes for a
+  // frame whenever a slider changes
+  const auto slidersChanged = drawSliders(renderingControlsSliders);
+  const auto checkboxesChanged = drawCheckboxes(renderingControlsCheckboxes);
+  if (slidersChanged || checkboxesChanged)
+  {
+    mediator.notify(ImGuiWrapper::Event::RenderingControlsChange);
+  }
+
+  if (!renderingReport.empty())
+  {
+    ImGui::Spacing();
+    ImGui::Text("Last frame:");
+    drawReport(renderingReport);
+  }
+  if (!renderScaleHistory.empty())
+  {
+    static constexpr float kPlotHeight = 60.f;
+    ImGui::PlotLines(
+        "Render scale",
+        renderScaleHistory.data(),
+        static_cast<int>(renderScaleHistory.size()),
+        0,
+        nullptr,
+        0.f,
+        1.f,
+        ImVec2(0.f, kPlotHeight));
+  }
+  ImGui::Separator();
+}
+
+void drawPickingArea(const ReportLines& pickingReport)
+{
+  ImGui::Text("Picking (left click on the model):");
+  drawReport(pickingReport);
+  ImGui::Separator();
+}
+
 void drawCameraArea(
     Sliders& cameraControlsSliders,
     ImGuiWrapper::Mediator& mediator)
@@ -251,7 +374,28 @@ ImGuiWrapper::ImGuiWrapper(
                               { "Scale X", 1.f, 1.f, 0.f, 100.f },
                               { "Scale Y", 1.f, 1.f, 0.f, 100.f },
                               { "Scale Z", 1.f, 1.f, 0.f, 100.f } },
-      modelLoadingConfigurationCheckboxes_{ { "Flip UVs", false } },
+      modelLoadingConfigurationCheckboxes_{
+        { "Flip UVs", false },
+        { "Use model cache", true },
+        { "Compact vertex format", false },
+        { "Optimize meshes", true },
+        { "Generate LODs", true },
+        { "Measure serial texture decoding", false }
+      },
+      modelUploadControlsSliders_{ { "Upload MiB", 32.f, 32.f, 1.f, 512.f },
+                                   { "Upload ms", 4.f, 4.f, 0.5f, 50.f } },
+      renderingControlsSliders_{ { "Max LOD error px", 1.f, 1.f, 0.f, 16.f },
+                                 { "Target GPU ms", 16.7f, 16.7f, 2.f, 50.f },
+                                 { "Pinned render scale %",
+                                   100.f,
+                                   100.f,
+                                   50.f,
+                                   100.f } },
+      renderingControlsCheckboxes_{ { "Frustum culling", true },
+                                    { "Occlusion culling", false },
+                                    { "Occlusion queries", false },
+                                    { "Pin render scale", false } },
+      framePacingControlsCheckboxes_{ { "Render on demand", true } },
       cameraControlsSliders_{ { "Speed", 2.f, 2.f, 0.1f, 100.f },
                               { "Sensitivity", 5.0f, 5.0f, 0.1f, 20.f } }
 {
@@ -260,6 +404,7 @@ ImGuiWrapper::ImGuiWrapper(
 
 void ImGuiWrapper::update()
 {
+  SIMPLE3D_PROFILE_ZONE("ImGuiWrapper::update");
   if (mediator_ == nullptr)
   {
     throw std::logic_error("Mediator should be setup by now");
@@ -269,12 +414,13 @@ void ImGuiWrapper::update()
   std::call_once(sync_flag, sync, *mediator_);
 
   // Start the Dear ImGui frame
-  ImGui_ImplOpenGL3_NewFrame();
   ImGui_ImplGlfw_NewFrame();
   ImGui::NewFrame();
+  mediator_->notify(Event::NewFrame);
   drawSettingsWindow();
   drawErrorPopup(cachedErrorMessage_);
   ImGui::End();
+  checkPick();
 }
 
 void ImGuiWrapper::drawSettingsWindow()
@@ -282,24 +428,85 @@ void ImGuiWrapper::drawSettingsWindow()
   ImGui::Begin("Settings", nullptr);
   auto& mediator = *mediator_;
   drawMainArea();
+  drawFramePacingArea(
+      framePacingControlsCheckboxes_,
+      framePacingReport_,
+      reports_.presentation,
+      mediator);
+  drawProfilingArea(reports_.gpuTimings, reports_.cpuTrace, mediator);
   drawPostprocessesArea(postprocessesCheckboxes_, mediator);
   drawLightingArea(lightControlsSliders_, lightControlsCheckboxes_, mediator);
   if (auto maybeModelFilePath = drawModelArea(
           modelTransformSliders_,
           modelLoadingConfigurationCheckboxes_,
+          reports_.modelLoading,
           mediator);
       maybeModelFilePath.has_value())
   {
     modelFilePath_ = *maybeModelFilePath;
     mediator.notify(Event::LoadModel);
   }
+  drawModelUploadArea(
+      modelUploadControlsSliders_, reports_.modelUpload, mediator);
+  drawRenderingArea(
+      renderingControlsSliders_,
+      renderingControlsCheckboxes_,
+      reports_.rendering,
+      reports_.renderScaleHistory,
+      mediator);
+  drawPickingArea(reports_.picking);
   drawCameraArea(cameraControlsSliders_, mediator);
 }
 
-void ImGuiWrapper::render()
+// Clicks on the GUI windows are left to them
+void ImGuiWrapper::checkPick()
+{
+  const ImGuiIO& io = ImGui::GetIO();
+  if (io.WantCaptureMouse || !ImGui::IsMouseClicked(ImGuiMouseButton_Left) ||
+      io.DisplaySize.x <= 0.f || io.DisplaySize.y <= 0.f)
+  {
+    return;
+  }
+
+  pickPosition_ = ImVec2(
+      io.MousePos.x / io.DisplaySize.x, io.MousePos.y / io.DisplaySize.y);
+  mediator_->notify(Event::Pick);
+}
+
+void ImGuiWrapper::finishFrame(DrawData& drawData)
 {
+  SIMPLE3D_PROFILE_ZONE("ImGuiWrapper::finishFrame");
   ImGui::Render();
-  ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+  drawData.copy(*ImGui::GetDrawData());
+}
+
+void ImGuiWrapper::setReports(const Reports& reports)
+{
+  if (reports.errorsCount != reports_.errorsCount)
+  {
+    printError(reports.lastErrorMessage);
+  }
+  reports_ = reports;
+}
+
+void ImGuiWrapper::DrawData::copy(const ImDrawData& drawData)
+{
+  drawLists_.clear();
+  drawListsPointers_.clear();
+  for (int i = 0; i < drawData.CmdListsCount; ++i)
+  {
+    drawLists_.emplace_back(drawData.CmdLists[i]->CloneOutput());
+    drawListsPointers_.push_back(drawLists_.back().get());
+  }
+  drawData_ = drawData;
+  drawData_.CmdLists = drawListsPointers_.data();
+}
+
+void ImGuiWrapper::DrawData::render() const
+{
+  SIMPLE3D_PROFILE_ZONE("ImGuiWrapper::DrawData::render");
+  // Only reads it, despite the signature
+  ImGui_ImplOpenGL3_RenderDrawData(const_cast<ImDrawData*>(&drawData_));
 }
 
 void ImGuiWrapper::release()
@@ -2,8 +2,11 @@
 #include "simple_3d_viewer/Viewer.hpp"
 #include "simple_3d_viewer/rendering/Model.hpp"
 #include "simple_3d_viewer/utils/constants.hpp"
+#include <algorithm>
 #include <filesystem>
+#include <fmt/format.h>
 #include <functional>
+#include <iterator>
 #include <simple_3d_viewer/Mediator.hpp>
 #include <unordered_map>
 
@@ -15,36 +18,38 @@ namespace
 
 void handlePostprocessesControlsChange(
     const ImGuiWrapper& imGuiWrapper,
-    Viewer& viewer)
+    ViewerControls& viewerControls)
 {
   for (const auto& postprocessCheckbox :
        imGuiWrapper.getPostprocessesCheckboxes())
   {
-    viewer.setPostprocessActiveFlag(
+    viewerControls.setPostprocessActiveFlag(
         postprocessCheckbox.text, postprocessCheckbox.value);
   }
 }
 
 void handleLightingControlsChange(
     const ImGuiWrapper& imGuiWrapper,
-    Viewer& viewer)
+    ViewerControls& viewerControls)
 {
   const auto& sliders = imGuiWrapper.getLightControlsSliders();
   const glm::vec3 lightPosition{ sliders[0].currentValue,
                                  sliders[1].currentValue,
                                  sliders[2].currentValue };
-  viewer.getScene().lightPosition = lightPosition;
+  viewerControls.getSettings().lightPosition = lightPosition;
 }
 
 void handleVisualizeLightPositionCheckboxChange(
     const ImGuiWrapper& imGuiWrapper,
-    Viewer& viewer)
+    ViewerControls& viewerControls)
 {
   const auto& checkboxes = imGuiWrapper.getLightControlsCheckboxes();
-  viewer.getRenderer().drawLight_ = checkboxes[0].value;
+  viewerControls.getSettings().drawLight = checkboxes[0].value;
 }
 
-void handleModelControlsChange(const ImGuiWrapper& imGuiWrapper, Viewer& viewer)
+void handleModelControlsChange(
+    const ImGuiWrapper& imGuiWrapper,
+    ViewerControls& viewerControls)
 {
   const auto& sliders = imGuiWrapper.getModelControlsSliders();
   const glm::vec3 translation(
@@ -59,7 +64,9 @@ void handleModelControlsChange(const ImGuiWrapper& imGuiWrapper, Viewer& viewer)
       sliders[6].currentValue,
       sliders[7].currentValue,
       sliders[8].currentValue);
-  viewer.setModelTransform({ translation, rotation, scale });
+  viewerControls.getSettings().modelTransform = { translation,
+                                                  rotation,
+                                                  scale };
 }
 
 struct StringHash
@@ -79,66 +86,442 @@ const std::unordered_map<
     StringHash,
     std::equal_to<>>
     kStringToModelConfigurationFlag = {
-      { "Flip UVs", Model::Configuration::Flag::FlipUVs }
+      { "Flip UVs", Model::Configuration::Flag::FlipUVs },
+      { "Use model cache", Model::Configuration::Flag::UseModelCache },
+      { "Compact vertex format",
+        Model::Configuration::Flag::CompactVertexFormat },
+      { "Optimize meshes", Model::Configuration::Flag::OptimizeMeshes },
+      { "Generate LODs", Model::Configuration::Flag::GenerateLods },
+      { "Measure serial texture decoding",
+        Model::Configuration::Flag::MeasureSerialTextureDecoding }
     };
 
 void handleModelLoadingConfigurationChange(
     const ImGuiWrapper& imGuiWrapper,
-    Viewer& viewer)
+    ViewerControls& viewerControls)
 {
   const auto& modelLoadingConfigurationCheckboxes =
       imGuiWrapper.getModelLoadingConfigurationCheckboxes();
   for (const auto& checkbox : modelLoadingConfigurationCheckboxes)
   {
-    viewer.getModelConfiguration().set(
+    viewerControls.getSettings().modelConfiguration.set(
         kStringToModelConfigurationFlag.at(checkbox.text), checkbox.value);
   }
 }
 
+void handleModelUploadControlsChange(
+    const ImGuiWrapper& imGuiWrapper,
+    ViewerControls& viewerControls)
+{
+  static constexpr float kBytesInMebibyte = 1024.f * 1024.f;
+  const auto& sliders = imGuiWrapper.getModelUploadControlsSliders();
+  viewerControls.getSettings().modelUploadBudget = {
+    static_cast<size_t>(sliders[0].currentValue * kBytesInMebibyte),
+    ModelUploader::Duration(sliders[1].currentValue)
+  };
+}
+
+void handleRenderingControlsChange(
+    const ImGuiWrapper& imGuiWrapper,
+    ViewerControls& viewerControls)
+{
+  const auto& sliders = imGuiWrapper.getRenderingControlsSliders();
+  const auto& checkboxes = imGuiWrapper.getRenderingControlsCheckboxes();
+  auto& settings = viewerControls.getSettings();
+  settings.maxLodError = sliders[0].currentValue;
+  settings.frustumCulling = checkboxes[0].value;
+  settings.occlusionCulling = checkboxes[1].value;
+  settings.occlusionQueries = checkboxes[2].value;
+  settings.resolutionScaler = {
+    checkboxes[3].value ? ResolutionScaler::Mode::Pinned
+                        : ResolutionScaler::Mode::Automatic,
+    sliders[2].currentValue / 100.f,
+    ResolutionScaler::Duration(sliders[1].currentValue)
+  };
+}
+
 void handleCameraControlsChange(
     const ImGuiWrapper& imGuiWrapper,
-    Viewer& viewer)
+    ViewerControls& viewerControls)
 {
   const auto& sliders = imGuiWrapper.getCameraControlsSliders();
-  viewer.setCameraSettings(
+  viewerControls.setCameraSettings(
       Camera::Settings{ sliders[0].currentValue, sliders[1].currentValue });
 }
 
-void handleLoadModel(const ImGuiWrapper& imGuiWrapper, Viewer& viewer)
+void handleFramePacingControlsChange(
+    const ImGuiWrapper& imGuiWrapper,
+    ViewerControls& viewerControls)
+{
+  const auto onDemand =
+      imGuiWrapper.getFramePacingControlsCheckboxes()[0].value;
+  viewerControls.getRedrawScheduler().onDemand_ = onDemand;
+  viewerControls.getSettings().keepLastFrame = onDemand;
+}
+
+void handleLoadModel(
+    const ImGuiWrapper& imGuiWrapper,
+    ViewerControls& viewerControls)
 {
-  viewer.loadModel(imGuiWrapper.getModelFilePath());
+  viewerControls.loadModel(imGuiWrapper.getModelFilePath());
 }
 
 void handleReloadProgram(
     [[maybe_unused]] const ImGuiWrapper& imGuiWrapper,
-    Viewer& viewer)
+    ViewerControls& viewerControls)
 {
-  viewer.reloadProgram();
+  viewerControls.reloadProgram();
 }
 
-void handleModelLoaded(const ImGuiWrapper& imGuiWrapper, Viewer& viewer)
+ReportLines createModelLoadingReport(const Model::LoadStatistics& statistics)
 {
-  const auto& sliders = imGuiWrapper.getModelControlsSliders();
-  const glm::vec3 translation(
-      sliders[0].currentValue,
-      sliders[1].currentValue,
-      sliders[2].currentValue);
-  const glm::vec3 rotation(
-      sliders[3].currentValue,
-      sliders[4].currentValue,
-      sliders[5].currentValue);
-  const glm::vec3 scale(
-      sliders[6].currentValue,
-      sliders[7].currentValue,
-      sliders[8].currentValue);
-  viewer.setModelTransform({ translation, rotation, scale });
+  const auto decodingTime = statistics.texturesDecodingTime.count();
+  const auto decodingSummedTime =
+      statistics.texturesDecodingSummedTime.count();
+  const auto serialDecodingTime =
+      statistics.texturesSerialDecodingTime.count();
+  ReportLines report{
+    statistics.loadedFromCache
+        ? fmt::format(
+              "Loaded from cache in {:.1f} ms",
+              statistics.loadingTime.count())
+        : fmt::format(
+              "Imported in {:.1f} ms, cache written in {:.1f} ms",
+              statistics.loadingTime.count(),
+              statistics.cacheWritingTime.count()),
+    fmt::format(
+        "Textures: {}, decoded on {} threads",
+        statistics.texturesCount,
+        statistics.texturesDecodingThreadsCount),
+    statistics.texturesSerialDecodingMeasured
+        ? fmt::format(
+              "Texture decoding: {:.1f} ms, serially {:.1f} ms ({:.2f}x)",
+              decodingTime,
+              serialDecodingTime,
+              decodingTime > 0. ? serialDecodingTime / decodingTime : 0.)
+        : fmt::format(
+              "Texture decoding: {:.1f} ms, {:.1f} ms summed over the "
+              "textures",
+              decodingTime,
+              decodingSummedTime),
+    statistics.loadedFromCache
+        ? fmt::format("Meshes: {}", statistics.meshesCount)
+        : fmt::format(
+              "Meshes: {}, converted in {:.1f} ms",
+              statistics.meshesCount,
+              statistics.meshesConversionTime.count())
+  };
+  if (statistics.meshesOptimized)
+  {
+    const auto& before = statistics.vertexCacheBeforeOptimization;
+    const auto& after = statistics.vertexCacheAfterOptimization;
+    report.push_back(fmt::format(
+        "Meshes optimized in {:.1f} ms",
+        statistics.meshesOptimizationTime.count()));
+    report.push_back(fmt::format(
+        "ACMR: {:.3f} -> {:.3f}, ATVR: {:.3f} -> {:.3f}",
+        before.getACMR(),
+        after.getACMR(),
+        before.getATVR(),
+        after.getATVR()));
+  }
+  report.push_back(
+      statistics.lodsGenerated
+          ? fmt::format(
+                "LODs: {}, generated in {:.1f} ms",
+                statistics.lodsCount,
+                statistics.lodsGenerationTime.count())
+          : fmt::format("LODs: {}", statistics.lodsCount));
+  report.push_back(fmt::format(
+      "Meshes BVH: {} nodes, built in {:.1f} ms",
+      statistics.meshesHierarchyNodesCount,
+      statistics.meshesHierarchyBuildTime.count()));
+  return report;
+}
+
+ReportLines createPickingReport(const Viewer& viewer)
+{
+  const auto& modelRaycaster = viewer.getModelRaycaster();
+  if (!modelRaycaster.has_value())
+  {
+    return { "Building the triangle BVHs..." };
+  }
+
+  ReportLines report{ fmt::format(
+      "Triangle BVHs: {} nodes, built in {:.1f} ms",
+      modelRaycaster->getNodesCount(),
+      modelRaycaster->getBuildTime().count()) };
+  const auto& pick = viewer.getLastPick();
+  if (!pick.has_value())
+  {
+    return report;
+  }
+  if (const auto& hit = pick->hit; hit.has_value())
+  {
+    report.push_back(fmt::format(
+        "Mesh {}, triangle {}", hit->meshIndex, hit->triangleIndex));
+    report.push_back(fmt::format(
+        "Position: ({:.3f}, {:.3f}, {:.3f})",
+        hit->position.x,
+        hit->position.y,
+        hit->position.z));
+  }
+  else
+  {
+    report.emplace_back("Nothing hit");
+  }
+  if (pick->distanceFromPreviousHit.has_value())
+  {
+    report.push_back(fmt::format(
+        "Distance from the previous hit: {:.3f}",
+        *pick->distanceFromPreviousHit));
+  }
+  report.push_back(
+      fmt::format("Ray query: {:.1f} us", pick->queryTime.count()));
+  return report;
+}
+
+void handleModelLoaded(ImGuiWrapper::Reports& reports, const Viewer& viewer)
+{
+  if (const auto& model = viewer.getScene().model; model.has_value())
+  {
+    reports.modelLoading = createModelLoadingReport(model->getLoadStatistics());
+  }
+  reports.picking = createPickingReport(viewer);
+}
+
+ReportLines createModelUploadReport(const ModelUploader::Statistics& statistics)
+{
+  static constexpr double kBytesInMebibyte = 1024. * 1024.;
+  const auto uploadedMebibytes =
+      static_cast<double>(statistics.uploadedBytes) / kBytesInMebibyte;
+  const auto uploadTime = statistics.uploadTime.count();
+  return {
+    fmt::format(
+        "Meshes: {}/{}, textures: {}/{}",
+        statistics.uploadedMeshesCount,
+        statistics.meshesCount,
+        statistics.uploadedTexturesCount,
+        statistics.texturesCount),
+    fmt::format(
+        "Uploaded {:.1f}/{:.1f} MiB over {} frames",
+        uploadedMebibytes,
+        static_cast<double>(statistics.totalBytes) / kBytesInMebibyte,
+        statistics.framesCount),
+    fmt::format(
+        "Vertex data: {:.1f} MiB, {:.1f} MiB as full floats",
+        static_cast<double>(statistics.vertexBytes) / kBytesInMebibyte,
+        static_cast<double>(statistics.fullFormatVertexBytes) /
+            kBytesInMebibyte),
+    fmt::format(
+        "Index data: {:.1f} MiB, {:.1f} MiB saved over 32 bit indices",
+        static_cast<double>(statistics.indexBytes) / kBytesInMebibyte,
+        static_cast<double>(
+            statistics.fullWidthIndexBytes - statistics.indexBytes) /
+            kBytesInMebibyte),
+    fmt::format(
+        "Upload time: {:.1f} ms, {:.1f} MiB/s",
+        uploadTime,
+        uploadTime > 0. ? uploadedMebibytes / uploadTime * 1000. : 0.),
+    fmt::format(
+        "Per frame: last {:.2f} ms, max {:.2f} ms",
+        statistics.lastFrameUploadTime.count(),
+        statistics.maxFrameUploadTime.count())
+  };
+}
+
+void handleModelUploadProgress(
+    ImGuiWrapper::Reports& reports,
+    const Viewer& viewer)
+{
+  reports.modelUpload =
+      createModelUploadReport(viewer.getModelUploader().getStatistics());
+}
+
+ReportLines createRenderingReport(const Renderer::Statistics& statistics)
+{
+  const auto fullDetailTrianglesCount = statistics.fullDetailTrianglesCount;
+  return {
+    fmt::format(
+        "Triangles: {} of {} in full detail ({:.1f}%)",
+        statistics.submittedTrianglesCount,
+        fullDetailTrianglesCount,
+        fullDetailTrianglesCount > 0
+            ? 100. * static_cast<double>(statistics.submittedTrianglesCount) /
+                  static_cast<double>(fullDetailTrianglesCount)
+            : 100.),
+    fmt::format(
+        "Culled meshes: {}, draw calls: {}",
+        statistics.culledMeshesCount,
+        statistics.drawCallsCount),
+    fmt::format(
+        "Occluded meshes: {} ({} occluders, {} triangles, {:.2f} ms)",
+        statistics.occludedMeshesCount,
+        statistics.occludersCount,
+        statistics.occluderTrianglesCount,
+        statistics.occlusionCullingTime.count()),
+    fmt::format(
+        "Occlusion queries: {} issued, {} stalls avoided, {} meshes skipped",
+        statistics.occlusionQueries.queriesIssuedCount,
+        statistics.occlusionQueries.stallsAvoidedCount,
+        statistics.occlusionQueries.skippedMeshesCount)
+  };
+}
+
+ReportLines createRenderGraphReport(const RenderGraph::Statistics& statistics)
+{
+  static constexpr double kBytesInMebibyte = 1024. * 1024.;
+  return {
+    fmt::format(
+        "Render graph: {} passes, {} culled, {} clears, {} framebuffer binds",
+        statistics.passesCount,
+        statistics.culledPassesCount,
+        statistics.clearsCount,
+        statistics.framebufferBindsCount),
+    fmt::format(
+        "Render targets: {} in {} textures, {:.1f} MiB ({:.1f} MiB without "
+        "aliasing)",
+        statistics.transientTexturesCount,
+        statistics.physicalTexturesCount,
+        static_cast<double>(statistics.memoryBytes) / kBytesInMebibyte,
+        static_cast<double>(statistics.unaliasedMemoryBytes) /
+            kBytesInMebibyte)
+  };
+}
+
+ReportLines createRenderScaleReport(const Renderer& renderer)
+{
+  const auto& scaler = renderer.resolutionScaler_;
+  const auto framebufferSize = renderer.getFramebufferSize();
+  const auto renderSize = renderer.getRenderSize();
+  return { fmt::format(
+      "Render scale: {:.0f}% ({}), {}x{} of {}x{}, GPU {:.2f} ms of {:.2f} ms",
+      scaler.getScale() * 100.f,
+      scaler.getSettings().mode == ResolutionScaler::Mode::Pinned
+          ? "pinned"
+          : "automatic",
+      renderSize.width,
+      renderSize.height,
+      framebufferSize.width,
+      framebufferSize.height,
+      scaler.getFrameTime().count(),
+      scaler.getSettings().targetFrameTime.count()) };
+}
+
+ReportLines createGpuTimingsReport(const GpuProfiler& profiler)
+{
+  if (!profiler.isSupported())
+  {
+    return { "Timer queries aren't supported" };
+  }
+
+  ReportLines report;
+  GpuProfiler::Duration total{};
+  for (const auto& timings : profiler.getTimings())
+  {
+    report.push_back(fmt::format(
+        "{}: {:.3f} ms (avg {:.3f}, p50 {:.3f}, p95 {:.3f}, p99 {:.3f})",
+        timings.name,
+        timings.last.count(),
+        timings.average.count(),
+        timings.median.count(),
+        timings.percentile95.count(),
+        timings.percentile99.count()));
+    total += timings.average;
+  }
+  report.push_back(fmt::format(
+      "Total of the averages: {:.3f} ms, dropped frames: {}",
+      total.count(),
+      profiler.getDroppedFramesCount()));
+  return report;
+}
+
+void handleFrameRendered(ImGuiWrapper::Reports& reports, const Viewer& viewer)
+{
+  const auto& renderer = viewer.getRenderer();
+  auto renderingReport = createRenderingReport(renderer.getStatistics());
+  std::ranges::move(
+      createRenderGraphReport(renderer.getRenderGraph().getStatistics()),
+      std::back_inserter(renderingReport));
+  std::ranges::move(
+      createRenderScaleReport(renderer),
+      std::back_inserter(renderingReport));
+  reports.rendering = std::move(renderingReport);
+  reports.renderScaleHistory = renderer.resolutionScaler_.getHistory();
+  reports.gpuTimings = createGpuTimingsReport(renderer.getGpuProfiler());
+}
+
+ReportLines createFramePacingReport(const RedrawScheduler& redrawScheduler)
+{
+  const auto& statistics = redrawScheduler.getStatistics();
+  return {
+    fmt::format(
+        "Rendered {:.1f} FPS, presented {:.1f} FPS",
+        statistics.renderedFramesPerSecond,
+        statistics.presentedFramesPerSecond),
+    fmt::format(
+        "Idle {:.1f}% of the time, CPU {:.1f}% of a core",
+        statistics.idleFraction * 100.,
+        statistics.cpuUsage * 100.)
+  };
+}
+
+ReportLines createPresentationReport(
+    const Viewer::PresentationStatistics& statistics)
+{
+  return {
+    fmt::format(
+        "Input to present: {:.1f} ms average, {:.1f} ms max",
+        statistics.averageLatency.count(),
+        statistics.maxLatency.count()),
+    fmt::format(
+        "Render thread frame: {:.2f} ms average, {:.2f} ms deviation",
+        statistics.averageFrameTime.count(),
+        statistics.frameTimeDeviation.count())
+  };
+}
+
+void handleFramePresented(ImGuiWrapper::Reports& reports, const Viewer& viewer)
+{
+  reports.presentation =
+      createPresentationReport(viewer.getPresentationStatistics());
+}
+
+void handlePick(
+    const ImGuiWrapper& imGuiWrapper,
+    ViewerControls& viewerControls)
+{
+  const auto& position = imGuiWrapper.getPickPosition();
+  viewerControls.pick(position.x, position.y);
+}
+
+void handlePickingChange(ImGuiWrapper::Reports& reports, const Viewer& viewer)
+{
+  reports.picking = createPickingReport(viewer);
+}
+
+void handleExportCpuTrace(
+    const ImGuiWrapper& /*imGuiWrapper*/,
+    ViewerControls& viewerControls)
+{
+  viewerControls.exportCpuTrace();
+}
+
+void handleCpuTraceExported(
+    ImGuiWrapper::Reports& reports,
+    const Viewer& viewer)
+{
+  reports.cpuTrace = { fmt::format(
+      "{} zones written to {}",
+      viewer.getCpuTraceZonesCount(),
+      kCpuTracePath().string()) };
 }
 
 using enum ImGuiWrapper::Event;
 
 const std::unordered_map<
     ImGuiWrapper::Event,
-    std::function<void(const ImGuiWrapper&, Viewer&)>>
+    std::function<void(const ImGuiWrapper&, ViewerControls&)>>
     kGUIEventHandlers{
       { ImGuiWrapper::Event::PostprocessesControlsChange,
         handlePostprocessesControlsChange },
@@ -149,29 +532,58 @@ const std::unordered_map<
       { ImGuiWrapper::Event::ModelControlsChange, handleModelControlsChange },
       { ImGuiWrapper::Event::ModelLoadingConfigurationChange,
         handleModelLoadingConfigurationChange },
+      { ImGuiWrapper::Event::ModelUploadControlsChange,
+        handleModelUploadControlsChange },
+      { ImGuiWrapper::Event::RenderingControlsChange,
+        handleRenderingControlsChange },
       { ImGuiWrapper::Event::CameraControlsChange, handleCameraControlsChange },
+      { ImGuiWrapper::Event::FramePacingControlsChange,
+        handleFramePacingControlsChange },
       { ImGuiWrapper::Event::LoadModel, handleLoadModel },
-      { ImGuiWrapper::Event::ReloadProgram, handleReloadProgram }
+      { ImGuiWrapper::Event::ReloadProgram, handleReloadProgram },
+      { ImGuiWrapper::Event::Pick, handlePick },
+      { ImGuiWrapper::Event::ExportCpuTrace, handleExportCpuTrace }
     };
 
 using enum Viewer::Event;
 
 const std::unordered_map<
     Viewer::Event,
-    std::function<void(const ImGuiWrapper&, Viewer&)>>
-    kViewerEventHandlers{ { Viewer::Event::ModelLoaded, handleModelLoaded } };
+    std::function<void(ImGuiWrapper::Reports&, const Viewer&)>>
+    kViewerEventHandlers{
+      { Viewer::Event::ModelLoaded, handleModelLoaded },
+      { Viewer::Event::ModelUploadProgress, handleModelUploadProgress },
+      { Viewer::Event::FrameRendered, handleFrameRendered },
+      { Viewer::Event::FramePresented, handleFramePresented },
+      { Viewer::Event::ModelRaycasterReady, handlePickingChange },
+      { Viewer::Event::ModelPicked, handlePickingChange },
+      { Viewer::Event::CpuTraceExported, handleCpuTraceExported }
+    };
 
 }  // namespace
 
 void Mediator::notify(GUIEvent e)
 {
-  kGUIEventHandlers.at(e)(imGuiWrapper_, viewer_);
+  if (e == GUIEvent::NewFrame)
+  {
+    updateReports();
+    return;
+  }
+
+  kGUIEventHandlers.at(e)(imGuiWrapper_, viewerControls_);
+  // Every control shows up in the scene or its reports
+  viewerControls_.getRedrawScheduler().requestSceneRedraw();
 }
 
 // Viewer event handlers
 void Mediator::notify(ViewerEvent e)
 {
-  kViewerEventHandlers.at(e)(imGuiWrapper_, viewer_);
+  kViewerEventHandlers.at(e)(reports_, viewer_);
+  if (e == ViewerEvent::FramePresented)
+  {
+    publishedReports_->getWriteBuffer() = reports_;
+    publishedReports_->publish();
+  }
 }
 
 // Viewer error handlers
@@ -179,12 +591,27 @@ void Mediator::notify(ViewerError e, const std::string& errorMessage)
 {
   switch (e)
   {
-    case ViewerError::ReloadProgram:
-      imGuiWrapper_.printError(errorMessage);
-      break;
-    case ViewerError::LoadModel: imGuiWrapper_.printError(errorMessage); break;
+    case ViewerError::ReloadProgram: reportError(errorMessage); break;
+    case ViewerError::LoadModel: reportError(errorMessage); break;
+    case ViewerError::ExportCpuTrace: reportError(errorMessage); break;
     default: assert(false);
   }
 }
 
+void Mediator::reportError(const std::string& errorMessage)
+{
+  reports_.lastErrorMessage = errorMessage;
+  ++reports_.errorsCount;
+}
+
+void Mediator::updateReports()
+{
+  if (publishedReports_->acquire())
+  {
+    imGuiWrapper_.setReports(publishedReports_->getReadBuffer());
+  }
+  imGuiWrapper_.setFramePacingReport(
+      createFramePacingReport(viewerControls_.getRedrawScheduler()));
+}
+
 }  // namespace Simple3D
@@ -0,0 +1,50 @@
+#include <simple_3d_viewer/RenderThread.hpp>
+#include <simple_3d_viewer/utils/Profiler.hpp>
+
+namespace Simple3D
+{
+
+RenderThread::RenderThread(GLFWwindow* window, Viewer& viewer)
+    : window_(window),
+      viewer_(viewer)
+{
+  // A context can only be current on one thread at a time
+  glfwMakeContextCurrent(nullptr);
+  thread_ = std::thread([this]() { run(); });
+}
+
+void RenderThread::stop()
+{
+  if (!thread_.joinable())
+  {
+    return;
+  }
+
+  stopRequested_.store(true, std::memory_order_relaxed);
+  // Wakes the render thread up, the snapshot isn't rendered
+  snapshots_.publish();
+  thread_.join();
+  glfwMakeContextCurrent(window_);
+}
+
+void RenderThread::run()
+{
+  SIMPLE3D_PROFILE_THREAD("Render");
+  glfwMakeContextCurrent(window_);
+  glfwSwapInterval(1);
+
+  while (true)
+  {
+    snapshots_.waitForPublish();
+    if (stopRequested_.load(std::memory_order_relaxed))
+    {
+      break;
+    }
+    snapshots_.acquire();
+    viewer_.render(snapshots_.getReadBuffer());
+  }
+
+  glfwMakeContextCurrent(nullptr);
+}
+
+}  // namespace Simple3D
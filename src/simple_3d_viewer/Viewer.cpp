@@ -1,22 +1,30 @@
 #include "simple_3d_viewer/rendering/Model.hpp"
 #include "simple_3d_viewer/utils/constants.hpp"
 #include "simple_3d_viewer/utils/factories.hpp"
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cmath>
 #include <future>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
 #include <iterator>
 #include <optional>
 #include <simple_3d_viewer/Viewer.hpp>
 #include <simple_3d_viewer/utils/Size.hpp>
 #include <simple_3d_viewer/utils/glfwUtils.hpp>
 #include <stdexcept>
+#include <utility>
 
 namespace Simple3D
 {
 
 Viewer::Viewer(
     GLFWwindow* window,
-    const std::vector<std::string>& postprocessIDs)
+    const std::vector<std::string>& postprocessIDs,
+    RedrawScheduler& redrawScheduler)
     : window_(window),
+      redrawScheduler_(redrawScheduler),
       scene_(getFramebufferSize(window)),
       renderer_(postprocessIDs, getFramebufferSize(window))
 {
@@ -28,47 +36,290 @@ Viewer::Viewer(
 namespace
 {
 
-std::optional<Model> checkModelFuture(std::future<Model>& modelFuture)
+template<typename T>
+std::optional<T> checkFuture(std::future<T>& future)
 {
   if (constexpr std::chrono::milliseconds amountToWait(0);
-      modelFuture.valid() &&
-      (modelFuture.wait_for(amountToWait) != std::future_status::timeout))
+      future.valid() &&
+      (future.wait_for(amountToWait) != std::future_status::timeout))
   {
-    return modelFuture.get();
+    return future.get();
   }
 
   return std::nullopt;
 }
 
+template<typename Duration, size_t size>
+std::pair<Duration, Duration> calculateAverageAndDeviation(
+    const std::array<Duration, size>& durations,
+    size_t count)
+{
+  Duration sum{};
+  for (size_t i = 0; i < count; ++i)
+  {
+    sum += durations[i];
+  }
+  const auto average = sum / static_cast<double>(count);
+
+  double squaredDeviationsSum = 0.;
+  for (size_t i = 0; i < count; ++i)
+  {
+    const auto deviation = (durations[i] - average).count();
+    squaredDeviationsSum += deviation * deviation;
+  }
+  return { average,
+           Duration(
+               std::sqrt(squaredDeviationsSum / static_cast<double>(count))) };
+}
+
 }  // namespace
 
-void Viewer::render(const Size framebufferSize)
+void Viewer::render(const FrameSnapshot& snapshot)
 {
+  SIMPLE3D_PROFILE_ZONE("Viewer::render");
   if (mediator_ == nullptr)
   {
     throw std::logic_error("Mediator should be setup by now");
   }
 
-  if (auto maybeModel = checkModelFuture(modelFuture_); maybeModel.has_value())
+  const auto frameStart = Clock::now();
+  // A model loaded meanwhile gets its transform before it's rendered, and a
+  // pick sees the camera of this frame
+  update(snapshot.settings.modelUploadBudget);
+  applySettings(snapshot);
+  carryOutRequests(snapshot);
+
+  const auto framebufferSize = snapshot.framebufferSize;
+  if (framebufferSize.width <= 0 || framebufferSize.height <= 0)
+  {
+    return;
+  }
+
+  if (snapshot.redraw != RedrawScheduler::Redraw::Gui ||
+      !renderer_.presentLastFrame(framebufferSize))
   {
-    try
-    {
-      maybeModel->complete();
-      scene_.model = std::move(maybeModel);
-      mediator_->notify(Event::ModelLoaded);
-    }
-    catch (std::invalid_argument& e)
-    {
-      mediator_->notify(Error::LoadModel, e.what());
-    }
+    renderer_.render(scene_, framebufferSize);
+    mediator_->notify(Event::FrameRendered);
   }
+  snapshot.gui.render();
+  {
+    SIMPLE3D_PROFILE_ZONE("glfwSwapBuffers");
+    glfwSwapBuffers(window_);
+  }
+  recordPresentation(snapshot.inputTime, frameStart);
+  mediator_->notify(Event::FramePresented);
+}
 
-  if (framebufferSize.width <= 0 || framebufferSize.height <= 0)
+void Viewer::update(const ModelUploader::Budget& modelUploadBudget)
+{
+  if (auto maybeModel = checkFuture(modelFuture_); maybeModel.has_value())
+  {
+    // The model is put into the scene right away, its meshes show up as they
+    // get uploaded
+    modelUploader_.start(*maybeModel);
+    scene_.model = std::move(maybeModel);
+    modelRaycasterFuture_ = std::async(
+        std::launch::async,
+        [&model = *scene_.model, &redrawScheduler = redrawScheduler_]()
+        {
+          SIMPLE3D_PROFILE_THREAD("Model raycaster");
+          auto modelRaycaster = ModelRaycaster(model);
+          redrawScheduler.requestGuiRedraw();
+          glfwPostEmptyEvent();
+          return modelRaycaster;
+        });
+    requestSceneRedraw();
+    mediator_->notify(Event::ModelLoaded);
+  }
+  if (auto maybeModelRaycaster = checkFuture(modelRaycasterFuture_);
+      maybeModelRaycaster.has_value())
+  {
+    modelRaycaster_ = std::move(maybeModelRaycaster);
+    mediator_->notify(Event::ModelRaycasterReady);
+  }
+  uploadModel(modelUploadBudget);
+}
+
+void Viewer::applySettings(const FrameSnapshot& snapshot)
+{
+  const auto& settings = snapshot.settings;
+  for (const auto& [ID, active] : settings.postprocesses)
+  {
+    renderer_.postprocessPipeline_.setPostprocessActiveFlag(ID, active);
+  }
+  renderer_.drawLight_ = settings.drawLight;
+  renderer_.frustumCulling_ = settings.frustumCulling;
+  renderer_.occlusionCulling_ = settings.occlusionCulling;
+  renderer_.occlusionQueries_ = settings.occlusionQueries;
+  renderer_.maxLodError_ = settings.maxLodError;
+  renderer_.keepLastFrame_ = settings.keepLastFrame;
+  // Changing them restarts the measurements
+  if (renderer_.resolutionScaler_.getSettings() != settings.resolutionScaler)
+  {
+    renderer_.resolutionScaler_.setSettings(settings.resolutionScaler);
+  }
+
+  scene_.lightPosition = settings.lightPosition;
+  if (scene_.model)
+  {
+    scene_.model->setTransform(settings.modelTransform);
+  }
+  scene_.camera.lookAt(
+      snapshot.cameraPosition,
+      snapshot.cameraPosition + snapshot.cameraOrientation);
+}
+
+void Viewer::carryOutRequests(const FrameSnapshot& snapshot)
+{
+  const auto& requests = snapshot.requests;
+  if (requests.loadModelCount != handledRequests_.loadModelCount)
+  {
+    handledRequests_.loadModelCount = requests.loadModelCount;
+    loadModel(requests.modelPath, snapshot.settings.modelConfiguration);
+  }
+  if (requests.reloadProgramCount != handledRequests_.reloadProgramCount)
+  {
+    handledRequests_.reloadProgramCount = requests.reloadProgramCount;
+    reloadProgram();
+  }
+  if (requests.pickCount != handledRequests_.pickCount)
+  {
+    handledRequests_.pickCount = requests.pickCount;
+    pick(requests.pickPosition, snapshot.framebufferSize);
+  }
+  if (requests.exportCpuTraceCount != handledRequests_.exportCpuTraceCount)
+  {
+    handledRequests_.exportCpuTraceCount = requests.exportCpuTraceCount;
+    exportCpuTrace();
+  }
+}
+
+void Viewer::loadModel(
+    const std::filesystem::path& pathToModel,
+    const Model::Configuration& modelConfig)
+{
+  resetModel();
+  modelFuture_ = std::async(
+      std::launch::async,
+      [pathToModel, modelConfig, &redrawScheduler = redrawScheduler_]()
+      {
+        SIMPLE3D_PROFILE_THREAD("Model loader");
+        auto model = Model(pathToModel, modelConfig);
+        redrawScheduler.requestSceneRedraw();
+        glfwPostEmptyEvent();
+        return model;
+      });
+}
+
+void Viewer::uploadModel(const ModelUploader::Budget& modelUploadBudget)
+{
+  if (!scene_.model || modelUploader_.isFinished())
+  {
+    return;
+  }
+
+  try
+  {
+    modelUploader_.upload(*scene_.model, modelUploadBudget);
+    requestSceneRedraw();
+    mediator_->notify(Event::ModelUploadProgress);
+  }
+  catch (std::invalid_argument& e)
+  {
+    resetModel();
+    mediator_->notify(Error::LoadModel, e.what());
+  }
+}
+
+void Viewer::resetModel()
+{
+  // The raycaster refers to the model, also while it's being built
+  if (modelRaycasterFuture_.valid())
+  {
+    modelRaycasterFuture_.wait();
+    modelRaycasterFuture_ = {};
+  }
+  modelRaycaster_.reset();
+  lastPick_.reset();
+  scene_.model.reset();
+}
+
+void Viewer::pick(const glm::vec2& position, const Size framebufferSize)
+{
+  if (!modelRaycaster_.has_value())
   {
     return;
   }
 
-  renderer_.render(scene_, framebufferSize);
+  // The ray goes from the near plane to the far plane, so the distances
+  // along it are fractions of the depth range
+  const auto inverseProjectionView =
+      glm::inverse(calculateProjectionTransform(framebufferSize) *
+                   scene_.camera.getViewTransform());
+  const auto unproject = [&inverseProjectionView, &position](float depth)
+  {
+    const auto point =
+        inverseProjectionView *
+        glm::vec4(2.f * position.x - 1.f, 1.f - 2.f * position.y, depth, 1.f);
+    return glm::vec3(point) / point.w;
+  };
+  const auto nearPoint = unproject(-1.f);
+  const Ray ray{ nearPoint, unproject(1.f) - nearPoint };
+
+  const auto queryStart = Clock::now();
+  Pick pick{ modelRaycaster_->intersectClosest(ray, 1.f), std::nullopt, {} };
+  pick.queryTime = Clock::now() - queryStart;
+  if (lastPick_.has_value() && lastPick_->hit.has_value() &&
+      pick.hit.has_value())
+  {
+    pick.distanceFromPreviousHit =
+        glm::length(pick.hit->position - lastPick_->hit->position);
+  }
+  lastPick_ = pick;
+  mediator_->notify(Event::ModelPicked);
+}
+
+void Viewer::requestSceneRedraw()
+{
+  redrawScheduler_.requestSceneRedraw();
+  glfwPostEmptyEvent();
+}
+
+void Viewer::recordPresentation(
+    const Clock::time_point inputTime,
+    const Clock::time_point frameStart)
+{
+  const auto presentTime = Clock::now();
+  const auto index = presentedFramesCount_ % kPresentationHistorySize;
+  latencies_[index] = presentTime - inputTime;
+  frameTimes_[index] = presentTime - frameStart;
+  ++presentedFramesCount_;
+
+  const auto count =
+      std::min(presentedFramesCount_, kPresentationHistorySize);
+  const auto [averageLatency, latencyDeviation] =
+      calculateAverageAndDeviation(latencies_, count);
+  const auto [averageFrameTime, frameTimeDeviation] =
+      calculateAverageAndDeviation(frameTimes_, count);
+  presentationStatistics_ = {
+    averageLatency,
+    *std::max_element(latencies_.begin(), latencies_.begin() + count),
+    averageFrameTime,
+    frameTimeDeviation
+  };
+}
+
+void Viewer::exportCpuTrace()
+{
+  try
+  {
+    cpuTraceZonesCount_ = Profiler::exportChromeTrace(kCpuTracePath());
+    mediator_->notify(Event::CpuTraceExported);
+  }
+  catch (std::invalid_argument& e)
+  {
+    mediator_->notify(Error::ExportCpuTrace, e.what());
+  }
 }
 
 void Viewer::reloadProgram()
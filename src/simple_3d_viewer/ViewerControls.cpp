@@ -0,0 +1,46 @@
+#include <algorithm>
+#include <simple_3d_viewer/ViewerControls.hpp>
+#include <simple_3d_viewer/utils/glfwUtils.hpp>
+
+namespace Simple3D
+{
+
+ViewerControls::ViewerControls(GLFWwindow* window)
+    : window_(window),
+      camera_(getFramebufferSize(window))
+{
+  redrawScheduler_.watch(window);
+}
+
+void ViewerControls::writeSnapshot(
+    FrameSnapshot& snapshot,
+    const Size framebufferSize,
+    const FrameSnapshot::Clock::time_point inputTime)
+{
+  snapshot.settings = settings_;
+  snapshot.requests = requests_;
+  snapshot.cameraPosition = camera_.getPosition();
+  snapshot.cameraOrientation = camera_.getOrientation();
+  snapshot.framebufferSize = framebufferSize;
+  snapshot.redraw = redrawScheduler_.getRedraw();
+  snapshot.inputTime = inputTime;
+  redrawScheduler_.startFrame(snapshot.redraw);
+}
+
+void ViewerControls::setPostprocessActiveFlag(
+    const PostprocessID& ID,
+    bool active)
+{
+  auto& postprocesses = settings_.postprocesses;
+  if (const auto postprocess = std::ranges::find_if(
+          postprocesses,
+          [&ID](const auto& entry) { return entry.first == ID; });
+      postprocess != postprocesses.end())
+  {
+    postprocess->second = active;
+    return;
+  }
+  postprocesses.emplace_back(ID, active);
+}
+
+}  // namespace Simple3D
@@ -0,0 +1,414 @@
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <numeric>
+#include <optional>
+#include <simple_3d_viewer/opengl_object_wrappers/Framebuffer.hpp>
+#include <simple_3d_viewer/rendering/CameraPath.hpp>
+#include <simple_3d_viewer/rendering/Renderer.hpp>
+#include <simple_3d_viewer/rendering/Scene.hpp>
+#include <simple_3d_viewer/utils/HeadlessContext.hpp>
+#include <simple_3d_viewer/utils/Profiler.hpp>
+#include <simple_3d_viewer/utils/jsonEscaping.hpp>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Renders a model offscreen along a camera path as fast as possible and
+// prints the frame time statistics as JSON. Needs no display server, the
+// context comes from EGL without any surface, which Mesa's llvmpipe provides
+// too.
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+using Duration = std::chrono::duration<double, std::milli>;
+
+constexpr std::string_view kUsage =
+    "Usage: Simple3DViewer_benchmark <model path> [options]\n"
+    "  --frames <count>          measured frames, 600 by default\n"
+    "  --warmup <count>          frames rendered before measuring, 60 by "
+    "default\n"
+    "  --size <width> <height>   of the framebuffer, 1280 720 by default\n"
+    "  --camera-path <path>      keyframes to follow instead of an orbit\n"
+    "  --postprocess <ID>        FXAA, inversion or grayscale, repeatable\n"
+    "  --max-lod-error <pixels>  1 by default\n"
+    "  --render-scale <fraction> pinned, from 0.5 to 1, 1 by default\n"
+    "  --target-gpu-ms <ms>      scales automatically towards it instead\n"
+    "  --no-frustum-culling\n"
+    "  --occlusion-culling\n"
+    "  --occlusion-queries\n"
+    "  --no-optimize-meshes, --no-generate-lods, --compact-vertex-format,\n"
+    "  --flip-uvs, --use-model-cache   model loading flags\n"
+    "  --output <path>           writes the JSON there instead of stdout\n";
+
+struct Options
+{
+  std::filesystem::path modelFilePath;
+  size_t framesCount{ 600 };
+  size_t warmupFramesCount{ 60 };
+  Simple3D::Size framebufferSize{ 1280, 720 };
+  std::optional<std::filesystem::path> cameraPathFilePath;
+  std::vector<std::string> postprocesses;
+  float maxLodError{ 1.f };
+  // Pinned to the full size unless a target frame time is given
+  Simple3D::ResolutionScaler::Settings resolutionScaling{
+    Simple3D::ResolutionScaler::Mode::Pinned,
+    1.f,
+    {}
+  };
+  bool frustumCulling{ true };
+  bool occlusionCulling{ false };
+  bool occlusionQueries{ false };
+  Simple3D::Model::Configuration modelConfiguration;
+  std::optional<std::filesystem::path> outputFilePath;
+};
+
+Options parseOptions(int argc, char** argv)
+{
+  const std::vector<std::string_view> arguments(argv + 1, argv + argc);
+  Options options;
+  size_t i = 0;
+  const auto next = [&arguments, &i]()
+  {
+    if (i + 1 >= arguments.size())
+    {
+      throw std::invalid_argument(
+          fmt::format("{} is missing its value", arguments[i]));
+    }
+    return std::string(arguments[++i]);
+  };
+
+  using Flag = Simple3D::Model::Configuration::Flag;
+  for (; i < arguments.size(); ++i)
+  {
+    const auto argument = arguments[i];
+    if (argument == "--frames")
+    {
+      options.framesCount = std::stoul(next());
+    }
+    else if (argument == "--warmup")
+    {
+      options.warmupFramesCount = std::stoul(next());
+    }
+    else if (argument == "--size")
+    {
+      options.framebufferSize.width = std::stoi(next());
+      options.framebufferSize.height = std::stoi(next());
+    }
+    else if (argument == "--camera-path")
+    {
+      options.cameraPathFilePath = next();
+    }
+    else if (argument == "--postprocess")
+    {
+      options.postprocesses.push_back(next());
+    }
+    else if (argument == "--max-lod-error")
+    {
+      options.maxLodError = std::stof(next());
+    }
+    else if (argument == "--render-scale")
+    {
+      options.resolutionScaling.mode =
+          Simple3D::ResolutionScaler::Mode::Pinned;
+      options.resolutionScaling.pinnedScale = std::stof(next());
+    }
+    else if (argument == "--target-gpu-ms")
+    {
+      options.resolutionScaling.mode =
+          Simple3D::ResolutionScaler::Mode::Automatic;
+      options.resolutionScaling.targetFrameTime =
+          Simple3D::ResolutionScaler::Duration(std::stod(next()));
+    }
+    else if (argument == "--no-frustum-culling")
+    {
+      options.frustumCulling = false;
+    }
+    else if (argument == "--occlusion-culling")
+    {
+      options.occlusionCulling = true;
+    }
+    else if (argument == "--occlusion-queries")
+    {
+      options.occlusionQueries = true;
+    }
+    else if (argument == "--no-optimize-meshes")
+    {
+      options.modelConfiguration.set(Flag::OptimizeMeshes, false);
+    }
+    else if (argument == "--no-generate-lods")
+    {
+      options.modelConfiguration.set(Flag::GenerateLods, false);
+    }
+    else if (argument == "--compact-vertex-format")
+    {
+      options.modelConfiguration.set(Flag::CompactVertexFormat, true);
+    }
+    else if (argument == "--flip-uvs")
+    {
+      options.modelConfiguration.set(Flag::FlipUVs, true);
+    }
+    else if (argument == "--use-model-cache")
+    {
+      options.modelConfiguration.set(Flag::UseModelCache, true);
+    }
+    else if (argument == "--output")
+    {
+      options.outputFilePath = next();
+    }
+    else if (options.modelFilePath.empty() && !argument.starts_with("--"))
+    {
+      options.modelFilePath = argument;
+    }
+    else
+    {
+      throw std::invalid_argument(
+          fmt::format("Unknown argument {}", argument));
+    }
+  }
+
+  if (options.modelFilePath.empty())
+  {
+    throw std::invalid_argument("Model path is missing");
+  }
+  if (options.framesCount == 0 || options.framebufferSize.width <= 0 ||
+      options.framebufferSize.height <= 0)
+  {
+    throw std::invalid_argument("Frames count and size have to be positive");
+  }
+  return options;
+}
+
+Simple3D::AxisAlignedBox calculateModelBox(const Simple3D::Model& model)
+{
+  auto box = Simple3D::AxisAlignedBox::createEmpty();
+  for (const auto& mesh : model.meshes_)
+  {
+    box.expand(mesh.boundingBox_);
+  }
+  return box;
+}
+
+// Nearest rank of the sorted frame times
+double getPercentile(const std::vector<double>& sortedTimes, double percentile)
+{
+  const auto rank = static_cast<size_t>(
+      std::ceil(percentile * static_cast<double>(sortedTimes.size())));
+  return sortedTimes[std::max<size_t>(rank, 1) - 1];
+}
+
+// The first measured frame and every one where the controller changed the
+// scale, as [frame, scale] pairs
+std::string createRenderScaleChanges(const std::vector<float>& renderScales)
+{
+  std::string changes;
+  for (size_t i = 0; i < renderScales.size(); ++i)
+  {
+    if (i == 0 || renderScales[i] != renderScales[i - 1])
+    {
+      changes += fmt::format(
+          "{}[{}, {:.2f}]", changes.empty() ? "" : ", ", i, renderScales[i]);
+    }
+  }
+  return changes;
+}
+
+std::string createReport(
+    const Options& options,
+    std::vector<double> frameTimes,
+    const std::vector<float>& renderScales,
+    const Simple3D::Renderer& renderer)
+{
+  std::ranges::sort(frameTimes);
+  const auto mean = std::accumulate(frameTimes.begin(), frameTimes.end(), 0.) /
+                    static_cast<double>(frameTimes.size());
+
+  std::string gpuPasses;
+  for (const auto& timings : renderer.getGpuProfiler().getTimings())
+  {
+    gpuPasses += fmt::format(
+        R"({}{{"name":"{}","meanMs":{:.4f},"p95Ms":{:.4f}}})",
+        gpuPasses.empty() ? "" : ",",
+        timings.name,
+        timings.average.count(),
+        timings.percentile95.count());
+  }
+
+  const auto* glRenderer =
+      reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+  const auto& statistics = renderer.getStatistics();
+  const auto& graphStatistics = renderer.getRenderGraph().getStatistics();
+  const auto meanRenderScale =
+      std::accumulate(renderScales.begin(), renderScales.end(), 0.) /
+      static_cast<double>(renderScales.size());
+  return fmt::format(
+      "{{\n"
+      R"(  "model": "{}",)"
+      "\n"
+      R"(  "renderer": "{}",)"
+      "\n"
+      R"(  "width": {}, "height": {}, "frames": {},)"
+      "\n"
+      R"(  "frameTimeMs": {{"mean": {:.4f}, "p50": {:.4f}, "p95": {:.4f}, )"
+      R"("p99": {:.4f}, "max": {:.4f}, "min": {:.4f}}},)"
+      "\n"
+      R"(  "framesPerSecond": {:.2f},)"
+      "\n"
+      R"(  "lastFrame": {{"submittedTriangles": {}, "culledMeshes": {}, )"
+      R"("drawCalls": {}}},)"
+      "\n"
+      R"(  "renderGraph": {{"passes": {}, "culledPasses": {}, )"
+      R"("physicalTextures": {}, "memoryBytes": {}, )"
+      R"("unaliasedMemoryBytes": {}}},)"
+      "\n"
+      R"(  "renderScale": {{"mode": "{}", "mean": {:.3f}, )"
+      R"("changes": [{}]}},)"
+      "\n"
+      R"(  "gpuPasses": [{}])"
+      "\n}}\n",
+      Simple3D::escapeJson(options.modelFilePath.generic_string()),
+      Simple3D::escapeJson(glRenderer != nullptr ? glRenderer : "unknown"),
+      options.framebufferSize.width,
+      options.framebufferSize.height,
+      frameTimes.size(),
+      mean,
+      getPercentile(frameTimes, 0.5),
+      getPercentile(frameTimes, 0.95),
+      getPercentile(frameTimes, 0.99),
+      frameTimes.back(),
+      frameTimes.front(),
+      1000. / mean,
+      statistics.submittedTrianglesCount,
+      statistics.culledMeshesCount,
+      statistics.drawCallsCount,
+      graphStatistics.passesCount,
+      graphStatistics.culledPassesCount,
+      graphStatistics.physicalTexturesCount,
+      graphStatistics.memoryBytes,
+      graphStatistics.unaliasedMemoryBytes,
+      options.resolutionScaling.mode ==
+              Simple3D::ResolutionScaler::Mode::Pinned
+          ? "pinned"
+          : "automatic",
+      meanRenderScale,
+      createRenderScaleChanges(renderScales),
+      gpuPasses);
+}
+
+int runBenchmark(const Options& options)
+{
+  const Simple3D::HeadlessContext context;
+  // Stands in for the default framebuffer, which a surfaceless context
+  // doesn't have
+  const Simple3D::Framebuffer framebuffer(options.framebufferSize);
+
+  Simple3D::Scene scene(options.framebufferSize);
+  scene.skyboxProgram.doOperations([](Simple3D::Program& program)
+                                   { program.setInt("skybox", 0); });
+  scene.model.emplace(options.modelFilePath, options.modelConfiguration);
+  // Everything is uploaded before measuring, unlike in the viewer
+  scene.model->complete();
+
+  const std::vector<Simple3D::PostprocessID> postprocessIDs{ "FXAA",
+                                                             "inversion",
+                                                             "grayscale" };
+  Simple3D::Renderer renderer(postprocessIDs, options.framebufferSize);
+  renderer.setOutputFramebuffer(framebuffer.get());
+  for (const auto& postprocess : options.postprocesses)
+  {
+    renderer.postprocessPipeline_.setPostprocessActiveFlag(postprocess, true);
+  }
+  renderer.maxLodError_ = options.maxLodError;
+  renderer.frustumCulling_ = options.frustumCulling;
+  renderer.occlusionCulling_ = options.occlusionCulling;
+  renderer.occlusionQueries_ = options.occlusionQueries;
+  renderer.resolutionScaler_.setSettings(options.resolutionScaling);
+
+  const auto cameraPath =
+      options.cameraPathFilePath.has_value()
+          ? Simple3D::CameraPath::load(*options.cameraPathFilePath)
+          : Simple3D::CameraPath::createOrbit(
+                calculateModelBox(*scene.model), options.framesCount);
+  const auto renderFrame = [&](size_t frame, size_t framesCount)
+  {
+    SIMPLE3D_PROFILE_ZONE("Frame");
+    const auto [position, target] =
+        cameraPath.sample(framesCount > 1 ? static_cast<float>(frame) /
+                                                static_cast<float>(
+                                                    framesCount - 1)
+                                          : 0.f);
+    scene.camera.lookAt(position, target);
+    scene.lightPosition = position;
+    renderer.render(scene, options.framebufferSize);
+    // Nothing is presented, waiting for the GPU is what ends a frame
+    glFinish();
+  };
+
+  for (size_t i = 0; i < options.warmupFramesCount; ++i)
+  {
+    renderFrame(i, options.warmupFramesCount);
+  }
+  std::vector<double> frameTimes;
+  frameTimes.reserve(options.framesCount);
+  std::vector<float> renderScales;
+  renderScales.reserve(options.framesCount);
+  for (size_t i = 0; i < options.framesCount; ++i)
+  {
+    const auto frameStart = Clock::now();
+    renderFrame(i, options.framesCount);
+    frameTimes.push_back(Duration(Clock::now() - frameStart).count());
+    renderScales.push_back(renderer.resolutionScaler_.getScale());
+  }
+
+  const auto report =
+      createReport(options, std::move(frameTimes), renderScales, renderer);
+  if (!options.outputFilePath.has_value())
+  {
+    fmt::print("{}", report);
+    return 0;
+  }
+  std::ofstream out(*options.outputFilePath);
+  if (!out.is_open())
+  {
+    throw std::runtime_error(fmt::format(
+        "Couldn't open {} for writing", options.outputFilePath->string()));
+  }
+  out << report;
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  SIMPLE3D_PROFILE_THREAD("Main");
+  Options options;
+  try
+  {
+    options = parseOptions(argc, argv);
+  }
+  catch (std::exception& e)
+  {
+    fmt::println(stderr, "{}\n{}", e.what(), kUsage);
+    return 1;
+  }
+
+  try
+  {
+    return runBenchmark(options);
+  }
+  catch (std::exception& e)
+  {
+    fmt::println(stderr, "{}", e.what());
+    return 1;
+  }
+}
@@ -1,3 +1,4 @@
+#include <cmath>
 #include <glm/gtx/rotate_vector.hpp>
 #include <simple_3d_viewer/linear_algebra/Transform.hpp>
 
@@ -24,9 +25,15 @@ glm::mat4x4 calculateModelTransform(const Transform& transform)
   return translateMat * rotateZMat * rotateYMat * rotateXMat * scaleMat;
 }
 
+namespace
+{
+
+constexpr auto fovDeg = 45.0f;
+
+}  // namespace
+
 glm::mat4x4 calculateProjectionTransform(Size size)
 {
-  static constexpr auto fovDeg = 45.0f;
   static constexpr auto nearPlane = 0.1f;
   static constexpr auto farPlane = 100.0f;
   return glm::perspective(
@@ -35,4 +42,10 @@ glm::mat4x4 calculateProjectionTransform(Size size)
       nearPlane,
       farPlane);
 }
+
+float calculateProjectionScale(Size size)
+{
+  return static_cast<float>(size.height) /
+         (2.f * std::tan(glm::radians(fovDeg) * 0.5f));
+}
 }  // namespace Simple3D
@@ -0,0 +1,489 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <simple_3d_viewer/linear_algebra/boundingVolumeHierarchy.hpp>
+#include <simple_3d_viewer/utils/ThreadPool.hpp>
+
+namespace Simple3D
+{
+
+namespace
+{
+
+using Node = BoundingVolumeHierarchy::Node;
+
+constexpr size_t kBinsCount = 16;
+// Cost of visiting an inner node relative to testing a primitive
+constexpr float kTraversalCost = 2.f;
+// Ranges smaller than this are built on a single thread
+constexpr uint32_t kMinParallelPrimitivesCount = 256;
+// Subtrees per thread of the pool, more than one so threads which got small
+// subtrees can pick up more work
+constexpr size_t kSubtreesPerThread = 4;
+
+struct BuildTask
+{
+  uint32_t nodeIndex;
+  uint32_t begin;
+  uint32_t end;
+};
+
+struct Bin
+{
+  AxisAlignedBox box = AxisAlignedBox::createEmpty();
+  uint32_t count{};
+};
+
+class Builder
+{
+ public:
+  Builder(
+      std::span<const AxisAlignedBox> boxes,
+      std::span<uint32_t> primitiveIndices)
+      : boxes_(boxes),
+        primitiveIndices_(primitiveIndices)
+  {
+    centroids_.reserve(boxes.size());
+    for (const auto& box : boxes)
+    {
+      centroids_.push_back(box.getCenter());
+    }
+  }
+
+  // Makes the node of the task a leaf, or an inner node with two children
+  // appended to nodes and their tasks appended to children. Only reorders the
+  // primitive indices within the range of the task, so disjoint tasks can be
+  // split concurrently into different node arrays.
+  void split(
+      std::vector<Node>& nodes,
+      const BuildTask& task,
+      std::vector<BuildTask>& children) const
+  {
+    auto box = AxisAlignedBox::createEmpty();
+    auto centroidsBox = AxisAlignedBox::createEmpty();
+    for (auto i = task.begin; i < task.end; ++i)
+    {
+      const auto primitive = primitiveIndices_[i];
+      box.expand(boxes_[primitive]);
+      centroidsBox.expand(centroids_[primitive]);
+    }
+    const auto count = task.end - task.begin;
+    nodes[task.nodeIndex] = { box, task.begin, count };
+    if (count <= 1)
+    {
+      return;
+    }
+
+    const auto middle = findSplit(box, centroidsBox, task);
+    if (!middle.has_value())
+    {
+      return;
+    }
+
+    const auto firstChild = static_cast<uint32_t>(nodes.size());
+    nodes.resize(nodes.size() + 2);
+    nodes[task.nodeIndex].firstChildOrPrimitive = firstChild;
+    nodes[task.nodeIndex].primitivesCount = 0;
+    children.push_back({ firstChild, task.begin, *middle });
+    children.push_back({ firstChild + 1, *middle, task.end });
+  }
+
+  void buildSubtree(std::vector<Node>& nodes, const BuildTask& root) const
+  {
+    std::vector<BuildTask> tasks{ root };
+    while (!tasks.empty())
+    {
+      const auto task = tasks.back();
+      tasks.pop_back();
+      split(nodes, task, tasks);
+    }
+  }
+
+ private:
+  std::span<const AxisAlignedBox> boxes_;
+  std::span<uint32_t> primitiveIndices_;
+  std::vector<glm::vec3> centroids_;
+
+  // Partitions the range of the task along the best split and returns where
+  // the second part starts, std::nullopt when keeping a leaf is cheaper
+  [[nodiscard]] std::optional<uint32_t> findSplit(
+      const AxisAlignedBox& box,
+      const AxisAlignedBox& centroidsBox,
+      const BuildTask& task) const
+  {
+    const auto count = task.end - task.begin;
+    const auto extents = centroidsBox.maximum - centroidsBox.minimum;
+    int axis = 0;
+    if (extents.y > extents[axis])
+    {
+      axis = 1;
+    }
+    if (extents.z > extents[axis])
+    {
+      axis = 2;
+    }
+    // All centroids coincide so no plane separates them, only a too large
+    // leaf is worth splitting and any split is as good as another
+    if (extents[axis] <= 0.f)
+    {
+      if (count <= BoundingVolumeHierarchy::kMaxLeafPrimitivesCount)
+      {
+        return std::nullopt;
+      }
+      return task.begin + count / 2;
+    }
+
+    const auto scale = static_cast<float>(kBinsCount) / extents[axis];
+    const auto minimum = centroidsBox.minimum[axis];
+    const auto getBin = [&](uint32_t primitive)
+    {
+      const auto bin = static_cast<size_t>(
+          (centroids_[primitive][axis] - minimum) * scale);
+      return std::min(bin, kBinsCount - 1);
+    };
+
+    std::array<Bin, kBinsCount> bins{};
+    for (auto i = task.begin; i < task.end; ++i)
+    {
+      auto& bin = bins[getBin(primitiveIndices_[i])];
+      bin.box.expand(boxes_[primitiveIndices_[i]]);
+      ++bin.count;
+    }
+
+    // Cost of the part right of every bin boundary, then a sweep from the
+    // left which adds the costs of the left parts
+    const auto getCost = [](const AxisAlignedBox& partBox, uint32_t partCount)
+    {
+      return partCount > 0
+                 ? partBox.getSurfaceArea() * static_cast<float>(partCount)
+                 : 0.f;
+    };
+    std::array<float, kBinsCount - 1> rightCosts{};
+    auto rightBox = AxisAlignedBox::createEmpty();
+    uint32_t rightCount = 0;
+    for (size_t i = kBinsCount - 1; i > 0; --i)
+    {
+      rightBox.expand(bins[i].box);
+      rightCount += bins[i].count;
+      rightCosts[i - 1] = getCost(rightBox, rightCount);
+    }
+
+    auto leftBox = AxisAlignedBox::createEmpty();
+    uint32_t leftCount = 0;
+    size_t bestBin = 0;
+    auto bestCost = std::numeric_limits<float>::max();
+    for (size_t i = 0; i < kBinsCount - 1; ++i)
+    {
+      leftBox.expand(bins[i].box);
+      leftCount += bins[i].count;
+      const auto cost = getCost(leftBox, leftCount) + rightCosts[i];
+      if (leftCount > 0 && leftCount < count && cost < bestCost)
+      {
+        bestBin = i;
+        bestCost = cost;
+      }
+    }
+
+    // Both costs are scaled by the surface area of the node, which saves
+    // dividing by it
+    const auto area = box.getSurfaceArea();
+    const auto leafCost = area * static_cast<float>(count);
+    if (count <= BoundingVolumeHierarchy::kMaxLeafPrimitivesCount &&
+        kTraversalCost * area + bestCost >= leafCost)
+    {
+      return std::nullopt;
+    }
+
+    const auto first = primitiveIndices_.begin() + task.begin;
+    const auto last = primitiveIndices_.begin() + task.end;
+    const auto middle = std::partition(
+        first,
+        last,
+        [&](uint32_t primitive) { return getBin(primitive) <= bestBin; });
+    if (middle == first || middle == last)
+    {
+      return task.begin + count / 2;
+    }
+    return task.begin + static_cast<uint32_t>(middle - first);
+  }
+};
+
+bool overlap(const AxisAlignedBox& first, const AxisAlignedBox& second)
+{
+  return first.minimum.x <= second.maximum.x &&
+         second.minimum.x <= first.maximum.x &&
+         first.minimum.y <= second.maximum.y &&
+         second.minimum.y <= first.maximum.y &&
+         first.minimum.z <= second.maximum.z &&
+         second.minimum.z <= first.maximum.z;
+}
+
+}  // namespace
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(
+    std::span<const AxisAlignedBox> boxes)
+{
+  if (boxes.empty())
+  {
+    return;
+  }
+
+  const auto count = static_cast<uint32_t>(boxes.size());
+  primitiveIndices_.resize(count);
+  std::iota(primitiveIndices_.begin(), primitiveIndices_.end(), 0u);
+  const Builder builder(boxes, primitiveIndices_);
+
+  // Splits breadth first until there are enough subtrees to keep the pool
+  // busy, so they end up of similar sizes
+  auto& threadPool = getThreadPool();
+  const auto targetSubtreesCount =
+      threadPool.getConcurrency() * kSubtreesPerThread;
+  nodes_.reserve(2 * boxes.size() - 1);
+  nodes_.emplace_back();
+  std::vector<BuildTask> pending{ { 0, 0, count } };
+  std::vector<BuildTask> subtrees;
+  for (size_t next = 0; next < pending.size(); ++next)
+  {
+    const auto task = pending[next];
+    const auto queuedCount = pending.size() - next + subtrees.size();
+    if (task.end - task.begin < kMinParallelPrimitivesCount ||
+        queuedCount >= targetSubtreesCount)
+    {
+      subtrees.push_back(task);
+      continue;
+    }
+    builder.split(nodes_, task, pending);
+  }
+
+  std::vector<std::vector<Node>> subtreesNodes(subtrees.size());
+  threadPool.parallelFor(
+      subtrees.size(),
+      [&](size_t i)
+      {
+        auto& nodes = subtreesNodes[i];
+        nodes.emplace_back();
+        builder.buildSubtree(nodes, { 0, subtrees[i].begin, subtrees[i].end });
+      });
+
+  // The root of every subtree replaces the node its task was for and the
+  // rest of it is appended, with the child indices moved accordingly
+  for (size_t i = 0; i < subtrees.size(); ++i)
+  {
+    const auto offset = static_cast<uint32_t>(nodes_.size() - 1);
+    const auto relocate = [offset](Node node)
+    {
+      if (!node.isLeaf())
+      {
+        node.firstChildOrPrimitive += offset;
+      }
+      return node;
+    };
+    const auto& nodes = subtreesNodes[i];
+    nodes_[subtrees[i].nodeIndex] = relocate(nodes.front());
+    for (size_t j = 1; j < nodes.size(); ++j)
+    {
+      nodes_.push_back(relocate(nodes[j]));
+    }
+  }
+
+  primitiveBoxes_.reserve(count);
+  for (const auto primitive : primitiveIndices_)
+  {
+    primitiveBoxes_.push_back(boxes[primitive]);
+  }
+}
+
+// The same box versus plane test as BoundingBoxes::cull. A box on the
+// positive side of a plane even with its extents towards the plane is fully
+// inside of it, and so are all boxes in its subtree.
+void BoundingVolumeHierarchy::cull(
+    const Frustum& frustum,
+    std::span<uint8_t> visibility) const
+{
+  std::ranges::fill(visibility, uint8_t{ 0 });
+  if (nodes_.empty())
+  {
+    return;
+  }
+
+  constexpr uint32_t kAllPlanes = (1u << Frustum::kPlanesCount) - 1;
+  // Tests the box against the planes of the mask, returns the planes it
+  // still crosses or std::nullopt when it's outside
+  const auto test = [&frustum](const AxisAlignedBox& box, uint32_t planesMask)
+      -> std::optional<uint32_t>
+  {
+    const auto center = box.getCenter();
+    const auto extents = box.getExtents();
+    for (size_t i = 0; i < Frustum::kPlanesCount; ++i)
+    {
+      if ((planesMask & (1u << i)) == 0)
+      {
+        continue;
+      }
+      const auto& plane = frustum.planes[i];
+      const auto distance = plane.x * center.x + plane.y * center.y +
+                            plane.z * center.z + plane.w;
+      const auto radius = std::abs(plane.x) * extents.x +
+                          std::abs(plane.y) * extents.y +
+                          std::abs(plane.z) * extents.z;
+      if (distance + radius < 0.f)
+      {
+        return std::nullopt;
+      }
+      if (distance - radius >= 0.f)
+      {
+        planesMask &= ~(1u << i);
+      }
+    }
+    return planesMask;
+  };
+  const auto markVisible = [&](uint32_t first, uint32_t last)
+  {
+    for (auto i = first; i < last; ++i)
+    {
+      visibility[primitiveIndices_[i]] = 1;
+    }
+  };
+
+  struct Entry
+  {
+    uint32_t nodeIndex;
+    uint32_t planesMask;
+  };
+  std::vector<Entry> stack{ { 0, kAllPlanes } };
+  while (!stack.empty())
+  {
+    const auto [nodeIndex, parentPlanesMask] = stack.back();
+    stack.pop_back();
+    const auto& node = nodes_[nodeIndex];
+    const auto planesMask = test(node.box, parentPlanesMask);
+    if (!planesMask.has_value())
+    {
+      continue;
+    }
+
+    if (*planesMask == 0)
+    {
+      // Subtrees cover contiguous ranges of the primitive indices, from the
+      // first primitive of the leftmost leaf to the last one of the rightmost
+      auto first = nodeIndex;
+      while (!nodes_[first].isLeaf())
+      {
+        first = nodes_[first].firstChildOrPrimitive;
+      }
+      auto last = nodeIndex;
+      while (!nodes_[last].isLeaf())
+      {
+        last = nodes_[last].firstChildOrPrimitive + 1;
+      }
+      markVisible(
+          nodes_[first].firstChildOrPrimitive,
+          nodes_[last].firstChildOrPrimitive + nodes_[last].primitivesCount);
+    }
+    else if (node.isLeaf())
+    {
+      const auto first = node.firstChildOrPrimitive;
+      for (auto i = first; i < first + node.primitivesCount; ++i)
+      {
+        if (test(primitiveBoxes_[i], *planesMask).has_value())
+        {
+          markVisible(i, i + 1);
+        }
+      }
+    }
+    else
+    {
+      stack.push_back({ node.firstChildOrPrimitive, *planesMask });
+      stack.push_back({ node.firstChildOrPrimitive + 1, *planesMask });
+    }
+  }
+}
+
+void BoundingVolumeHierarchy::intersectRay(
+    const Ray& ray,
+    float maxDistance,
+    std::vector<RayHit>& hits) const
+{
+  if (nodes_.empty())
+  {
+    return;
+  }
+
+  const auto inverseDirection = 1.f / ray.direction;
+  const auto firstHit = static_cast<std::ptrdiff_t>(hits.size());
+  std::vector<uint32_t> stack{ 0 };
+  while (!stack.empty())
+  {
+    const auto& node = nodes_[stack.back()];
+    stack.pop_back();
+    if (!intersectRayBox(ray.origin, inverseDirection, node.box, maxDistance))
+    {
+      continue;
+    }
+
+    if (!node.isLeaf())
+    {
+      stack.push_back(node.firstChildOrPrimitive);
+      stack.push_back(node.firstChildOrPrimitive + 1);
+      continue;
+    }
+    const auto first = node.firstChildOrPrimitive;
+    for (auto i = first; i < first + node.primitivesCount; ++i)
+    {
+      if (const auto distance = intersectRayBox(
+              ray.origin, inverseDirection, primitiveBoxes_[i], maxDistance);
+          distance.has_value())
+      {
+        hits.push_back({ *distance, primitiveIndices_[i] });
+      }
+    }
+  }
+
+  std::sort(
+      hits.begin() + firstHit,
+      hits.end(),
+      [](const RayHit& first, const RayHit& second)
+      { return first.distance < second.distance; });
+}
+
+void BoundingVolumeHierarchy::intersectBox(
+    const AxisAlignedBox& box,
+    std::vector<uint32_t>& primitives) const
+{
+  if (nodes_.empty())
+  {
+    return;
+  }
+
+  std::vector<uint32_t> stack{ 0 };
+  while (!stack.empty())
+  {
+    const auto& node = nodes_[stack.back()];
+    stack.pop_back();
+    if (!overlap(node.box, box))
+    {
+      continue;
+    }
+
+    if (!node.isLeaf())
+    {
+      stack.push_back(node.firstChildOrPrimitive);
+      stack.push_back(node.firstChildOrPrimitive + 1);
+      continue;
+    }
+    const auto first = node.firstChildOrPrimitive;
+    for (auto i = first; i < first + node.primitivesCount; ++i)
+    {
+      if (overlap(primitiveBoxes_[i], box))
+      {
+        primitives.push_back(primitiveIndices_[i]);
+      }
+    }
+  }
+}
+
+}  // namespace Simple3D
@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <simple_3d_viewer/linear_algebra/boundingVolumes.hpp>
+#include <utility>
+
+namespace Simple3D
+{
+
+AxisAlignedBox calculateAxisAlignedBox(std::span<const Vertex> vertices)
+{
+  if (vertices.empty())
+  {
+    return {};
+  }
+
+  auto box = AxisAlignedBox::createEmpty();
+  for (const auto& vertex : vertices)
+  {
+    box.expand(vertex.position);
+  }
+  return box;
+}
+
+BoundingSphere calculateBoundingSphere(
+    std::span<const Vertex> vertices,
+    const AxisAlignedBox& box)
+{
+  const auto center = box.getCenter();
+  float radiusSquared = 0.f;
+  for (const auto& vertex : vertices)
+  {
+    const auto offset = vertex.position - center;
+    radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+  }
+  return { center, std::sqrt(radiusSquared) };
+}
+
+// Zero direction components give infinite inverses, the products are then
+// either infinities with the right sign or NaNs for origins exactly on a slab
+// plane. std::min and std::max return their first argument when comparing
+// with NaN, which keeps the NaNs out of the entry and exit distances.
+std::optional<float> intersectRayBox(
+    const glm::vec3& origin,
+    const glm::vec3& inverseDirection,
+    const AxisAlignedBox& box,
+    float maxDistance)
+{
+  float entry = 0.f;
+  float exit = maxDistance;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    auto near = (box.minimum[axis] - origin[axis]) * inverseDirection[axis];
+    auto far = (box.maximum[axis] - origin[axis]) * inverseDirection[axis];
+    if (near > far)
+    {
+      std::swap(near, far);
+    }
+    entry = std::max(entry, near);
+    exit = std::min(exit, far);
+  }
+  if (entry > exit)
+  {
+    return std::nullopt;
+  }
+  return entry;
+}
+
+}  // namespace Simple3D
@@ -0,0 +1,128 @@
+#include <cmath>
+#include <glm/mat4x4.hpp>
+#include <simple_3d_viewer/linear_algebra/frustumCulling.hpp>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace Simple3D
+{
+
+namespace
+{
+
+glm::vec4 getRow(const glm::mat4x4& matrix, int row)
+{
+  return { matrix[0][row], matrix[1][row], matrix[2][row], matrix[3][row] };
+}
+
+}  // namespace
+
+Frustum extractFrustum(const glm::mat4x4& projectionView)
+{
+  const auto x = getRow(projectionView, 0);
+  const auto y = getRow(projectionView, 1);
+  const auto z = getRow(projectionView, 2);
+  const auto w = getRow(projectionView, 3);
+  return { { w + x, w - x, w + y, w - y, w + z, w - z } };
+}
+
+Frustum transformFrustum(const Frustum& frustum, const glm::mat4x4& transform)
+{
+  const auto transposed = glm::transpose(transform);
+  Frustum result{};
+  for (size_t i = 0; i < Frustum::kPlanesCount; ++i)
+  {
+    result.planes[i] = transposed * frustum.planes[i];
+  }
+  return result;
+}
+
+void BoundingBoxes::assign(std::span<const AxisAlignedBox> boxes)
+{
+  count_ = boxes.size();
+  const auto paddedCount = (count_ + kBatchSize - 1) / kBatchSize * kBatchSize;
+  for (auto* components : { &centersX_,
+                            &centersY_,
+                            &centersZ_,
+                            &extentsX_,
+                            &extentsY_,
+                            &extentsZ_ })
+  {
+    components->assign(paddedCount, 0.f);
+  }
+  for (size_t i = 0; i < count_; ++i)
+  {
+    const auto center = boxes[i].getCenter();
+    const auto extents = boxes[i].getExtents();
+    centersX_[i] = center.x;
+    centersY_[i] = center.y;
+    centersZ_[i] = center.z;
+    extentsX_[i] = extents.x;
+    extentsY_[i] = extents.y;
+    extentsZ_[i] = extents.z;
+  }
+}
+
+// A box is outside when it's fully on the negative side of any plane, i.e.
+// its center is further from the plane than the projection of its extents
+// onto the plane normal
+void BoundingBoxes::cull(
+    const Frustum& frustum,
+    std::span<uint8_t> visibility) const
+{
+  size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+  for (; i < count_; i += kBatchSize)
+  {
+    const __m128 centerX = _mm_loadu_ps(&centersX_[i]);
+    const __m128 centerY = _mm_loadu_ps(&centersY_[i]);
+    const __m128 centerZ = _mm_loadu_ps(&centersZ_[i]);
+    const __m128 extentX = _mm_loadu_ps(&extentsX_[i]);
+    const __m128 extentY = _mm_loadu_ps(&extentsY_[i]);
+    const __m128 extentZ = _mm_loadu_ps(&extentsZ_[i]);
+    __m128 outside = _mm_setzero_ps();
+    for (const auto& plane : frustum.planes)
+    {
+      const __m128 distance = _mm_add_ps(
+          _mm_add_ps(
+              _mm_mul_ps(_mm_set1_ps(plane.x), centerX),
+              _mm_mul_ps(_mm_set1_ps(plane.y), centerY)),
+          _mm_add_ps(
+              _mm_mul_ps(_mm_set1_ps(plane.z), centerZ),
+              _mm_set1_ps(plane.w)));
+      const __m128 radius = _mm_add_ps(
+          _mm_add_ps(
+              _mm_mul_ps(_mm_set1_ps(std::abs(plane.x)), extentX),
+              _mm_mul_ps(_mm_set1_ps(std::abs(plane.y)), extentY)),
+          _mm_mul_ps(_mm_set1_ps(std::abs(plane.z)), extentZ));
+      const __m128 behind =
+          _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps());
+      outside = _mm_or_ps(outside, behind);
+    }
+
+    const auto outsideMask =
+        static_cast<unsigned int>(_mm_movemask_ps(outside));
+    for (size_t j = 0; j < kBatchSize && i + j < count_; ++j)
+    {
+      visibility[i + j] = ((outsideMask >> j) & 1u) == 0 ? 1 : 0;
+    }
+  }
+#endif
+  for (; i < count_; ++i)
+  {
+    bool outside = false;
+    for (const auto& plane : frustum.planes)
+    {
+      const auto distance = plane.x * centersX_[i] + plane.y * centersY_[i] +
+                            plane.z * centersZ_[i] + plane.w;
+      const auto radius = std::abs(plane.x) * extentsX_[i] +
+                          std::abs(plane.y) * extentsY_[i] +
+                          std::abs(plane.z) * extentsZ_[i];
+      outside = outside || distance + radius < 0.f;
+    }
+    visibility[i] = outside ? 0 : 1;
+  }
+}
+
+}  // namespace Simple3D
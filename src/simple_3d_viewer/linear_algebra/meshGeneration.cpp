@@ -95,7 +95,7 @@ Mesh sphereMesh(float radius)
     }
   }
 
-  return { std::move(vertices), std::move(indices) };
+  return { PositionVertexLayout{}, std::move(vertices), std::move(indices) };
 }
 
 Mesh skyboxMesh()
@@ -138,7 +138,7 @@ Mesh skyboxMesh()
     { glm::vec3(-1.0f, -1.0f, 1.0f), {}, {}, {} },
     { glm::vec3(1.0f, -1.0f, 1.0f), {}, {}, {} }
   };
-  return Mesh{ std::move(squareVertices) };
+  return Mesh{ PositionVertexLayout{}, std::move(squareVertices) };
 }
 
 }  // namespace Simple3D
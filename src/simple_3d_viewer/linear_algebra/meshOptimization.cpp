@@ -0,0 +1,319 @@
+#include <algorithm>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+#include <limits>
+#include <numeric>
+#include <simple_3d_viewer/linear_algebra/meshOptimization.hpp>
+
+namespace Simple3D
+{
+
+namespace
+{
+
+constexpr uint32_t kNoVertex = std::numeric_limits<uint32_t>::max();
+constexpr size_t kTriangleIndicesCount = 3;
+
+// Triangles using every vertex, stored as a compressed sparse row
+struct VertexTriangles
+{
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> triangles;
+
+  [[nodiscard]] std::span<const uint32_t> get(uint32_t vertex) const
+  {
+    return std::span(triangles)
+        .subspan(offsets[vertex], offsets[vertex + 1] - offsets[vertex]);
+  }
+};
+
+VertexTriangles buildVertexTriangles(
+    std::span<const uint32_t> indices,
+    size_t verticesCount)
+{
+  VertexTriangles vertexTriangles;
+  vertexTriangles.offsets.assign(verticesCount + 1, 0);
+  for (const auto index : indices)
+  {
+    ++vertexTriangles.offsets[index + 1];
+  }
+  std::partial_sum(
+      begin(vertexTriangles.offsets),
+      end(vertexTriangles.offsets),
+      begin(vertexTriangles.offsets));
+
+  vertexTriangles.triangles.resize(indices.size());
+  auto fillOffsets = vertexTriangles.offsets;
+  for (size_t i = 0; i < indices.size(); ++i)
+  {
+    vertexTriangles.triangles[fillOffsets[indices[i]]++] =
+        static_cast<uint32_t>(i / kTriangleIndicesCount);
+  }
+  return vertexTriangles;
+}
+
+}  // namespace
+
+bool isTriangleList(std::span<const uint32_t> indices, size_t verticesCount)
+{
+  return !indices.empty() && indices.size() % kTriangleIndicesCount == 0 &&
+         std::ranges::all_of(
+             indices,
+             [verticesCount](uint32_t index) { return index < verticesCount; });
+}
+
+VertexCacheStatistics analyzeVertexCache(
+    std::span<const uint32_t> indices,
+    size_t verticesCount)
+{
+  VertexCacheStatistics statistics;
+  statistics.trianglesCount = indices.size() / kTriangleIndicesCount;
+
+  // FIFO cache, a vertex is in the cache while fewer than kVertexCacheSize
+  // misses happened since it was transformed
+  std::vector<size_t> transformTimes(verticesCount, 0);
+  std::vector<bool> referenced(verticesCount, false);
+  for (const auto index : indices)
+  {
+    if (!referenced[index])
+    {
+      referenced[index] = true;
+      ++statistics.referencedVerticesCount;
+    }
+    const auto time = statistics.transformedVerticesCount;
+    if (transformTimes[index] == 0 ||
+        time - transformTimes[index] >= kVertexCacheSize)
+    {
+      ++statistics.transformedVerticesCount;
+      transformTimes[index] = statistics.transformedVerticesCount;
+    }
+  }
+  return statistics;
+}
+
+std::vector<size_t> optimizeVertexCache(
+    std::vector<uint32_t>& indices,
+    size_t verticesCount)
+{
+  const auto trianglesCount = indices.size() / kTriangleIndicesCount;
+  const auto vertexTriangles = buildVertexTriangles(indices, verticesCount);
+
+  std::vector<uint32_t> liveTrianglesCounts(verticesCount);
+  for (uint32_t vertex = 0; vertex < verticesCount; ++vertex)
+  {
+    liveTrianglesCounts[vertex] =
+        static_cast<uint32_t>(vertexTriangles.get(vertex).size());
+  }
+  std::vector<size_t> cacheTimes(verticesCount, 0);
+  std::vector<bool> emitted(trianglesCount, false);
+  std::vector<uint32_t> deadEndStack;
+  std::vector<uint32_t> candidates;
+  std::vector<uint32_t> output;
+  output.reserve(indices.size());
+  std::vector<size_t> clusterStarts;
+
+  size_t time = kVertexCacheSize + 1;
+  uint32_t nextInputVertex = 0;
+  const auto skipDeadEnd = [&]() -> uint32_t
+  {
+    while (!deadEndStack.empty())
+    {
+      const auto vertex = deadEndStack.back();
+      deadEndStack.pop_back();
+      if (liveTrianglesCounts[vertex] > 0)
+      {
+        return vertex;
+      }
+    }
+    for (; nextInputVertex < verticesCount; ++nextInputVertex)
+    {
+      if (liveTrianglesCounts[nextInputVertex] > 0)
+      {
+        return nextInputVertex;
+      }
+    }
+    return kNoVertex;
+  };
+
+  // Locality is lost every time the fanning vertex comes from skipDeadEnd,
+  // those are the points where the clusters start
+  auto fanningVertex = skipDeadEnd();
+  while (fanningVertex != kNoVertex)
+  {
+    clusterStarts.push_back(output.size());
+    while (fanningVertex != kNoVertex)
+    {
+      candidates.clear();
+      for (const auto triangle : vertexTriangles.get(fanningVertex))
+      {
+        if (emitted[triangle])
+        {
+          continue;
+        }
+        emitted[triangle] = true;
+        for (size_t i = 0; i < kTriangleIndicesCount; ++i)
+        {
+          const auto vertex = indices[triangle * kTriangleIndicesCount + i];
+          output.push_back(vertex);
+          deadEndStack.push_back(vertex);
+          candidates.push_back(vertex);
+          --liveTrianglesCounts[vertex];
+          if (time - cacheTimes[vertex] > kVertexCacheSize)
+          {
+            cacheTimes[vertex] = time;
+            ++time;
+          }
+        }
+      }
+
+      // Prefer the candidate which stays in the cache for the longest while
+      // all of its remaining triangles get emitted
+      fanningVertex = kNoVertex;
+      size_t bestPriority = 0;
+      for (const auto vertex : candidates)
+      {
+        if (liveTrianglesCounts[vertex] == 0)
+        {
+          continue;
+        }
+        size_t priority = 1;
+        if (const auto age = time - cacheTimes[vertex];
+            age + 2 * liveTrianglesCounts[vertex] <= kVertexCacheSize)
+        {
+          priority += age;
+        }
+        if (priority > bestPriority)
+        {
+          bestPriority = priority;
+          fanningVertex = vertex;
+        }
+      }
+    }
+    fanningVertex = skipDeadEnd();
+  }
+
+  indices = std::move(output);
+  return clusterStarts;
+}
+
+void optimizeOverdraw(
+    std::vector<uint32_t>& indices,
+    std::span<const Vertex> vertices,
+    std::span<const size_t> clusterStarts)
+{
+  if (clusterStarts.size() < 2)
+  {
+    return;
+  }
+
+  struct Cluster
+  {
+    size_t begin;
+    size_t end;
+    glm::vec3 centroid{};
+    glm::vec3 normal{};
+    float sortKey{};
+  };
+
+  std::vector<Cluster> clusters(clusterStarts.size());
+  glm::vec3 meshCentroid{};
+  float meshArea = 0.f;
+  for (size_t i = 0; i < clusters.size(); ++i)
+  {
+    auto& cluster = clusters[i];
+    cluster.begin = clusterStarts[i];
+    cluster.end =
+        i + 1 < clusterStarts.size() ? clusterStarts[i + 1] : indices.size();
+
+    // Area weighted, the cross product length is twice the triangle area
+    float clusterArea = 0.f;
+    for (auto j = cluster.begin; j < cluster.end; j += kTriangleIndicesCount)
+    {
+      const auto& p0 = vertices[indices[j]].position;
+      const auto& p1 = vertices[indices[j + 1]].position;
+      const auto& p2 = vertices[indices[j + 2]].position;
+      const auto normal = glm::cross(p1 - p0, p2 - p0);
+      const auto area = glm::length(normal);
+      cluster.centroid += (p0 + p1 + p2) * (area / 3.f);
+      cluster.normal += normal;
+      clusterArea += area;
+    }
+    meshCentroid += cluster.centroid;
+    meshArea += clusterArea;
+    if (clusterArea > 0.f)
+    {
+      cluster.centroid /= clusterArea;
+    }
+  }
+  if (meshArea > 0.f)
+  {
+    meshCentroid /= meshArea;
+  }
+
+  for (auto& cluster : clusters)
+  {
+    const auto normalLength = glm::length(cluster.normal);
+    cluster.sortKey =
+        normalLength > 0.f
+            ? glm::dot(cluster.centroid - meshCentroid, cluster.normal) /
+                  normalLength
+            : 0.f;
+  }
+  std::ranges::stable_sort(
+      clusters,
+      [](const Cluster& lhs, const Cluster& rhs)
+      { return lhs.sortKey > rhs.sortKey; });
+
+  std::vector<uint32_t> output;
+  output.reserve(indices.size());
+  for (const auto& cluster : clusters)
+  {
+    output.insert(
+        end(output),
+        begin(indices) + static_cast<std::ptrdiff_t>(cluster.begin),
+        begin(indices) + static_cast<std::ptrdiff_t>(cluster.end));
+  }
+  indices = std::move(output);
+}
+
+void optimizeVertexFetch(
+    std::vector<Vertex>& vertices,
+    std::vector<uint32_t>& indices)
+{
+  std::vector<uint32_t> remap(vertices.size(), kNoVertex);
+  std::vector<Vertex> output;
+  output.reserve(vertices.size());
+  for (auto& index : indices)
+  {
+    if (remap[index] == kNoVertex)
+    {
+      remap[index] = static_cast<uint32_t>(output.size());
+      output.push_back(vertices[index]);
+    }
+    index = remap[index];
+  }
+  for (size_t i = 0; i < vertices.size(); ++i)
+  {
+    if (remap[i] == kNoVertex)
+    {
+      output.push_back(vertices[i]);
+    }
+  }
+  vertices = std::move(output);
+}
+
+void optimizeMesh(
+    std::vector<Vertex>& vertices,
+    std::vector<uint32_t>& indices)
+{
+  if (!isTriangleList(indices, vertices.size()))
+  {
+    return;
+  }
+
+  const auto clusterStarts = optimizeVertexCache(indices, vertices.size());
+  optimizeOverdraw(indices, vertices, clusterStarts);
+  optimizeVertexFetch(vertices, indices);
+}
+
+}  // namespace Simple3D
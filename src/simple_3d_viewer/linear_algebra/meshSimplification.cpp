@@ -0,0 +1,511 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+#include <numeric>
+#include <simple_3d_viewer/linear_algebra/meshOptimization.hpp>
+#include <simple_3d_viewer/linear_algebra/meshSimplification.hpp>
+#include <tuple>
+
+namespace Simple3D
+{
+
+namespace
+{
+
+constexpr size_t kTriangleIndicesCount = 3;
+// Levels with fewer triangles aren't worth the extra index data
+constexpr size_t kMinLodTrianglesCount = 16;
+
+// Sum of the squared distances from a set of planes, weighted by the areas of
+// the triangles the planes come from
+struct Quadric
+{
+  // Upper triangle of the symmetric 4x4 matrix, row by row
+  std::array<double, 10> m{};
+  double weight{};
+
+  static Quadric fromTriangle(
+      const glm::vec3& p0,
+      const glm::vec3& p1,
+      const glm::vec3& p2)
+  {
+    const auto normal = glm::cross(p1 - p0, p2 - p0);
+    const auto doubleArea = static_cast<double>(glm::length(normal));
+    if (doubleArea == 0.)
+    {
+      return {};
+    }
+
+    const auto a = static_cast<double>(normal.x) / doubleArea;
+    const auto b = static_cast<double>(normal.y) / doubleArea;
+    const auto c = static_cast<double>(normal.z) / doubleArea;
+    const auto d = -(a * static_cast<double>(p0.x) +
+                     b * static_cast<double>(p0.y) +
+                     c * static_cast<double>(p0.z));
+    const auto area = doubleArea * 0.5;
+    Quadric quadric{
+      { a * a, a * b, a * c, a * d, b * b, b * c, b * d, c * c, c * d, d * d },
+      area
+    };
+    for (auto& value : quadric.m)
+    {
+      value *= area;
+    }
+    return quadric;
+  }
+
+  Quadric& operator+=(const Quadric& other)
+  {
+    for (size_t i = 0; i < m.size(); ++i)
+    {
+      m[i] += other.m[i];
+    }
+    weight += other.weight;
+    return *this;
+  }
+
+  // Mean squared distance of the point from the planes
+  [[nodiscard]] double evaluate(const glm::vec3& point) const
+  {
+    if (weight <= 0.)
+    {
+      return 0.;
+    }
+    const auto x = static_cast<double>(point.x);
+    const auto y = static_cast<double>(point.y);
+    const auto z = static_cast<double>(point.z);
+    const auto error = m[0] * x * x + 2. * m[1] * x * y + 2. * m[2] * x * z +
+                       2. * m[3] * x + m[4] * y * y + 2. * m[5] * y * z +
+                       2. * m[6] * y + m[7] * z * z + 2. * m[8] * z + m[9];
+    return std::max(error, 0.) / weight;
+  }
+};
+
+Quadric operator+(Quadric lhs, const Quadric& rhs)
+{
+  lhs += rhs;
+  return lhs;
+}
+
+// Compressed sparse row mapping of ids to lists of elements
+struct Groups
+{
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> elements;
+
+  [[nodiscard]] std::span<const uint32_t> get(uint32_t id) const
+  {
+    return std::span(elements).subspan(
+        offsets[id], offsets[id + 1] - offsets[id]);
+  }
+};
+
+// Vertices which differ only in attributes other than the position, like the
+// ones on UV seams, share a position id, so the simplification sees a
+// connected surface
+struct Welding
+{
+  std::vector<uint32_t> positionIds;
+  // Vertices of every position id
+  Groups positionVertices;
+  std::vector<glm::vec3> positions;
+};
+
+Welding weldPositions(std::span<const Vertex> vertices)
+{
+  Welding welding;
+  auto& [offsets, elements] = welding.positionVertices;
+  elements.resize(vertices.size());
+  std::iota(begin(elements), end(elements), uint32_t{});
+  const auto positionTuple = [&vertices](uint32_t vertex)
+  {
+    const auto& position = vertices[vertex].position;
+    return std::tie(position.x, position.y, position.z);
+  };
+  std::ranges::sort(
+      elements,
+      [&positionTuple](uint32_t lhs, uint32_t rhs)
+      { return positionTuple(lhs) < positionTuple(rhs); });
+
+  welding.positionIds.resize(vertices.size());
+  for (size_t i = 0; i < elements.size(); ++i)
+  {
+    const auto vertex = elements[i];
+    if (i == 0 ||
+        vertices[vertex].position != vertices[elements[i - 1]].position)
+    {
+      offsets.push_back(static_cast<uint32_t>(i));
+      welding.positions.push_back(vertices[vertex].position);
+    }
+    welding.positionIds[vertex] =
+        static_cast<uint32_t>(welding.positions.size() - 1);
+  }
+  offsets.push_back(static_cast<uint32_t>(elements.size()));
+  return welding;
+}
+
+// Triangles around every position
+Groups buildPositionTriangles(
+    std::span<const uint32_t> indices,
+    const std::vector<uint32_t>& positionIds,
+    size_t positionsCount)
+{
+  Groups positionTriangles;
+  positionTriangles.offsets.assign(positionsCount + 1, 0);
+  for (const auto index : indices)
+  {
+    ++positionTriangles.offsets[positionIds[index] + 1];
+  }
+  std::partial_sum(
+      begin(positionTriangles.offsets),
+      end(positionTriangles.offsets),
+      begin(positionTriangles.offsets));
+
+  positionTriangles.elements.resize(indices.size());
+  auto fillOffsets = positionTriangles.offsets;
+  for (size_t i = 0; i < indices.size(); ++i)
+  {
+    positionTriangles.elements[fillOffsets[positionIds[indices[i]]]++] =
+        static_cast<uint32_t>(i / kTriangleIndicesCount);
+  }
+  return positionTriangles;
+}
+
+uint64_t edgeKey(uint32_t from, uint32_t to)
+{
+  return (uint64_t{ from } << 32u) | to;
+}
+
+// Positions on edges which only one triangle goes along
+std::vector<bool> findBorderPositions(
+    std::span<const uint32_t> indices,
+    const std::vector<uint32_t>& positionIds,
+    size_t positionsCount)
+{
+  std::vector<uint64_t> edges;
+  edges.reserve(indices.size());
+  for (size_t i = 0; i < indices.size(); i += kTriangleIndicesCount)
+  {
+    for (size_t j = 0; j < kTriangleIndicesCount; ++j)
+    {
+      const auto from = positionIds[indices[i + j]];
+      const auto to =
+          positionIds[indices[i + (j + 1) % kTriangleIndicesCount]];
+      edges.push_back(edgeKey(from, to));
+    }
+  }
+  std::ranges::sort(edges);
+
+  std::vector<bool> border(positionsCount, false);
+  for (const auto edge : edges)
+  {
+    const auto from = static_cast<uint32_t>(edge >> 32u);
+    const auto to = static_cast<uint32_t>(edge);
+    if (!std::ranges::binary_search(edges, edgeKey(to, from)))
+    {
+      border[from] = true;
+      border[to] = true;
+    }
+  }
+  return border;
+}
+
+struct Collapse
+{
+  uint32_t from;
+  uint32_t to;
+  double cost;
+};
+
+// Every edge collapsed in its cheaper direction, cheapest edges first. The
+// merged vertex stays at the position of one of the ends, so the attributes
+// of the existing vertices remain valid.
+std::vector<Collapse> collectCollapses(
+    std::span<const uint32_t> indices,
+    const Welding& welding,
+    const std::vector<Quadric>& quadrics,
+    const std::vector<bool>& locked)
+{
+  std::vector<uint64_t> edges;
+  edges.reserve(indices.size());
+  for (size_t i = 0; i < indices.size(); i += kTriangleIndicesCount)
+  {
+    for (size_t j = 0; j < kTriangleIndicesCount; ++j)
+    {
+      const auto a = welding.positionIds[indices[i + j]];
+      const auto b =
+          welding.positionIds[indices[i + (j + 1) % kTriangleIndicesCount]];
+      edges.push_back(edgeKey(std::min(a, b), std::max(a, b)));
+    }
+  }
+  std::ranges::sort(edges);
+  const auto [uniqueEnd, edgesEnd] = std::ranges::unique(edges);
+  edges.erase(uniqueEnd, edgesEnd);
+
+  std::vector<Collapse> collapses;
+  collapses.reserve(edges.size());
+  for (const auto edge : edges)
+  {
+    const auto a = static_cast<uint32_t>(edge >> 32u);
+    const auto b = static_cast<uint32_t>(edge);
+    if (a == b || (locked[a] && locked[b]))
+    {
+      continue;
+    }
+    // Locked positions can only be collapsed into
+    const auto quadric = quadrics[a] + quadrics[b];
+    if (locked[a])
+    {
+      collapses.push_back({ b, a, quadric.evaluate(welding.positions[a]) });
+    }
+    else if (locked[b])
+    {
+      collapses.push_back({ a, b, quadric.evaluate(welding.positions[b]) });
+    }
+    else
+    {
+      const auto costToA = quadric.evaluate(welding.positions[a]);
+      const auto costToB = quadric.evaluate(welding.positions[b]);
+      collapses.push_back(
+          costToA < costToB ? Collapse{ b, a, costToA }
+                            : Collapse{ a, b, costToB });
+    }
+  }
+  std::ranges::sort(
+      collapses,
+      [](const Collapse& lhs, const Collapse& rhs)
+      { return lhs.cost < rhs.cost; });
+  return collapses;
+}
+
+// Whether moving the position makes any of the surrounding triangles face the
+// other way
+bool flipsTriangle(
+    const Collapse& collapse,
+    std::span<const uint32_t> indices,
+    const Welding& welding,
+    const Groups& positionTriangles)
+{
+  for (const auto triangle : positionTriangles.get(collapse.from))
+  {
+    std::array<uint32_t, kTriangleIndicesCount> ids{};
+    for (size_t i = 0; i < kTriangleIndicesCount; ++i)
+    {
+      ids[i] =
+          welding.positionIds[indices[triangle * kTriangleIndicesCount + i]];
+    }
+    if (std::ranges::find(ids, collapse.to) != end(ids))
+    {
+      continue;
+    }
+
+    std::array<glm::vec3, kTriangleIndicesCount> points{};
+    for (size_t i = 0; i < kTriangleIndicesCount; ++i)
+    {
+      points[i] = welding.positions[ids[i]];
+    }
+    const auto normalBefore =
+        glm::cross(points[1] - points[0], points[2] - points[0]);
+    for (size_t i = 0; i < kTriangleIndicesCount; ++i)
+    {
+      if (ids[i] == collapse.from)
+      {
+        points[i] = welding.positions[collapse.to];
+      }
+    }
+    const auto normalAfter =
+        glm::cross(points[1] - points[0], points[2] - points[0]);
+    if (glm::dot(normalBefore, normalAfter) <= 0.f)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Vertex at the target position whose attributes are the closest, keeps the
+// UV seams intact where possible
+uint32_t findClosestVertex(
+    std::span<const Vertex> vertices,
+    uint32_t vertex,
+    std::span<const uint32_t> candidates)
+{
+  const auto& source = vertices[vertex];
+  const auto distance = [&source](const Vertex& candidate)
+  {
+    const auto texCoordOffset = candidate.texCoords[0] - source.texCoords[0];
+    const auto normalOffset = candidate.normal - source.normal;
+    return glm::dot(texCoordOffset, texCoordOffset) +
+           glm::dot(normalOffset, normalOffset);
+  };
+  return *std::ranges::min_element(
+      candidates,
+      [&vertices, &distance](uint32_t lhs, uint32_t rhs)
+      { return distance(vertices[lhs]) < distance(vertices[rhs]); });
+}
+
+}  // namespace
+
+SimplifiedIndices simplifyMesh(
+    std::span<const Vertex> vertices,
+    std::span<const uint32_t> indices,
+    size_t targetIndicesCount)
+{
+  std::vector<uint32_t> result(begin(indices), end(indices));
+  if (result.size() <= targetIndicesCount ||
+      !isTriangleList(indices, vertices.size()))
+  {
+    return { std::move(result), 0.f };
+  }
+
+  const auto welding = weldPositions(vertices);
+  const auto positionsCount = welding.positions.size();
+  std::vector<Quadric> quadrics(positionsCount);
+  for (size_t i = 0; i < result.size(); i += kTriangleIndicesCount)
+  {
+    const auto quadric = Quadric::fromTriangle(
+        vertices[result[i]].position,
+        vertices[result[i + 1]].position,
+        vertices[result[i + 2]].position);
+    for (size_t j = 0; j < kTriangleIndicesCount; ++j)
+    {
+      quadrics[welding.positionIds[result[i + j]]] += quadric;
+    }
+  }
+  const auto locked =
+      findBorderPositions(result, welding.positionIds, positionsCount);
+
+  // Every pass collapses a set of edges which don't share any triangles, so
+  // the checks done against the triangles at the start of the pass hold
+  std::vector<uint32_t> vertexRemap(vertices.size());
+  std::iota(begin(vertexRemap), end(vertexRemap), uint32_t{});
+  std::vector<bool> touched(positionsCount);
+  double maxCost = 0.;
+  while (result.size() > targetIndicesCount)
+  {
+    const auto positionTriangles =
+        buildPositionTriangles(result, welding.positionIds, positionsCount);
+    const auto collapses =
+        collectCollapses(result, welding, quadrics, locked);
+    const auto trianglesToRemoveCount =
+        (result.size() - targetIndicesCount + kTriangleIndicesCount - 1) /
+        kTriangleIndicesCount;
+    std::fill(begin(touched), end(touched), false);
+    size_t removedTrianglesCount = 0;
+    for (const auto& collapse : collapses)
+    {
+      if (removedTrianglesCount >= trianglesToRemoveCount)
+      {
+        break;
+      }
+      if (touched[collapse.from] || touched[collapse.to] ||
+          flipsTriangle(collapse, result, welding, positionTriangles))
+      {
+        continue;
+      }
+
+      for (const auto triangle : positionTriangles.get(collapse.from))
+      {
+        bool removed = false;
+        for (size_t i = 0; i < kTriangleIndicesCount; ++i)
+        {
+          const auto positionId =
+              welding.positionIds[result[triangle * kTriangleIndicesCount + i]];
+          touched[positionId] = true;
+          removed = removed || positionId == collapse.to;
+        }
+        removedTrianglesCount += removed ? 1 : 0;
+      }
+      const auto targetVertices =
+          welding.positionVertices.get(collapse.to);
+      for (const auto vertex : welding.positionVertices.get(collapse.from))
+      {
+        vertexRemap[vertex] =
+            findClosestVertex(vertices, vertex, targetVertices);
+      }
+      quadrics[collapse.to] += quadrics[collapse.from];
+      maxCost = std::max(maxCost, collapse.cost);
+    }
+    if (removedTrianglesCount == 0)
+    {
+      break;
+    }
+
+    // Triangles which had both ends of a collapsed edge are degenerate now
+    size_t outputSize = 0;
+    for (size_t i = 0; i < result.size(); i += kTriangleIndicesCount)
+    {
+      const auto a = vertexRemap[result[i]];
+      const auto b = vertexRemap[result[i + 1]];
+      const auto c = vertexRemap[result[i + 2]];
+      const auto& ids = welding.positionIds;
+      if (ids[a] == ids[b] || ids[b] == ids[c] || ids[a] == ids[c])
+      {
+        continue;
+      }
+      result[outputSize++] = a;
+      result[outputSize++] = b;
+      result[outputSize++] = c;
+    }
+    result.resize(outputSize);
+  }
+
+  return { std::move(result), static_cast<float>(std::sqrt(maxCost)) };
+}
+
+std::vector<MeshLod> generateLods(
+    std::span<const Vertex> vertices,
+    std::vector<uint32_t>& indices,
+    bool optimizeLevels)
+{
+  std::vector<MeshLod> lods{ { 0, indices.size(), 0.f } };
+  std::vector<uint32_t> previousLevel(indices);
+  float error = 0.f;
+  while (lods.size() < kMaxLodsCount)
+  {
+    const auto targetTrianglesCount =
+        previousLevel.size() / kTriangleIndicesCount / 2;
+    if (targetTrianglesCount < kMinLodTrianglesCount)
+    {
+      break;
+    }
+    auto [levelIndices, levelError] = simplifyMesh(
+        vertices, previousLevel, targetTrianglesCount * kTriangleIndicesCount);
+    // A level which drops less than a quarter of the triangles isn't worth
+    // keeping, usually the mesh is mostly border at that point
+    if (levelIndices.empty() ||
+        levelIndices.size() * 4 > previousLevel.size() * 3)
+    {
+      break;
+    }
+
+    if (optimizeLevels)
+    {
+      optimizeVertexCache(levelIndices, vertices.size());
+    }
+    // Every level is simplified from the previous one, so the errors add up
+    error += levelError;
+    lods.push_back({ indices.size(), levelIndices.size(), error });
+    indices.insert(end(indices), begin(levelIndices), end(levelIndices));
+    previousLevel = std::move(levelIndices);
+  }
+  return lods;
+}
+
+size_t selectLodLevel(
+    std::span<const MeshLod> lods,
+    const float pixelsPerUnit,
+    const float maxError)
+{
+  size_t lodLevel = 0;
+  while (lodLevel + 1 < lods.size() &&
+         lods[lodLevel + 1].error * pixelsPerUnit <= maxError)
+  {
+    ++lodLevel;
+  }
+  return lodLevel;
+}
+
+}  // namespace Simple3D
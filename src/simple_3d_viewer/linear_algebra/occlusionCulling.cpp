@@ -0,0 +1,431 @@
+#include <algorithm>
+#include <cmath>
+#include <glm/vec4.hpp>
+#include <limits>
+#include <simple_3d_viewer/linear_algebra/Transform.hpp>
+#include <simple_3d_viewer/linear_algebra/occlusionCulling.hpp>
+#include <simple_3d_viewer/utils/ThreadPool.hpp>
+#include <utility>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace Simple3D
+{
+
+namespace
+{
+
+constexpr size_t kTriangleVerticesCount = 3;
+constexpr float kClearDepth = 1.f;
+constexpr int kBlocksX = OcclusionBuffer::kWidth / OcclusionBuffer::kBlockSize;
+constexpr int kTileBlocksX =
+    OcclusionBuffer::kTileWidth / OcclusionBuffer::kBlockSize;
+constexpr int kTileBlocksY =
+    OcclusionBuffer::kTileHeight / OcclusionBuffer::kBlockSize;
+// Pixels rasterized at once
+constexpr int kPixelsBatchSize = 4;
+
+static_assert(OcclusionBuffer::kWidth % OcclusionBuffer::kTileWidth == 0);
+static_assert(OcclusionBuffer::kTileWidth % OcclusionBuffer::kBlockSize == 0);
+static_assert(OcclusionBuffer::kTileHeight % OcclusionBuffer::kBlockSize == 0);
+static_assert(OcclusionBuffer::kBlockSize % kPixelsBatchSize == 0);
+
+// Only valid for points in front of the near plane
+glm::vec3 toWindowSpace(const glm::vec4& clipPosition, Size size)
+{
+  const auto inverseW = 1.f / clipPosition.w;
+  return { (clipPosition.x * inverseW * 0.5f + 0.5f) *
+               static_cast<float>(size.width),
+           (clipPosition.y * inverseW * 0.5f + 0.5f) *
+               static_cast<float>(size.height),
+           clipPosition.z * inverseW * 0.5f + 0.5f };
+}
+
+// Sutherland-Hodgman against the near plane, z >= -w in the clip space.
+// Returns the number of vertices of the clipped polygon, which is at most
+// four.
+size_t clipAgainstNearPlane(
+    const std::array<glm::vec4, kTriangleVerticesCount>& triangle,
+    std::array<glm::vec4, kTriangleVerticesCount + 1>& polygon)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < kTriangleVerticesCount; ++i)
+  {
+    const auto& current = triangle[i];
+    const auto& next = triangle[(i + 1) % kTriangleVerticesCount];
+    const auto currentDistance = current.z + current.w;
+    const auto nextDistance = next.z + next.w;
+    if (currentDistance >= 0.f)
+    {
+      polygon[count++] = current;
+    }
+    if ((currentDistance >= 0.f) != (nextDistance >= 0.f))
+    {
+      const auto t = currentDistance / (currentDistance - nextDistance);
+      polygon[count++] = current + t * (next - current);
+    }
+  }
+  return count;
+}
+
+// a * x + b * y + c, positive on the left of the edge from the first vertex
+// to the second one
+struct EdgeFunction
+{
+  float a;
+  float b;
+  float c;
+
+  EdgeFunction(const glm::vec3& from, const glm::vec3& to)
+      : a(from.y - to.y),
+        b(to.x - from.x),
+        c(from.x * to.y - from.y * to.x)
+  {
+  }
+
+  [[nodiscard]] float operator()(float x, float y) const
+  {
+    return a * x + b * y + c;
+  }
+};
+
+}  // namespace
+
+void OcclusionBuffer::resize(Size framebufferSize)
+{
+  if (framebufferSize.width <= 0 || framebufferSize.height <= 0)
+  {
+    return;
+  }
+
+  const auto height = kWidth * framebufferSize.height / framebufferSize.width;
+  tilesX_ = kWidth / kTileWidth;
+  tilesY_ = std::max((height + kTileHeight - 1) / kTileHeight, 1);
+  height_ = tilesY_ * kTileHeight;
+  depths_.resize(static_cast<size_t>(kWidth * height_));
+  blocksDepths_.resize(static_cast<size_t>(kBlocksX * height_ / kBlockSize));
+  tilesDepths_.resize(static_cast<size_t>(tilesX_ * tilesY_));
+  tilesTriangles_.resize(static_cast<size_t>(tilesX_ * tilesY_));
+  clear();
+}
+
+size_t OcclusionBuffer::selectOccluderLod(
+    std::span<const MeshLod> lods,
+    const float distance) const
+{
+  if (depths_.empty() || distance <= 0.f)
+  {
+    return 0;
+  }
+  const auto pixelsPerUnit = calculateProjectionScale(getSize()) / distance;
+  return selectLodLevel(lods, pixelsPerUnit, kMaxOccluderLodError);
+}
+
+void OcclusionBuffer::clear()
+{
+  std::ranges::fill(depths_, kClearDepth);
+  std::ranges::fill(blocksDepths_, kClearDepth);
+  std::ranges::fill(tilesDepths_, kClearDepth);
+  triangles_.clear();
+  for (auto& tileTriangles : tilesTriangles_)
+  {
+    tileTriangles.clear();
+  }
+}
+
+void OcclusionBuffer::addOccluder(
+    std::span<const Vertex> vertices,
+    std::span<const uint32_t> indices,
+    const glm::mat4x4& clipTransform)
+{
+  const auto size = getSize();
+  const auto trianglesCount =
+      (indices.empty() ? vertices.size() : indices.size()) /
+      kTriangleVerticesCount;
+  for (size_t i = 0; i < trianglesCount; ++i)
+  {
+    std::array<glm::vec4, kTriangleVerticesCount> clipTriangle;
+    for (size_t corner = 0; corner < kTriangleVerticesCount; ++corner)
+    {
+      const auto index = i * kTriangleVerticesCount + corner;
+      const auto& position =
+          vertices[indices.empty() ? index : indices[index]].position;
+      clipTriangle[corner] = clipTransform * glm::vec4(position, 1.f);
+    }
+
+    std::array<glm::vec4, kTriangleVerticesCount + 1> polygon;
+    const auto polygonSize = clipAgainstNearPlane(clipTriangle, polygon);
+    if (polygonSize < kTriangleVerticesCount)
+    {
+      continue;
+    }
+    const auto first = toWindowSpace(polygon[0], size);
+    auto previous = toWindowSpace(polygon[1], size);
+    for (size_t j = 2; j < polygonSize; ++j)
+    {
+      const auto current = toWindowSpace(polygon[j], size);
+      addTriangle({ { first, previous, current } });
+      previous = current;
+    }
+  }
+}
+
+void OcclusionBuffer::addTriangle(const Triangle& triangle)
+{
+  const auto& [v0, v1, v2] = triangle.vertices;
+  if (EdgeFunction(v0, v1)(v2.x, v2.y) == 0.f)
+  {
+    return;
+  }
+
+  // Clamped as floats first, far outside of the buffer the coordinates
+  // don't fit into an int
+  const auto toTile = [](float coordinate, int tileSize, int tilesCount)
+  {
+    const auto clamped = std::clamp(
+        coordinate, 0.f, static_cast<float>(tileSize * tilesCount - 1));
+    return static_cast<int>(clamped) / tileSize;
+  };
+  const auto minimumX = std::min({ v0.x, v1.x, v2.x });
+  const auto maximumX = std::max({ v0.x, v1.x, v2.x });
+  const auto minimumY = std::min({ v0.y, v1.y, v2.y });
+  const auto maximumY = std::max({ v0.y, v1.y, v2.y });
+  if (maximumX < 0.f || maximumY < 0.f ||
+      minimumX > static_cast<float>(kWidth) ||
+      minimumY > static_cast<float>(height_))
+  {
+    return;
+  }
+
+  const auto triangleIndex = static_cast<uint32_t>(triangles_.size());
+  triangles_.push_back(triangle);
+  const auto tileX0 = toTile(minimumX, kTileWidth, tilesX_);
+  const auto tileX1 = toTile(maximumX, kTileWidth, tilesX_);
+  const auto tileY0 = toTile(minimumY, kTileHeight, tilesY_);
+  const auto tileY1 = toTile(maximumY, kTileHeight, tilesY_);
+  for (auto tileY = tileY0; tileY <= tileY1; ++tileY)
+  {
+    for (auto tileX = tileX0; tileX <= tileX1; ++tileX)
+    {
+      tilesTriangles_[static_cast<size_t>(tileY * tilesX_ + tileX)].push_back(
+          triangleIndex);
+    }
+  }
+}
+
+void OcclusionBuffer::rasterize()
+{
+  getThreadPool().parallelFor(
+      static_cast<size_t>(tilesX_ * tilesY_),
+      [this](size_t tile)
+      {
+        const auto tileIndex = static_cast<int>(tile);
+        rasterizeTile(tileIndex % tilesX_, tileIndex / tilesX_);
+      });
+}
+
+// Pixels are covered when their centers are inside of a triangle, from
+// either side. The depth is interpolated as a plane over the window space,
+// built from the edge functions which are the barycentric coordinates scaled
+// by the doubled area.
+void OcclusionBuffer::rasterizeTile(int tileX, int tileY)
+{
+  const auto tileX0 = tileX * kTileWidth;
+  const auto tileY0 = tileY * kTileHeight;
+  const auto tileIndex = static_cast<size_t>(tileY * tilesX_ + tileX);
+  for (const auto triangleIndex : tilesTriangles_[tileIndex])
+  {
+    auto [v0, v1, v2] = triangles_[triangleIndex].vertices;
+    if (EdgeFunction(v0, v1)(v2.x, v2.y) < 0.f)
+    {
+      std::swap(v1, v2);
+    }
+    const EdgeFunction edge0(v1, v2);
+    const EdgeFunction edge1(v2, v0);
+    const EdgeFunction edge2(v0, v1);
+    const auto inverseArea = 1.f / edge2(v2.x, v2.y);
+    const auto depthA =
+        (edge0.a * v0.z + edge1.a * v1.z + edge2.a * v2.z) * inverseArea;
+    const auto depthB =
+        (edge0.b * v0.z + edge1.b * v1.z + edge2.b * v2.z) * inverseArea;
+    const auto depthC =
+        (edge0.c * v0.z + edge1.c * v1.z + edge2.c * v2.z) * inverseArea;
+
+    const auto clampX = [tileX0](float x)
+    {
+      return static_cast<int>(std::clamp(
+          x,
+          static_cast<float>(tileX0),
+          static_cast<float>(tileX0 + kTileWidth - 1)));
+    };
+    const auto clampY = [tileY0](float y)
+    {
+      return static_cast<int>(std::clamp(
+          y,
+          static_cast<float>(tileY0),
+          static_cast<float>(tileY0 + kTileHeight - 1)));
+    };
+    // Batches start at multiples of their size, the edge functions reject
+    // the pixels of a batch outside of the triangle
+    const auto x0 =
+        clampX(std::min({ v0.x, v1.x, v2.x })) / kPixelsBatchSize *
+        kPixelsBatchSize;
+    const auto x1 = clampX(std::max({ v0.x, v1.x, v2.x }));
+    const auto y0 = clampY(std::min({ v0.y, v1.y, v2.y }));
+    const auto y1 = clampY(std::max({ v0.y, v1.y, v2.y }));
+    for (auto y = y0; y <= y1; ++y)
+    {
+      const auto pixelY = static_cast<float>(y) + 0.5f;
+      auto* row = depths_.data() + static_cast<size_t>(y * kWidth);
+      for (auto x = x0; x <= x1; x += kPixelsBatchSize)
+      {
+        const auto pixelX = static_cast<float>(x) + 0.5f;
+#if defined(__SSE2__) || defined(_M_X64)
+        const __m128 pixelsX = _mm_add_ps(
+            _mm_set1_ps(pixelX), _mm_setr_ps(0.f, 1.f, 2.f, 3.f));
+        const auto evaluate = [&pixelsX, pixelY](float a, float b, float c)
+        {
+          return _mm_add_ps(
+              _mm_mul_ps(_mm_set1_ps(a), pixelsX), _mm_set1_ps(b * pixelY + c));
+        };
+        const __m128 inside = _mm_and_ps(
+            _mm_cmpge_ps(
+                evaluate(edge0.a, edge0.b, edge0.c), _mm_setzero_ps()),
+            _mm_and_ps(
+                _mm_cmpge_ps(
+                    evaluate(edge1.a, edge1.b, edge1.c), _mm_setzero_ps()),
+                _mm_cmpge_ps(
+                    evaluate(edge2.a, edge2.b, edge2.c), _mm_setzero_ps())));
+        const __m128 depth = evaluate(depthA, depthB, depthC);
+        const __m128 previousDepth = _mm_loadu_ps(row + x);
+        _mm_storeu_ps(
+            row + x,
+            _mm_or_ps(
+                _mm_and_ps(inside, _mm_min_ps(previousDepth, depth)),
+                _mm_andnot_ps(inside, previousDepth)));
+#else
+        for (int i = 0; i < kPixelsBatchSize; ++i)
+        {
+          const auto pixelCenterX = pixelX + static_cast<float>(i);
+          if (edge0(pixelCenterX, pixelY) >= 0.f &&
+              edge1(pixelCenterX, pixelY) >= 0.f &&
+              edge2(pixelCenterX, pixelY) >= 0.f)
+          {
+            row[x + i] = std::min(
+                row[x + i], depthA * pixelCenterX + depthB * pixelY + depthC);
+          }
+        }
+#endif
+      }
+    }
+  }
+
+  auto tileDepth = 0.f;
+  for (auto blockY = tileY * kTileBlocksY; blockY < (tileY + 1) * kTileBlocksY;
+       ++blockY)
+  {
+    for (auto blockX = tileX * kTileBlocksX;
+         blockX < (tileX + 1) * kTileBlocksX;
+         ++blockX)
+    {
+      auto blockDepth = 0.f;
+      for (auto y = blockY * kBlockSize; y < (blockY + 1) * kBlockSize; ++y)
+      {
+        const auto* row = depths_.data() + static_cast<size_t>(y * kWidth);
+        blockDepth = std::max(
+            blockDepth,
+            *std::max_element(
+                row + blockX * kBlockSize, row + (blockX + 1) * kBlockSize));
+      }
+      blocksDepths_[static_cast<size_t>(blockY * kBlocksX + blockX)] =
+          blockDepth;
+      tileDepth = std::max(tileDepth, blockDepth);
+    }
+  }
+  tilesDepths_[tileIndex] = tileDepth;
+}
+
+// The box is tested as its window space bounding rectangle at the depth of
+// its nearest corner. It's visible where any tile and then any block under
+// the rectangle has its farthest depth behind that.
+bool OcclusionBuffer::isVisible(
+    const AxisAlignedBox& box,
+    const glm::mat4x4& clipTransform) const
+{
+  if (depths_.empty())
+  {
+    return true;
+  }
+
+  const auto size = getSize();
+  auto minimum = glm::vec3(std::numeric_limits<float>::max());
+  auto maximum = glm::vec3(std::numeric_limits<float>::lowest());
+  for (int corner = 0; corner < 8; ++corner)
+  {
+    const glm::vec3 position{
+      (corner & 1) != 0 ? box.maximum.x : box.minimum.x,
+      (corner & 2) != 0 ? box.maximum.y : box.minimum.y,
+      (corner & 4) != 0 ? box.maximum.z : box.minimum.z
+    };
+    const auto clipPosition = clipTransform * glm::vec4(position, 1.f);
+    // Boxes crossing the near plane are close enough to the camera not to
+    // be worth testing
+    if (clipPosition.z < -clipPosition.w)
+    {
+      return true;
+    }
+    const auto windowPosition = toWindowSpace(clipPosition, size);
+    minimum = glm::min(minimum, windowPosition);
+    maximum = glm::max(maximum, windowPosition);
+  }
+  if (maximum.x < 0.f || maximum.y < 0.f ||
+      minimum.x > static_cast<float>(size.width) ||
+      minimum.y > static_cast<float>(size.height))
+  {
+    return false;
+  }
+
+  const auto toBlock = [](float coordinate, int pixelsCount)
+  {
+    return static_cast<int>(std::clamp(
+               coordinate, 0.f, static_cast<float>(pixelsCount - 1))) /
+           kBlockSize;
+  };
+  const auto blockX0 = toBlock(minimum.x, size.width);
+  const auto blockX1 = toBlock(maximum.x, size.width);
+  const auto blockY0 = toBlock(minimum.y, size.height);
+  const auto blockY1 = toBlock(maximum.y, size.height);
+  for (auto tileY = blockY0 / kTileBlocksY; tileY <= blockY1 / kTileBlocksY;
+       ++tileY)
+  {
+    for (auto tileX = blockX0 / kTileBlocksX;
+         tileX <= blockX1 / kTileBlocksX;
+         ++tileX)
+    {
+      if (tilesDepths_[static_cast<size_t>(tileY * tilesX_ + tileX)] <
+          minimum.z)
+      {
+        continue;
+      }
+      for (auto blockY = std::max(blockY0, tileY * kTileBlocksY);
+           blockY <= std::min(blockY1, (tileY + 1) * kTileBlocksY - 1);
+           ++blockY)
+      {
+        for (auto blockX = std::max(blockX0, tileX * kTileBlocksX);
+             blockX <= std::min(blockX1, (tileX + 1) * kTileBlocksX - 1);
+             ++blockX)
+        {
+          if (blocksDepths_[static_cast<size_t>(blockY * kBlocksX + blockX)] >=
+              minimum.z)
+          {
+            return true;
+          }
+        }
+      }
+    }
+  }
+  return false;
+}
+
+}  // namespace Simple3D
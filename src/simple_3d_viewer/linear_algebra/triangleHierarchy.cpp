@@ -0,0 +1,343 @@
+#include <algorithm>
+#include <cstddef>
+#include <glm/geometric.hpp>
+#include <limits>
+#include <simple_3d_viewer/linear_algebra/boundingVolumeHierarchy.hpp>
+#include <simple_3d_viewer/linear_algebra/triangleHierarchy.hpp>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace Simple3D
+{
+
+namespace
+{
+
+constexpr size_t kTriangleVerticesCount = 3;
+
+// Möller and Trumbore, "Fast, Minimum Storage Ray/Triangle Intersection"
+std::optional<TriangleHierarchy::Hit> intersectTriangle(
+    const glm::vec3& vertex,
+    const glm::vec3& edge1,
+    const glm::vec3& edge2,
+    const Ray& ray,
+    float maxDistance)
+{
+  const auto p = glm::cross(ray.direction, edge2);
+  const auto determinant = glm::dot(edge1, p);
+  // The ray is parallel to the plane of the triangle
+  if (determinant == 0.f)
+  {
+    return std::nullopt;
+  }
+
+  const auto inverseDeterminant = 1.f / determinant;
+  const auto t = ray.origin - vertex;
+  const auto u = glm::dot(t, p) * inverseDeterminant;
+  if (u < 0.f || u > 1.f)
+  {
+    return std::nullopt;
+  }
+  const auto q = glm::cross(t, edge1);
+  const auto v = glm::dot(ray.direction, q) * inverseDeterminant;
+  if (v < 0.f || u + v > 1.f)
+  {
+    return std::nullopt;
+  }
+  const auto distance = glm::dot(edge2, q) * inverseDeterminant;
+  if (distance < 0.f || distance > maxDistance)
+  {
+    return std::nullopt;
+  }
+  return TriangleHierarchy::Hit{ distance, 0, u, v };
+}
+
+}  // namespace
+
+TriangleHierarchy::TriangleHierarchy(
+    std::span<const Vertex> vertices,
+    std::span<const uint32_t> indices)
+{
+  const auto trianglesCount =
+      (indices.empty() ? vertices.size() : indices.size()) /
+      kTriangleVerticesCount;
+  if (trianglesCount == 0)
+  {
+    return;
+  }
+
+  const auto getPosition = [&](size_t triangle, size_t corner)
+  {
+    const auto i = triangle * kTriangleVerticesCount + corner;
+    return vertices[indices.empty() ? i : indices[i]].position;
+  };
+  std::vector<AxisAlignedBox> boxes(trianglesCount);
+  for (size_t i = 0; i < trianglesCount; ++i)
+  {
+    boxes[i] = AxisAlignedBox::createEmpty();
+    for (size_t corner = 0; corner < kTriangleVerticesCount; ++corner)
+    {
+      boxes[i].expand(getPosition(i, corner));
+    }
+  }
+
+  const BoundingVolumeHierarchy hierarchy(boxes);
+  triangleIndices_ = hierarchy.getPrimitiveIndices();
+  triangles_.reserve(trianglesCount);
+  for (const auto triangle : triangleIndices_)
+  {
+    const auto vertex = getPosition(triangle, 0);
+    triangles_.push_back({ vertex,
+                           getPosition(triangle, 1) - vertex,
+                           getPosition(triangle, 2) - vertex });
+  }
+
+  // Every node takes the children of its binary node and keeps replacing the
+  // inner child with the largest surface area by its own children, until it
+  // has all of its slots filled or only leaves are left
+  const auto& binaryNodes = hierarchy.getNodes();
+  struct CollapseTask
+  {
+    uint32_t binaryNodeIndex;
+    uint32_t nodeIndex;
+  };
+  std::vector<CollapseTask> tasks{ { 0, 0 } };
+  nodes_.emplace_back();
+  while (!tasks.empty())
+  {
+    const auto [binaryNodeIndex, nodeIndex] = tasks.back();
+    tasks.pop_back();
+
+    std::array<uint32_t, kWidth> children{ binaryNodeIndex };
+    size_t childrenCount = 1;
+    if (const auto& binaryNode = binaryNodes[binaryNodeIndex];
+        !binaryNode.isLeaf())
+    {
+      children[0] = binaryNode.firstChildOrPrimitive;
+      children[1] = binaryNode.firstChildOrPrimitive + 1;
+      childrenCount = 2;
+    }
+    while (childrenCount < kWidth)
+    {
+      std::optional<size_t> largest;
+      float largestArea = 0.f;
+      for (size_t i = 0; i < childrenCount; ++i)
+      {
+        const auto& child = binaryNodes[children[i]];
+        const auto area = child.box.getSurfaceArea();
+        if (!child.isLeaf() && (!largest.has_value() || area > largestArea))
+        {
+          largest = i;
+          largestArea = area;
+        }
+      }
+      if (!largest.has_value())
+      {
+        break;
+      }
+      const auto firstChild =
+          binaryNodes[children[*largest]].firstChildOrPrimitive;
+      children[*largest] = firstChild;
+      children[childrenCount++] = firstChild + 1;
+    }
+
+    Node node{};
+    node.minimumX.fill(std::numeric_limits<float>::max());
+    node.minimumY.fill(std::numeric_limits<float>::max());
+    node.minimumZ.fill(std::numeric_limits<float>::max());
+    node.maximumX.fill(std::numeric_limits<float>::lowest());
+    node.maximumY.fill(std::numeric_limits<float>::lowest());
+    node.maximumZ.fill(std::numeric_limits<float>::lowest());
+    for (size_t i = 0; i < childrenCount; ++i)
+    {
+      const auto& child = binaryNodes[children[i]];
+      node.minimumX[i] = child.box.minimum.x;
+      node.minimumY[i] = child.box.minimum.y;
+      node.minimumZ[i] = child.box.minimum.z;
+      node.maximumX[i] = child.box.maximum.x;
+      node.maximumY[i] = child.box.maximum.y;
+      node.maximumZ[i] = child.box.maximum.z;
+      if (child.isLeaf())
+      {
+        node.children[i] = child.firstChildOrPrimitive;
+        node.trianglesCount[i] = child.primitivesCount;
+        continue;
+      }
+      node.children[i] = static_cast<uint32_t>(nodes_.size());
+      nodes_.emplace_back();
+      tasks.push_back({ children[i], node.children[i] });
+    }
+    nodes_[nodeIndex] = node;
+  }
+}
+
+std::optional<TriangleHierarchy::Hit> TriangleHierarchy::intersectClosest(
+    const Ray& ray,
+    float maxDistance) const
+{
+  return traverse<false>(ray, maxDistance);
+}
+
+bool TriangleHierarchy::intersectAny(const Ray& ray, float maxDistance) const
+{
+  return traverse<true>(ray, maxDistance).has_value();
+}
+
+// The slab test of BoundingVolumeHierarchy, but with the near and the far
+// planes picked by the signs of the direction instead of by comparing the
+// distances to them. That keeps the inverted boxes of unused children
+// missed. Distances to the planes a ray lies on are NaNs, the minimums and
+// maximums are ordered so these get dropped.
+template<bool kAnyHit>
+std::optional<TriangleHierarchy::Hit> TriangleHierarchy::traverse(
+    const Ray& ray,
+    float maxDistance) const
+{
+  if (nodes_.empty())
+  {
+    return std::nullopt;
+  }
+
+  const auto inverseDirection = 1.f / ray.direction;
+  const bool negativeX = inverseDirection.x < 0.f;
+  const bool negativeY = inverseDirection.y < 0.f;
+  const bool negativeZ = inverseDirection.z < 0.f;
+
+  struct Entry
+  {
+    uint32_t child;
+    uint32_t trianglesCount;
+    float distance;
+  };
+  // Reused between the queries of a thread, so they don't allocate
+  thread_local std::vector<Entry> stack;
+  stack.clear();
+  stack.push_back({ 0, 0, 0.f });
+
+  std::optional<Hit> closestHit;
+  auto closestDistance = maxDistance;
+  while (!stack.empty())
+  {
+    const auto entry = stack.back();
+    stack.pop_back();
+    if (entry.distance > closestDistance)
+    {
+      continue;
+    }
+
+    if (entry.trianglesCount > 0)
+    {
+      for (auto i = entry.child; i < entry.child + entry.trianglesCount; ++i)
+      {
+        const auto& triangle = triangles_[i];
+        auto hit = intersectTriangle(
+            triangle.vertex,
+            triangle.edge1,
+            triangle.edge2,
+            ray,
+            closestDistance);
+        if (!hit.has_value())
+        {
+          continue;
+        }
+        hit->triangleIndex = triangleIndices_[i];
+        if constexpr (kAnyHit)
+        {
+          return hit;
+        }
+        closestDistance = hit->distance;
+        closestHit = hit;
+      }
+      continue;
+    }
+
+    const auto& node = nodes_[entry.child];
+    const auto& nearX = negativeX ? node.maximumX : node.minimumX;
+    const auto& farX = negativeX ? node.minimumX : node.maximumX;
+    const auto& nearY = negativeY ? node.maximumY : node.minimumY;
+    const auto& farY = negativeY ? node.minimumY : node.maximumY;
+    const auto& nearZ = negativeZ ? node.maximumZ : node.minimumZ;
+    const auto& farZ = negativeZ ? node.minimumZ : node.maximumZ;
+    alignas(16) std::array<float, kWidth> entryDistances{};
+    unsigned int hitMask = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+    const __m128 originX = _mm_set1_ps(ray.origin.x);
+    const __m128 originY = _mm_set1_ps(ray.origin.y);
+    const __m128 originZ = _mm_set1_ps(ray.origin.z);
+    const __m128 inverseX = _mm_set1_ps(inverseDirection.x);
+    const __m128 inverseY = _mm_set1_ps(inverseDirection.y);
+    const __m128 inverseZ = _mm_set1_ps(inverseDirection.z);
+    const auto getDistances = [](const std::array<float, kWidth>& planes,
+                                 __m128 origin,
+                                 __m128 inverse)
+    {
+      return _mm_mul_ps(
+          _mm_sub_ps(_mm_load_ps(planes.data()), origin), inverse);
+    };
+    // _mm_max_ps and _mm_min_ps return the second operand for NaNs
+    const __m128 entryDistance = _mm_max_ps(
+        getDistances(nearX, originX, inverseX),
+        _mm_max_ps(
+            getDistances(nearY, originY, inverseY),
+            _mm_max_ps(
+                getDistances(nearZ, originZ, inverseZ), _mm_setzero_ps())));
+    const __m128 exitDistance = _mm_min_ps(
+        getDistances(farX, originX, inverseX),
+        _mm_min_ps(
+            getDistances(farY, originY, inverseY),
+            _mm_min_ps(
+                getDistances(farZ, originZ, inverseZ),
+                _mm_set1_ps(closestDistance))));
+    _mm_store_ps(entryDistances.data(), entryDistance);
+    hitMask = static_cast<unsigned int>(
+        _mm_movemask_ps(_mm_cmple_ps(entryDistance, exitDistance)));
+#else
+    for (size_t i = 0; i < kWidth; ++i)
+    {
+      // std::max and std::min return the first operand for NaNs
+      auto entryDistance = 0.f;
+      auto exitDistance = closestDistance;
+      entryDistance = std::max(
+          entryDistance, (nearZ[i] - ray.origin.z) * inverseDirection.z);
+      entryDistance = std::max(
+          entryDistance, (nearY[i] - ray.origin.y) * inverseDirection.y);
+      entryDistance = std::max(
+          entryDistance, (nearX[i] - ray.origin.x) * inverseDirection.x);
+      exitDistance = std::min(
+          exitDistance, (farZ[i] - ray.origin.z) * inverseDirection.z);
+      exitDistance = std::min(
+          exitDistance, (farY[i] - ray.origin.y) * inverseDirection.y);
+      exitDistance = std::min(
+          exitDistance, (farX[i] - ray.origin.x) * inverseDirection.x);
+      entryDistances[i] = entryDistance;
+      hitMask |= (entryDistance <= exitDistance ? 1u : 0u) << i;
+    }
+#endif
+
+    // Pushed from the farthest so the nearest child is visited first
+    std::array<Entry, kWidth> hitChildren{};
+    size_t hitChildrenCount = 0;
+    for (size_t i = 0; i < kWidth; ++i)
+    {
+      if (((hitMask >> i) & 1u) != 0)
+      {
+        hitChildren[hitChildrenCount++] = { node.children[i],
+                                            node.trianglesCount[i],
+                                            entryDistances[i] };
+      }
+    }
+    std::sort(
+        hitChildren.begin(),
+        hitChildren.begin() + static_cast<std::ptrdiff_t>(hitChildrenCount),
+        [](const Entry& first, const Entry& second)
+        { return first.distance > second.distance; });
+    stack.insert(
+        stack.end(),
+        hitChildren.begin(),
+        hitChildren.begin() + static_cast<std::ptrdiff_t>(hitChildrenCount));
+  }
+  return closestHit;
+}
+
+}  // namespace Simple3D
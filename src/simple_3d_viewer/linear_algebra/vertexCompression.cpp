@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <simple_3d_viewer/linear_algebra/vertexCompression.hpp>
+
+namespace Simple3D
+{
+
+namespace
+{
+
+float signNotZero(float value)
+{
+  return value >= 0.f ? 1.f : -1.f;
+}
+
+}  // namespace
+
+PositionQuantization calculatePositionQuantization(
+    std::span<const Vertex> vertices)
+{
+  if (vertices.empty())
+  {
+    return {};
+  }
+
+  glm::vec3 minimum(std::numeric_limits<float>::max());
+  glm::vec3 maximum(std::numeric_limits<float>::lowest());
+  for (const auto& vertex : vertices)
+  {
+    minimum = glm::min(minimum, vertex.position);
+    maximum = glm::max(maximum, vertex.position);
+  }
+
+  // Flat meshes have a zero extent along some axis, any scale decodes those
+  // positions correctly as the quantized value is always zero
+  const auto extent = maximum - minimum;
+  return { glm::vec3(
+               extent.x > 0.f ? extent.x : 1.f,
+               extent.y > 0.f ? extent.y : 1.f,
+               extent.z > 0.f ? extent.z : 1.f),
+           minimum };
+}
+
+// https://jcgt.org/published/0003/02/01/
+glm::vec2 encodeOctahedral(glm::vec3 normal)
+{
+  const auto manhattanLength =
+      std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+  if (manhattanLength == 0.f)
+  {
+    return { 0.f, 0.f };
+  }
+
+  normal /= manhattanLength;
+  if (normal.z >= 0.f)
+  {
+    return { normal.x, normal.y };
+  }
+  return { (1.f - std::abs(normal.y)) * signNotZero(normal.x),
+           (1.f - std::abs(normal.x)) * signNotZero(normal.y) };
+}
+
+}  // namespace Simple3D
@@ -3,9 +3,13 @@
 #include <GLFW/glfw3.h>
 
 #include <filesystem>
+#include <simple_3d_viewer/FrameSnapshot.hpp>
 #include <simple_3d_viewer/ImGuiWrapper.hpp>
 #include <simple_3d_viewer/Mediator.hpp>
+#include <simple_3d_viewer/RenderThread.hpp>
 #include <simple_3d_viewer/Viewer.hpp>
+#include <simple_3d_viewer/ViewerControls.hpp>
+#include <simple_3d_viewer/utils/Profiler.hpp>
 #include <simple_3d_viewer/utils/glfwUtils.hpp>
 
 int main()
@@ -41,36 +45,76 @@ int main()
     glfwTerminate();
     return -1;
   }
-  glfwSwapInterval(1);
+  SIMPLE3D_PROFILE_THREAD("Main");
 
-  std::vector<std::string> supportedPostprocesses = { "FXAA",
-                                                      "inversion",
-                                                      "grayscale" };
-  Simple3D::ImGuiWrapper imGuiWrapper(window, supportedPostprocesses);
-  Simple3D::Viewer viewer(window, supportedPostprocesses);
-  Simple3D::Mediator::setupCommunication(imGuiWrapper, viewer);
-
-  double previousTime = 0;
-  double currentTime = glfwGetTime();
-  while (glfwWindowShouldClose(window) == 0)
+  // The objects of the context are destroyed at the end of the scope, on this
+  // thread and before the window and the context go
   {
-    previousTime = currentTime;
-    currentTime = glfwGetTime();
-    const auto delta = currentTime - previousTime;
+    std::vector<std::string> supportedPostprocesses = { "FXAA",
+                                                        "inversion",
+                                                        "grayscale" };
+    // The controls install their window callbacks first, so ImGui chains them
+    Simple3D::ViewerControls viewerControls(window);
+    Simple3D::ImGuiWrapper imGuiWrapper(window, supportedPostprocesses);
+    auto& redrawScheduler = viewerControls.getRedrawScheduler();
+    Simple3D::Viewer viewer(window, supportedPostprocesses, redrawScheduler);
+    Simple3D::Mediator::setupCommunication(
+        imGuiWrapper, viewerControls, viewer);
+    // From here on the context belongs to the render thread
+    Simple3D::RenderThread renderThread(window, viewer);
 
-    imGuiWrapper.update();
-    viewer.processInput(static_cast<float>(delta));
+    double previousTime = 0;
+    double currentTime = glfwGetTime();
+    while (glfwWindowShouldClose(window) == 0)
+    {
+      // The snapshot is written over only once the render thread took the
+      // previous one
+      renderThread.waitForSnapshotTaken();
+      {
+        SIMPLE3D_PROFILE_ZONE("glfwPollEvents");
+        glfwPollEvents();
+      }
 
-    const auto framebufferSize = Simple3D::getFramebufferSize(window);
-    viewer.render(framebufferSize);
-    imGuiWrapper.render();
+      // Nothing is drawn into a minimized window, on some platforms it only
+      // has an empty framebuffer
+      const auto framebufferSize = Simple3D::getFramebufferSize(window);
+      if (glfwGetWindowAttrib(window, GLFW_ICONIFIED) != 0 ||
+          framebufferSize.width <= 0 || framebufferSize.height <= 0)
+      {
+        glfwWaitEvents();
+        currentTime = glfwGetTime();
+        continue;
+      }
 
-    glfwSwapBuffers(window);
-    glfwPollEvents();
-  }
+      if (redrawScheduler.getRedraw() ==
+          Simple3D::RedrawScheduler::Redraw::None)
+      {
+        redrawScheduler.waitForEvents();
+        // The camera doesn't move by the time spent waiting
+        currentTime = glfwGetTime();
+        continue;
+      }
+
+      SIMPLE3D_PROFILE_ZONE("Frame");
+      const auto inputTime = Simple3D::FrameSnapshot::Clock::now();
+      previousTime = currentTime;
+      currentTime = glfwGetTime();
+      const auto delta = currentTime - previousTime;
 
+      imGuiWrapper.update();
+      viewerControls.processInput(static_cast<float>(delta));
+
+      auto& snapshot = renderThread.getSnapshotToWrite();
+      viewerControls.writeSnapshot(snapshot, framebufferSize, inputTime);
+      imGuiWrapper.finishFrame(snapshot.gui);
+      renderThread.publishSnapshot();
+    }
+
+    // Gives the context back to this thread
+    renderThread.stop();
+  }
   glfwDestroyWindow(window);
   glfwTerminate();
 
   return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,729 @@
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <array>
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <glm/gtc/matrix_transform.hpp>
+#include <memory>
+#include <random>
+#include <simple_3d_viewer/linear_algebra/Transform.hpp>
+#include <simple_3d_viewer/linear_algebra/boundingVolumeHierarchy.hpp>
+#include <simple_3d_viewer/linear_algebra/frustumCulling.hpp>
+#include <simple_3d_viewer/linear_algebra/meshGeneration.hpp>
+#include <simple_3d_viewer/linear_algebra/occlusionCulling.hpp>
+#include <simple_3d_viewer/linear_algebra/triangleHierarchy.hpp>
+#include <simple_3d_viewer/opengl_object_wrappers/Program.hpp>
+#include <simple_3d_viewer/rendering/Material.hpp>
+#include <simple_3d_viewer/rendering/Model.hpp>
+#include <simple_3d_viewer/rendering/ModelCache.hpp>
+#include <simple_3d_viewer/rendering/PostprocessPipeline.hpp>
+#include <simple_3d_viewer/utils/HeadlessContext.hpp>
+#include <simple_3d_viewer/utils/constants.hpp>
+#include <simple_3d_viewer/utils/factories.hpp>
+#include <simple_3d_viewer/utils/fileOperations.hpp>
+#include <string>
+#include <vector>
+
+// Benchmarks of the CPU side hot paths. The inputs are generated, the only
+// files read are the shaders from the resources. Whatever needs OpenGL runs
+// in a headless context, which llvmpipe provides without a GPU, and is
+// skipped when there is none. Results go to microbench.json unless
+// --benchmark_out says otherwise.
+
+namespace Simple3D
+{
+
+namespace
+{
+
+constexpr Size kFramebufferSize{ 1280, 720 };
+// Same seed every run, so the runs measure the same inputs
+constexpr uint32_t kSeed = 42;
+
+bool hasContext(benchmark::State& state)
+{
+  static const auto context = []() -> std::unique_ptr<HeadlessContext>
+  {
+    try
+    {
+      return std::make_unique<HeadlessContext>();
+    }
+    catch (std::exception& e)
+    {
+      fmt::println(stderr, "No OpenGL benchmarks: {}", e.what());
+      return nullptr;
+    }
+  }();
+  if (context == nullptr)
+  {
+    state.SkipWithError("No OpenGL context");
+    return false;
+  }
+  return true;
+}
+
+const std::filesystem::path& getDataDirPath()
+{
+  static const auto result = []()
+  {
+    auto path = std::filesystem::temp_directory_path() / "simple3d_microbench";
+    std::filesystem::create_directories(path);
+    return path;
+  }();
+  return result;
+}
+
+// Square in the xz plane from (0, 0) to (1, 1) made of cellsCount^2 quads,
+// with the heights given by the function
+template<typename HeightFunction>
+void createGrid(
+    const uint32_t cellsCount,
+    const HeightFunction& height,
+    std::vector<Vertex>& vertices,
+    std::vector<uint32_t>& indices)
+{
+  const auto rowSize = cellsCount + 1;
+  const auto firstVertex = static_cast<uint32_t>(vertices.size());
+  for (uint32_t z = 0; z < rowSize; ++z)
+  {
+    for (uint32_t x = 0; x < rowSize; ++x)
+    {
+      Vertex vertex{};
+      vertex.texCoords[0] = {
+        static_cast<float>(x) / static_cast<float>(cellsCount),
+        static_cast<float>(z) / static_cast<float>(cellsCount)
+      };
+      vertex.position = { vertex.texCoords[0].x,
+                          height(vertex.texCoords[0].x, vertex.texCoords[0].y),
+                          vertex.texCoords[0].y };
+      vertex.normal = { 0.f, 1.f, 0.f };
+      vertices.push_back(vertex);
+    }
+  }
+  for (uint32_t z = 0; z < cellsCount; ++z)
+  {
+    for (uint32_t x = 0; x < cellsCount; ++x)
+    {
+      const auto corner = firstVertex + z * rowSize + x;
+      indices.insert(
+          indices.end(),
+          { corner,
+            corner + rowSize,
+            corner + 1,
+            corner + 1,
+            corner + rowSize,
+            corner + rowSize + 1 });
+    }
+  }
+}
+
+float getFlatHeight(float /*x*/, float /*z*/)
+{
+  return 0.f;
+}
+
+float getBumpyHeight(float x, float z)
+{
+  return 0.05f * std::sin(x * 40.f) * std::cos(z * 40.f);
+}
+
+std::vector<AxisAlignedBox> createBoxes(const size_t count)
+{
+  std::minstd_rand generator(kSeed);
+  std::uniform_real_distribution<float> position(-100.f, 100.f);
+  std::uniform_real_distribution<float> extent(0.1f, 2.f);
+  std::vector<AxisAlignedBox> boxes(count);
+  for (auto& box : boxes)
+  {
+    const glm::vec3 center(
+        position(generator), position(generator), position(generator));
+    const glm::vec3 extents(
+        extent(generator), extent(generator), extent(generator));
+    box = { center - extents, center + extents };
+  }
+  return boxes;
+}
+
+glm::mat4x4 createProjectionView(const glm::vec3& position)
+{
+  return calculateProjectionTransform(kFramebufferSize) *
+         glm::lookAt(
+             position, glm::vec3(0.f, 0.f, 0.f), glm::vec3(0.f, 1.f, 0.f));
+}
+
+// Every mesh is a separate object of the same small grid
+std::filesystem::path writeGridsModel(const size_t meshesCount)
+{
+  auto path = getDataDirPath() / fmt::format("grids_{}.obj", meshesCount);
+  if (std::filesystem::exists(path))
+  {
+    return path;
+  }
+
+  static constexpr uint32_t kCellsCount = 16;
+  std::vector<Vertex> vertices;
+  std::vector<uint32_t> indices;
+  createGrid(kCellsCount, getBumpyHeight, vertices, indices);
+
+  std::ofstream out(path);
+  for (size_t mesh = 0; mesh < meshesCount; ++mesh)
+  {
+    const auto offset = static_cast<float>(mesh);
+    const auto firstIndex = mesh * vertices.size() + 1;
+    out << fmt::format("o mesh_{}\n", mesh);
+    for (const auto& vertex : vertices)
+    {
+      out << fmt::format(
+          "v {} {} {}\nvt {} {}\nvn {} {} {}\n",
+          vertex.position.x + offset,
+          vertex.position.y,
+          vertex.position.z,
+          vertex.texCoords[0].x,
+          vertex.texCoords[0].y,
+          vertex.normal.x,
+          vertex.normal.y,
+          vertex.normal.z);
+    }
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+      out << 'f';
+      for (size_t j = i; j < i + 3; ++j)
+      {
+        out << fmt::format(" {0}/{0}/{0}", firstIndex + indices[j]);
+      }
+      out << '\n';
+    }
+  }
+  return path;
+}
+
+// Uncompressed 32 bit TGA, which stb_image decodes without any
+// decompression, so the measurement is the loading pipeline itself
+std::filesystem::path writeImage(const int side)
+{
+  auto path = getDataDirPath() / fmt::format("image_{}.tga", side);
+  if (std::filesystem::exists(path))
+  {
+    return path;
+  }
+
+  const auto sideLow = static_cast<char>(side & 0xFF);
+  const auto sideHigh = static_cast<char>((side >> 8) & 0xFF);
+  // Type 2 is uncompressed true color, the 8 is the alpha channel depth
+  const std::array<char, 18> header{
+    0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, sideLow, sideHigh, sideLow, sideHigh,
+    32, 8,
+  };
+  const auto sideSize = static_cast<size_t>(side);
+  std::vector<char> pixels(sideSize * sideSize * 4);
+  std::minstd_rand generator(kSeed);
+  std::ranges::generate(
+      pixels, [&generator]() { return static_cast<char>(generator()); });
+
+  std::ofstream out(path, std::ios::binary);
+  out.write(header.data(), header.size());
+  out.write(pixels.data(), static_cast<std::streamsize>(pixels.size()));
+  return path;
+}
+
+void BM_ModelProcessMeshes(benchmark::State& state)
+{
+  const auto path = writeGridsModel(static_cast<size_t>(state.range(0)));
+  const Model::Configuration configuration;
+  for (auto _ : state)
+  {
+    const Model model(path, configuration);
+    // Only the conversion of the meshes is reported, not the import
+    state.SetIterationTime(
+        model.getLoadStatistics().meshesConversionTime.count() / 1000.);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ModelProcessMeshes)
+    ->Arg(50)
+    ->Arg(500)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+// A cold load imports the model and writes its cache entry, a warm one reads
+// the entry the previous load wrote
+void BM_ModelLoad(benchmark::State& state)
+{
+  const auto path = writeGridsModel(500);
+  const auto warm = state.range(0) != 0;
+  Model::Configuration configuration;
+  configuration.set(Model::Configuration::Flag::UseModelCache, true);
+  const auto key =
+      createModelCacheKey(path, configuration.getOutputAffectingFlags());
+  if (!key.has_value())
+  {
+    state.SkipWithError("The model file can't be inspected");
+    return;
+  }
+
+  removeModelCache(*key);
+  if (warm)
+  {
+    const Model model(path, configuration);
+  }
+  for (auto _ : state)
+  {
+    if (!warm)
+    {
+      state.PauseTiming();
+      removeModelCache(*key);
+      state.ResumeTiming();
+    }
+    const Model model(path, configuration);
+    if (model.getLoadStatistics().loadedFromCache != warm)
+    {
+      state.SkipWithError(
+          warm ? "The model wasn't loaded from the cache"
+               : "The model was loaded from the cache");
+      break;
+    }
+  }
+  removeModelCache(*key);
+}
+BENCHMARK(BM_ModelLoad)
+    ->ArgName("warm")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_CalculateModelTransform(benchmark::State& state)
+{
+  Transform transform{
+    { 1.f, 2.f, 3.f }, { 0.f, 0.f, 0.f }, { 1.f, 1.f, 1.f }
+  };
+  for (auto _ : state)
+  {
+    transform.rotation.y += 0.01f;
+    benchmark::DoNotOptimize(calculateModelTransform(transform));
+  }
+}
+BENCHMARK(BM_CalculateModelTransform);
+
+void BM_SphereMesh(benchmark::State& state)
+{
+  if (!hasContext(state))
+  {
+    return;
+  }
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(sphereMesh(1.f));
+  }
+}
+BENCHMARK(BM_SphereMesh)->Unit(benchmark::kMicrosecond);
+
+void BM_MeshUpload(benchmark::State& state)
+{
+  if (!hasContext(state))
+  {
+    return;
+  }
+  std::vector<Vertex> vertices;
+  std::vector<uint32_t> indices;
+  createGrid(
+      static_cast<uint32_t>(state.range(0)), getFlatHeight, vertices, indices);
+  for (auto _ : state)
+  {
+    Mesh mesh(vertices, indices);
+    // The driver may copy lazily, the copy has to be part of the measurement
+    glFinish();
+  }
+  const auto meshSize =
+      vertices.size() * sizeof(Vertex) + indices.size() * sizeof(uint32_t);
+  state.SetBytesProcessed(
+      state.iterations() * static_cast<int64_t>(meshSize));
+}
+BENCHMARK(BM_MeshUpload)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+
+void BM_LoadImage(benchmark::State& state)
+{
+  const auto path = writeImage(static_cast<int>(state.range(0)));
+  const auto flipVertically = state.range(1) != 0;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(loadImage(path, flipVertically));
+  }
+  state.SetBytesProcessed(
+      state.iterations() * state.range(0) * state.range(0) * 4);
+}
+BENCHMARK(BM_LoadImage)
+    ->ArgsProduct({ { 512, 2048 }, { 0, 1 } })
+    ->Unit(benchmark::kMillisecond);
+
+void BM_LoadFileIntoString(benchmark::State& state)
+{
+  const auto size = static_cast<size_t>(state.range(0));
+  const auto path = getDataDirPath() / fmt::format("file_{}.txt", size);
+  if (!std::filesystem::exists(path))
+  {
+    std::ofstream(path) << std::string(size, 'x');
+  }
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(loadFileIntoString(path));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LoadFileIntoString)->Range(4 << 10, 16 << 20);
+
+// Lights as the model shader has them, each one a uniform that is looked up
+// by name
+constexpr size_t kUniformLightsCount = 16;
+
+Program createUniformsProgram()
+{
+  std::string fragmentShader =
+      "#version 330 core\nout vec4 FragColor;\nuniform float intensity;\n";
+  std::string sum = "vec3(0.0)";
+  for (size_t i = 0; i < kUniformLightsCount; ++i)
+  {
+    fragmentShader += fmt::format("uniform vec3 lightColor{};\n", i);
+    sum += fmt::format(" + lightColor{}", i);
+  }
+  fragmentShader += fmt::format(
+      "void main()\n{{\n  FragColor = vec4(intensity * ({}), 1.0);\n}}\n",
+      sum);
+  return { "#version 330 core\nvoid main()\n{\n  gl_Position = vec4(0.0);\n}\n",
+           fragmentShader };
+}
+
+std::vector<std::string> createUniformNames()
+{
+  std::vector<std::string> names;
+  for (size_t i = 0; i < kUniformLightsCount; ++i)
+  {
+    names.push_back(fmt::format("lightColor{}", i));
+  }
+  return names;
+}
+
+void BM_ProgramHasUniform(benchmark::State& state)
+{
+  if (!hasContext(state))
+  {
+    return;
+  }
+  auto program = createUniformsProgram();
+  const auto names = createUniformNames();
+  for (auto _ : state)
+  {
+    for (const auto& name : names)
+    {
+      benchmark::DoNotOptimize(program.hasUniform(name));
+    }
+  }
+  state.SetItemsProcessed(
+      state.iterations() * static_cast<int64_t>(names.size()));
+}
+BENCHMARK(BM_ProgramHasUniform);
+
+void BM_ProgramSetUniforms(benchmark::State& state)
+{
+  if (!hasContext(state))
+  {
+    return;
+  }
+  auto program = createUniformsProgram();
+  const auto names = createUniformNames();
+  for (auto _ : state)
+  {
+    program.doOperations(
+        [&names](Program& it)
+        {
+          it.setFloat("intensity", 1.f);
+          for (const auto& name : names)
+          {
+            it.setVec3f(name, 1.f, 1.f, 1.f);
+          }
+        });
+  }
+  state.SetItemsProcessed(
+      state.iterations() * static_cast<int64_t>(names.size() + 1));
+}
+BENCHMARK(BM_ProgramSetUniforms);
+
+void BM_MaterialUse(benchmark::State& state)
+{
+  if (!hasContext(state))
+  {
+    return;
+  }
+  try
+  {
+    auto program = createProgram(kModelShaderCommonName);
+    Texture texture(writeImage(64));
+    const auto texturesCount = static_cast<size_t>(state.range(0));
+    const std::vector<Material::TextureData> textures(
+        texturesCount, { &texture, std::nullopt });
+    Material material(textures, textures, textures, {}, {}, {});
+    for (auto _ : state)
+    {
+      material.use(program);
+    }
+  }
+  catch (std::exception& e)
+  {
+    state.SkipWithError(e.what());
+  }
+}
+BENCHMARK(BM_MaterialUse)->Arg(1)->Arg(4);
+
+void BM_PostprocessPipelineOrdering(benchmark::State& state)
+{
+  if (!hasContext(state))
+  {
+    return;
+  }
+  try
+  {
+    std::vector<PostprocessID> ids{ "FXAA", "inversion", "grayscale" };
+    PostprocessPipeline pipeline(ids, kFramebufferSize);
+    for (auto _ : state)
+    {
+      // Every order the postprocesses can be switched on in
+      std::ranges::next_permutation(ids);
+      for (const auto& id : ids)
+      {
+        pipeline.setPostprocessActiveFlag(id, true);
+      }
+      for (const auto& id : ids)
+      {
+        pipeline.setPostprocessActiveFlag(id, false);
+      }
+    }
+  }
+  catch (std::exception& e)
+  {
+    state.SkipWithError(e.what());
+  }
+}
+BENCHMARK(BM_PostprocessPipelineOrdering);
+
+void BM_BoundingVolumeHierarchyBuild(benchmark::State& state)
+{
+  const auto boxes = createBoxes(static_cast<size_t>(state.range(0)));
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(BoundingVolumeHierarchy(boxes));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BoundingVolumeHierarchyBuild)
+    ->RangeMultiplier(10)
+    ->Range(100, 100'000)
+    ->Unit(benchmark::kMicrosecond);
+
+// The camera sees roughly a quarter of the boxes, from outside of the cube
+// they are spread over
+void BM_BoundingVolumeHierarchyCull(benchmark::State& state)
+{
+  const auto boxes = createBoxes(static_cast<size_t>(state.range(0)));
+  const BoundingVolumeHierarchy hierarchy(boxes);
+  const auto frustum =
+      extractFrustum(createProjectionView({ 150.f, 40.f, 150.f }));
+  std::vector<uint8_t> visibility(boxes.size());
+  for (auto _ : state)
+  {
+    hierarchy.cull(frustum, visibility);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BoundingVolumeHierarchyCull)
+    ->RangeMultiplier(10)
+    ->Range(100, 100'000)
+    ->Unit(benchmark::kMicrosecond);
+
+// The flat test the hierarchy is compared against
+void BM_BoundingBoxesCull(benchmark::State& state)
+{
+  const auto boxes = createBoxes(static_cast<size_t>(state.range(0)));
+  BoundingBoxes boundingBoxes;
+  boundingBoxes.assign(boxes);
+  const auto frustum =
+      extractFrustum(createProjectionView({ 150.f, 40.f, 150.f }));
+  std::vector<uint8_t> visibility(boxes.size());
+  for (auto _ : state)
+  {
+    boundingBoxes.cull(frustum, visibility);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BoundingBoxesCull)
+    ->RangeMultiplier(10)
+    ->Range(100, 100'000)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_TriangleHierarchyBuild(benchmark::State& state)
+{
+  std::vector<Vertex> vertices;
+  std::vector<uint32_t> indices;
+  createGrid(
+      static_cast<uint32_t>(state.range(0)), getBumpyHeight, vertices, indices);
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(TriangleHierarchy(vertices, indices));
+  }
+  state.SetItemsProcessed(
+      state.iterations() * static_cast<int64_t>(indices.size() / 3));
+}
+BENCHMARK(BM_TriangleHierarchyBuild)
+    ->Arg(64)
+    ->Arg(256)
+    ->Unit(benchmark::kMillisecond);
+
+// Items are rays, from above the bumpy grid to random points of it
+template<bool kAnyHit>
+void BM_TriangleHierarchyRays(benchmark::State& state)
+{
+  std::vector<Vertex> vertices;
+  std::vector<uint32_t> indices;
+  createGrid(
+      static_cast<uint32_t>(state.range(0)), getBumpyHeight, vertices, indices);
+  const TriangleHierarchy hierarchy(vertices, indices);
+
+  static constexpr size_t kRaysCount = 4096;
+  std::minstd_rand generator(kSeed);
+  std::uniform_real_distribution<float> coordinate(0.f, 1.f);
+  std::vector<Ray> rays(kRaysCount);
+  for (auto& ray : rays)
+  {
+    ray.origin = { coordinate(generator), 1.f, coordinate(generator) };
+    ray.direction =
+        glm::vec3(coordinate(generator), 0.f, coordinate(generator)) -
+        ray.origin;
+  }
+
+  for (auto _ : state)
+  {
+    for (const auto& ray : rays)
+    {
+      if constexpr (kAnyHit)
+      {
+        benchmark::DoNotOptimize(hierarchy.intersectAny(ray, 2.f));
+      }
+      else
+      {
+        benchmark::DoNotOptimize(hierarchy.intersectClosest(ray, 2.f));
+      }
+    }
+  }
+  state.SetItemsProcessed(
+      state.iterations() * static_cast<int64_t>(rays.size()));
+}
+BENCHMARK(BM_TriangleHierarchyRays<false>)
+    ->Arg(64)
+    ->Arg(256)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TriangleHierarchyRays<true>)
+    ->Arg(64)
+    ->Arg(256)
+    ->Unit(benchmark::kMicrosecond);
+
+// Walls across the view, one behind another, so the later ones are drawn
+// over the nearer depths
+void addWallOccluders(OcclusionBuffer& buffer, const uint32_t cellsCount)
+{
+  static constexpr size_t kWallsCount = 8;
+  std::vector<Vertex> vertices;
+  std::vector<uint32_t> indices;
+  createGrid(cellsCount, getFlatHeight, vertices, indices);
+  const auto projectionView = createProjectionView({ 0.f, 0.f, 10.f });
+  for (size_t i = 0; i < kWallsCount; ++i)
+  {
+    // Stands the grid up facing the camera, scaled past the view
+    const auto transform =
+        glm::translate(
+            glm::mat4x4(1.f),
+            glm::vec3(-8.f, 8.f, -static_cast<float>(i))) *
+        glm::rotate(glm::mat4x4(1.f), glm::radians(90.f), { 1.f, 0.f, 0.f }) *
+        glm::scale(glm::mat4x4(1.f), glm::vec3(16.f, 1.f, 16.f));
+    buffer.addOccluder(vertices, indices, projectionView * transform);
+  }
+}
+
+void BM_OcclusionBufferRasterize(benchmark::State& state)
+{
+  OcclusionBuffer buffer;
+  buffer.resize(kFramebufferSize);
+  const auto cellsCount = static_cast<uint32_t>(state.range(0));
+  for (auto _ : state)
+  {
+    buffer.clear();
+    addWallOccluders(buffer, cellsCount);
+    buffer.rasterize();
+  }
+  state.counters["triangles"] =
+      static_cast<double>(buffer.getTrianglesCount());
+}
+BENCHMARK(BM_OcclusionBufferRasterize)
+    ->Arg(4)
+    ->Arg(32)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_OcclusionBufferIsVisible(benchmark::State& state)
+{
+  OcclusionBuffer buffer;
+  buffer.resize(kFramebufferSize);
+  addWallOccluders(buffer, 4);
+  buffer.rasterize();
+  const auto projectionView = createProjectionView({ 0.f, 0.f, 10.f });
+  // Boxes behind the walls, partly sticking out of them
+  std::minstd_rand generator(kSeed);
+  std::uniform_real_distribution<float> position(-10.f, 10.f);
+  std::vector<AxisAlignedBox> boxes(4096);
+  for (auto& box : boxes)
+  {
+    const glm::vec3 center(position(generator), position(generator), -20.f);
+    box = { center - 0.5f, center + 0.5f };
+  }
+  for (auto _ : state)
+  {
+    for (const auto& box : boxes)
+    {
+      benchmark::DoNotOptimize(buffer.isVisible(box, projectionView));
+    }
+  }
+  state.SetItemsProcessed(
+      state.iterations() * static_cast<int64_t>(boxes.size()));
+}
+BENCHMARK(BM_OcclusionBufferIsVisible);
+
+}  // namespace
+
+}  // namespace Simple3D
+
+int main(int argc, char** argv)
+{
+  // The defaults come first, so the same flags given on the command line
+  // override them
+  std::vector<char*> arguments{ argv[0] };
+  std::string outputArgument = "--benchmark_out=microbench.json";
+  std::string formatArgument = "--benchmark_out_format=json";
+  arguments.push_back(outputArgument.data());
+  arguments.push_back(formatArgument.data());
+  arguments.insert(arguments.end(), argv + 1, argv + argc);
+  auto argumentsCount = static_cast<int>(arguments.size());
+
+  benchmark::Initialize(&argumentsCount, arguments.data());
+  if (benchmark::ReportUnrecognizedArguments(
+          argumentsCount, arguments.data()))
+  {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,71 @@
+#include <glad/glad.h>
+
+#include <simple_3d_viewer/opengl_object_wrappers/Framebuffer.hpp>
+#include <stdexcept>
+
+namespace Simple3D
+{
+
+Framebuffer::Framebuffer(const Size size)
+{
+  glGenFramebuffers(1, &framebuffer_);
+  glGenRenderbuffers(
+      static_cast<GLsizei>(renderbuffers_.size()), renderbuffers_.data());
+  resize(size);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+  glFramebufferRenderbuffer(
+      GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers_[0]);
+  glFramebufferRenderbuffer(
+      GL_FRAMEBUFFER,
+      GL_DEPTH_STENCIL_ATTACHMENT,
+      GL_RENDERBUFFER,
+      renderbuffers_[1]);
+  const auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  if (status != GL_FRAMEBUFFER_COMPLETE)
+  {
+    release();
+    throw std::runtime_error("Framebuffer is not complete");
+  }
+}
+
+void Framebuffer::resize(const Size size)
+{
+  size_ = size;
+  glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers_[0]);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size.width, size.height);
+  glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers_[1]);
+  glRenderbufferStorage(
+      GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size.width, size.height);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+}
+
+void Framebuffer::blitTo(const uint framebuffer) const
+{
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+  glBlitFramebuffer(
+      0,
+      0,
+      size_.width,
+      size_.height,
+      0,
+      0,
+      size_.width,
+      size_.height,
+      GL_COLOR_BUFFER_BIT,
+      GL_NEAREST);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+void Framebuffer::release()
+{
+  glDeleteFramebuffers(1, &framebuffer_);
+  glDeleteRenderbuffers(
+      static_cast<GLsizei>(renderbuffers_.size()), renderbuffers_.data());
+  framebuffer_ = 0;
+  renderbuffers_ = {};
+}
+
+}  // namespace Simple3D
@@ -154,6 +154,18 @@ void Texture::loadTextures()
   }
 }
 
+size_t Texture::getPendingDataSize() const
+{
+  size_t dataSize = 0;
+  for (const auto& image : loadedImages_)
+  {
+    dataSize += static_cast<size_t>(image.size.width) *
+                static_cast<size_t>(image.size.height) *
+                static_cast<size_t>(image.colorChannelCount);
+  }
+  return dataSize;
+}
+
 void Texture::release()
 {
   if (textureHandle_ == 0)
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cmath>
 #include <glm/gtx/rotate_vector.hpp>
 #include <glm/gtx/vector_angle.hpp>
 #include <simple_3d_viewer/rendering/Camera.hpp>
@@ -6,8 +7,10 @@
 namespace Simple3D
 {
 
-void Camera::processInput(float delta, GLFWwindow* window)
+bool Camera::processInput(float delta, GLFWwindow* window)
 {
+  const auto previousPosition = position_;
+  const auto previousOrientation = orientation_;
   const auto [speed, sensitivity] = settings_;
   const float deltaSpeed = speed * delta;
   if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
@@ -81,6 +84,17 @@ void Camera::processInput(float delta, GLFWwindow* window)
   {
     firstClick_ = true;
   }
+
+  return position_ != previousPosition || orientation_ != previousOrientation;
+}
+
+void Camera::lookAt(const glm::vec3& position, const glm::vec3& target)
+{
+  position_ = position;
+  orientation_ = glm::normalize(target - position);
+  // The mouse look continues from the new orientation
+  pitch_ = glm::degrees(std::asin(orientation_.y));
+  yaw_ = glm::degrees(std::atan2(orientation_.z, orientation_.x));
 }
 
 }  // namespace Simple3D
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <cmath>
+#include <fmt/format.h>
+#include <fstream>
+#include <glm/geometric.hpp>
+#include <glm/gtc/constants.hpp>
+#include <simple_3d_viewer/rendering/CameraPath.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace Simple3D
+{
+
+namespace
+{
+
+// Distance in radii of the bounding sphere at which the sphere fits into the
+// 45 degree field of view of calculateProjectionTransform, 1 / sin(22.5)
+// rounded up
+constexpr float kOrbitDistance = 2.7f;
+// Fraction of the distance the camera is raised above the center
+constexpr float kOrbitElevation = 0.25f;
+
+}  // namespace
+
+CameraPath::CameraPath(std::vector<CameraKeyframe> keyframes)
+    : keyframes_(std::move(keyframes))
+{
+  if (keyframes_.empty())
+  {
+    throw std::invalid_argument("Camera path needs at least one keyframe");
+  }
+}
+
+CameraPath CameraPath::createOrbit(
+    const AxisAlignedBox& box,
+    const size_t keyframesCount)
+{
+  const auto center = (box.minimum + box.maximum) * 0.5f;
+  const auto radius =
+      std::max(glm::length(box.maximum - box.minimum) * 0.5f, 1e-3f);
+  const auto distance = radius * kOrbitDistance;
+
+  std::vector<CameraKeyframe> keyframes;
+  const auto count = std::max<size_t>(keyframesCount, 2);
+  for (size_t i = 0; i < count; ++i)
+  {
+    // The last keyframe closes the circle
+    const auto angle = glm::two_pi<float>() * static_cast<float>(i) /
+                       static_cast<float>(count - 1);
+    keyframes.push_back(
+        { center + glm::vec3(
+                       distance * std::sin(angle),
+                       distance * kOrbitElevation,
+                       distance * std::cos(angle)),
+          center });
+  }
+  return CameraPath(std::move(keyframes));
+}
+
+CameraPath CameraPath::load(const std::filesystem::path& filePath)
+{
+  std::ifstream in(filePath);
+  if (!in.is_open())
+  {
+    throw std::invalid_argument(fmt::format(
+        "File at path: {} doesn't exist",
+        std::filesystem::absolute(filePath).string()));
+  }
+
+  std::vector<CameraKeyframe> keyframes;
+  std::string line;
+  for (size_t lineNumber = 1; std::getline(in, line); ++lineNumber)
+  {
+    if (line.find_first_not_of(" \t\r") == std::string::npos ||
+        line.front() == '#')
+    {
+      continue;
+    }
+    std::istringstream lineStream(line);
+    CameraKeyframe keyframe{};
+    if (!(lineStream >> keyframe.position.x >> keyframe.position.y >>
+          keyframe.position.z >> keyframe.target.x >> keyframe.target.y >>
+          keyframe.target.z))
+    {
+      throw std::invalid_argument(fmt::format(
+          "Camera path {} has an invalid keyframe on line {}",
+          filePath.string(),
+          lineNumber));
+    }
+    keyframes.push_back(keyframe);
+  }
+  return CameraPath(std::move(keyframes));
+}
+
+CameraKeyframe CameraPath::sample(const float progress) const
+{
+  const auto position = std::clamp(progress, 0.f, 1.f) *
+                        static_cast<float>(keyframes_.size() - 1);
+  const auto first = std::min(
+      static_cast<size_t>(position), keyframes_.size() - 1);
+  const auto second = std::min(first + 1, keyframes_.size() - 1);
+  const auto fraction = position - static_cast<float>(first);
+  return { glm::mix(
+               keyframes_[first].position,
+               keyframes_[second].position,
+               fraction),
+           glm::mix(
+               keyframes_[first].target, keyframes_[second].target, fraction) };
+}
+
+}  // namespace Simple3D
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <simple_3d_viewer/rendering/GpuProfiler.hpp>
+
+namespace Simple3D
+{
+
+namespace
+{
+
+using Nanoseconds = std::chrono::duration<double, std::nano>;
+
+// Nearest rank of the sorted measurements
+GpuProfiler::Duration getPercentile(
+    const std::vector<GpuProfiler::Duration>& sortedMeasurements,
+    double percentile)
+{
+  const auto rank = static_cast<size_t>(std::ceil(
+      percentile * static_cast<double>(sortedMeasurements.size())));
+  return sortedMeasurements[std::max<size_t>(rank, 1) - 1];
+}
+
+}  // namespace
+
+GpuProfiler::GpuProfiler()
+{
+  GLint counterBits = 0;
+  glGetQueryiv(GL_TIME_ELAPSED, GL_QUERY_COUNTER_BITS, &counterBits);
+  supported_ = counterBits > 0;
+}
+
+void GpuProfiler::release()
+{
+  for (auto& frame : frames_)
+  {
+    glDeleteQueries(
+        static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+    frame.queries.clear();
+    frame.passes.clear();
+  }
+}
+
+void GpuProfiler::beginFrame()
+{
+  if (!supported_)
+  {
+    return;
+  }
+
+  // From the oldest one, frames finish in the order they were issued
+  for (size_t i = 1; i <= kFramesInFlight; ++i)
+  {
+    if (!collect(frames_[(currentFrame_ + i) % kFramesInFlight]))
+    {
+      break;
+    }
+  }
+
+  currentFrame_ = (currentFrame_ + 1) % kFramesInFlight;
+  if (auto& frame = frames_[currentFrame_]; !frame.passes.empty())
+  {
+    ++droppedFramesCount_;
+    frame.passes.clear();
+  }
+}
+
+void GpuProfiler::measure(
+    std::string_view pass,
+    const std::function<void()>& operations)
+{
+  if (!supported_)
+  {
+    operations();
+    return;
+  }
+
+  auto& frame = frames_[currentFrame_];
+  if (frame.passes.size() == frame.queries.size())
+  {
+    glGenQueries(1, &frame.queries.emplace_back());
+  }
+  const auto query = frame.queries[frame.passes.size()];
+  frame.passes.push_back(findPass(pass));
+
+  glBeginQuery(GL_TIME_ELAPSED, query);
+  operations();
+  glEndQuery(GL_TIME_ELAPSED);
+}
+
+std::vector<GpuProfiler::PassTimings> GpuProfiler::getTimings() const
+{
+  std::vector<PassTimings> timings;
+  std::vector<Duration> measurements;
+  for (const auto& pass : passes_)
+  {
+    if (pass.measurementsCount == 0)
+    {
+      continue;
+    }
+
+    const auto count = std::min(pass.measurementsCount, kHistorySize);
+    measurements.assign(
+        pass.history.begin(),
+        pass.history.begin() + static_cast<std::ptrdiff_t>(count));
+    std::ranges::sort(measurements);
+    const auto sum =
+        std::accumulate(measurements.begin(), measurements.end(), Duration{});
+    timings.push_back(
+        { pass.name,
+          pass.history[(pass.measurementsCount - 1) % kHistorySize],
+          sum / static_cast<double>(count),
+          getPercentile(measurements, 0.5),
+          getPercentile(measurements, 0.95),
+          getPercentile(measurements, 0.99) });
+  }
+  return timings;
+}
+
+size_t GpuProfiler::findPass(std::string_view pass)
+{
+  const auto it = std::ranges::find(passes_, pass, &Pass::name);
+  if (it != passes_.end())
+  {
+    return static_cast<size_t>(std::distance(passes_.begin(), it));
+  }
+  passes_.push_back({ std::string(pass), {}, 0 });
+  return passes_.size() - 1;
+}
+
+// Queries finish in order, so the frame is done once its last one is
+bool GpuProfiler::collect(Frame& frame)
+{
+  if (frame.passes.empty())
+  {
+    return true;
+  }
+
+  GLuint available = GL_FALSE;
+  glGetQueryObjectuiv(
+      frame.queries[frame.passes.size() - 1],
+      GL_QUERY_RESULT_AVAILABLE,
+      &available);
+  if (available == GL_FALSE)
+  {
+    return false;
+  }
+
+  Duration frameTime{};
+  for (size_t i = 0; i < frame.passes.size(); ++i)
+  {
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &elapsed);
+    auto& pass = passes_[frame.passes[i]];
+    const Duration passTime = Nanoseconds(static_cast<double>(elapsed));
+    pass.history[pass.measurementsCount % kHistorySize] = passTime;
+    ++pass.measurementsCount;
+    frameTime += passTime;
+  }
+  frame.passes.clear();
+  lastFrameTime_ = frameTime;
+  ++collectedFramesCount_;
+  return true;
+}
+
+}  // namespace Simple3D
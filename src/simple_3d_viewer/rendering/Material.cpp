@@ -1,6 +1,7 @@
 #include <cstdint>
 #include <fmt/format.h>
 #include <simple_3d_viewer/rendering/Material.hpp>
+#include <simple_3d_viewer/utils/Profiler.hpp>
 #include <sys/types.h>
 
 namespace Simple3D
@@ -109,6 +110,7 @@ void prepareTexturesForUse(Program& program, Material& material)
 
 void Material::use(Program& program)
 {
+  SIMPLE3D_PROFILE_ZONE("Material::use");
   prepareTexturesForUse(program, *this);
   setUniforms(program, *this);
 }
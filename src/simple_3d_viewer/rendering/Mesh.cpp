@@ -1,9 +1,11 @@
 #include <glad/glad.h>
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
-#include <glm/ext/vector_float3.hpp>
+#include <limits>
 #include <simple_3d_viewer/rendering/Mesh.hpp>
-#include <simple_3d_viewer/utils/constants.hpp>
+#include <vector>
 
 namespace Simple3D
 {
@@ -16,8 +18,85 @@ char* attributeOffset(GLuint value)
   return std::next(static_cast<char*>(nullptr), value);
 }
 
+void setupVertexAttributes(const VertexLayoutDescription& vertexLayout)
+{
+  for (const auto& attribute : vertexLayout.attributes)
+  {
+    glVertexAttribPointer(
+        attribute.location,
+        attribute.componentsCount,
+        attribute.componentType,
+        attribute.normalized,
+        static_cast<GLsizei>(vertexLayout.stride),
+        attributeOffset(static_cast<GLuint>(attribute.offset)));
+    glEnableVertexAttribArray(attribute.location);
+  }
+}
+
+template<typename IndexType>
+std::vector<std::byte> narrowIndices(const std::vector<uint32_t>& indices)
+{
+  std::vector<std::byte> indexData(indices.size() * sizeof(IndexType));
+  auto* output = reinterpret_cast<IndexType*>(indexData.data());
+  std::ranges::transform(
+      indices,
+      output,
+      [](uint32_t index) { return static_cast<IndexType>(index); });
+  return indexData;
+}
+
+// The vertices are packed straight into the buffer bound to GL_ARRAY_BUFFER,
+// without a packed copy on the CPU side
+void uploadVertices(
+    const std::vector<Vertex>& vertices,
+    const VertexLayoutDescription& vertexLayout,
+    const PositionQuantization& positionQuantization)
+{
+  const auto size =
+      static_cast<GLsizeiptr>(vertices.size() * vertexLayout.stride);
+  glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STATIC_DRAW);
+  if (size == 0)
+  {
+    return;
+  }
+
+  auto* output = static_cast<std::byte*>(glMapBufferRange(
+      GL_ARRAY_BUFFER,
+      0,
+      size,
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+  if (output != nullptr)
+  {
+    vertexLayout.pack(vertices, positionQuantization, output);
+    // False when the mapped memory was lost meanwhile, e.g. on a mode switch
+    if (glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE)
+    {
+      return;
+    }
+  }
+
+  std::vector<std::byte> vertexData(static_cast<size_t>(size));
+  vertexLayout.pack(vertices, positionQuantization, vertexData.data());
+  glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertexData.data());
+}
+
 }  // namespace
 
+GLenum Mesh::selectIndexType(const std::vector<uint32_t>& indices)
+{
+  const auto maxIndex =
+      indices.empty() ? uint32_t{} : std::ranges::max(indices);
+  if (maxIndex <= std::numeric_limits<GLubyte>::max())
+  {
+    return GL_UNSIGNED_BYTE;
+  }
+  if (maxIndex <= std::numeric_limits<GLushort>::max())
+  {
+    return GL_UNSIGNED_SHORT;
+  }
+  return GL_UNSIGNED_INT;
+}
+
 void Mesh::init()
 {
   glGenVertexArrays(1, &vao_);
@@ -25,109 +104,37 @@ void Mesh::init()
 
   glGenBuffers(1, &vbo_);
   glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-  glBufferData(
-      GL_ARRAY_BUFFER,
-      static_cast<GLsizeiptr>(vertices_.size() * sizeof(Vertex)),
-      vertices_.data(),
-      GL_STATIC_DRAW);
-
-  GLuint index = 0;
-  GLuint offset = 0;
-  glVertexAttribPointer(
-      index,
-      kVec3ComponentsCount,
-      GL_FLOAT,
-      GL_FALSE,
-      sizeof(Vertex),
-      attributeOffset(offset));
-  glEnableVertexAttribArray(index);
-
-  ++index;
-  offset += sizeof(glm::vec3);
-  glVertexAttribPointer(
-      index,
-      kVec3ComponentsCount,
-      GL_FLOAT,
-      GL_FALSE,
-      sizeof(Vertex),
-      attributeOffset(offset));
-  glEnableVertexAttribArray(index);
-
-  ++index;
-  offset += sizeof(glm::vec3);
-  glVertexAttribPointer(
-      index,
-      kVec3ComponentsCount,
-      GL_FLOAT,
-      GL_FALSE,
-      sizeof(Vertex),
-      attributeOffset(offset));
-  glEnableVertexAttribArray(index);
-
-  ++index;
-  offset += sizeof(glm::vec3);
-  glVertexAttribPointer(
-      index,
-      kVec3ComponentsCount,
-      GL_FLOAT,
-      GL_FALSE,
-      sizeof(Vertex),
-      attributeOffset(offset));
-  glEnableVertexAttribArray(index);
-
-  ++index;
-  offset += sizeof(glm::vec2);
-  glVertexAttribPointer(
-      index,
-      kVec2ComponentsCount,
-      GL_FLOAT,
-      GL_FALSE,
-      sizeof(Vertex),
-      attributeOffset(offset));
-  glEnableVertexAttribArray(index);
-
-  ++index;
-  offset += sizeof(glm::vec2);
-  glVertexAttribPointer(
-      index,
-      kVec2ComponentsCount,
-      GL_FLOAT,
-      GL_FALSE,
-      sizeof(Vertex),
-      attributeOffset(offset));
-  glEnableVertexAttribArray(index);
-
-  ++index;
-  offset += sizeof(glm::vec2);
-  glVertexAttribPointer(
-      index,
-      kVec2ComponentsCount,
-      GL_FLOAT,
-      GL_FALSE,
-      sizeof(Vertex),
-      attributeOffset(offset));
-  glEnableVertexAttribArray(index);
-
-  ++index;
-  offset += sizeof(glm::vec2);
-  glVertexAttribPointer(
-      index,
-      kVec2ComponentsCount,
-      GL_FLOAT,
-      GL_FALSE,
-      sizeof(Vertex),
-      attributeOffset(offset));
-  glEnableVertexAttribArray(index);
-
+  const auto& vertexLayout = *vertexLayout_;
+  positionQuantization_ = vertexLayout.quantizedPositions
+                              ? calculatePositionQuantization(vertices_)
+                              : PositionQuantization{};
+  uploadVertices(vertices_, vertexLayout, positionQuantization_);
+  setupVertexAttributes(vertexLayout);
+
+  indexType_ = selectIndexType(indices_);
   if (!indices_.empty())
   {
     glGenBuffers(1, &ebo_);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
-    glBufferData(
-        GL_ELEMENT_ARRAY_BUFFER,
-        static_cast<GLsizeiptr>(indices_.size() * sizeof(GLuint)),
-        indices_.data(),
-        GL_STATIC_DRAW);
+    if (indexType_ == GL_UNSIGNED_INT)
+    {
+      glBufferData(
+          GL_ELEMENT_ARRAY_BUFFER,
+          static_cast<GLsizeiptr>(indices_.size() * sizeof(GLuint)),
+          indices_.data(),
+          GL_STATIC_DRAW);
+    }
+    else
+    {
+      const auto indexData = indexType_ == GL_UNSIGNED_SHORT
+                                 ? narrowIndices<GLushort>(indices_)
+                                 : narrowIndices<GLubyte>(indices_);
+      glBufferData(
+          GL_ELEMENT_ARRAY_BUFFER,
+          static_cast<GLsizeiptr>(indexData.size()),
+          indexData.data(),
+          GL_STATIC_DRAW);
+    }
   }
 
   glBindVertexArray(0);
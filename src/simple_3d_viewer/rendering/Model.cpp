@@ -1,10 +1,16 @@
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <fmt/format.h>
 #include <iostream>
+#include <numeric>
+#include <optional>
 #include <simple_3d_viewer/linear_algebra/Vertex.hpp>
 #include <simple_3d_viewer/opengl_object_wrappers/Texture.hpp>
 #include <simple_3d_viewer/rendering/Material.hpp>
 #include <simple_3d_viewer/rendering/Model.hpp>
+#include <simple_3d_viewer/utils/Profiler.hpp>
+#include <simple_3d_viewer/utils/ThreadPool.hpp>
 #include <stdexcept>
 
 namespace Simple3D
@@ -15,8 +21,15 @@ namespace
 
 const char* const kErrorPrefix = "Error (Model):";
 
+void calculateBounds(Mesh& mesh)
+{
+  mesh.boundingBox_ = calculateAxisAlignedBox(mesh.vertices_);
+  mesh.boundingSphere_ =
+      calculateBoundingSphere(mesh.vertices_, mesh.boundingBox_);
 }
 
+}  // namespace
+
 const std::unordered_map<Model::Configuration::Flag, aiPostProcessSteps>
     Model::Configuration::flagToAssimpFlag_ = {
       { Configuration::Flag::FlipUVs, aiPostProcessSteps::aiProcess_FlipUVs }
@@ -26,6 +39,30 @@ void Model::loadModel(
     const std::filesystem::path& modelFilePath,
     const Model::Configuration& configuration)
 {
+  SIMPLE3D_PROFILE_ZONE("Model::loadModel");
+  using Clock = std::chrono::steady_clock;
+  const auto loadingStart = Clock::now();
+
+  const auto measureSerialTextureDecoding =
+      configuration.get(Configuration::Flag::MeasureSerialTextureDecoding);
+  std::optional<ModelCacheKey> cacheKey;
+  if (configuration.get(Configuration::Flag::UseModelCache))
+  {
+    cacheKey = createModelCacheKey(
+        modelFilePath, configuration.getOutputAffectingFlags());
+  }
+  if (cacheKey.has_value())
+  {
+    if (const auto cachedModel = readModelCache(*cacheKey);
+        cachedModel.has_value())
+    {
+      loadFromCache(*cachedModel, measureSerialTextureDecoding);
+      loadStatistics_.loadedFromCache = true;
+      loadStatistics_.loadingTime = Clock::now() - loadingStart;
+      return;
+    }
+  }
+
   Assimp::Importer importer;
   const aiScene* scenePtr = importer.ReadFile(
       modelFilePath,
@@ -44,22 +81,109 @@ void Model::loadModel(
 
   if (scene.HasMaterials())
   {
-    processMaterials(scene, modelDirectory);
+    processMaterials(scene, modelDirectory, measureSerialTextureDecoding);
+  }
+  processNodes(scene);
+  const auto optimize = configuration.get(Configuration::Flag::OptimizeMeshes);
+  if (optimize)
+  {
+    optimizeMeshes();
+  }
+  // The levels of detail index the vertices as they are after the
+  // optimization, which reorders them
+  if (configuration.get(Configuration::Flag::GenerateLods))
+  {
+    generateLods(optimize);
+  }
+  for (const auto& mesh : meshes_)
+  {
+    loadStatistics_.lodsCount += mesh.getLodsCount();
+  }
+  loadStatistics_.loadingTime = Clock::now() - loadingStart;
+
+  if (cacheKey.has_value())
+  {
+    const auto cacheWritingStart = Clock::now();
+    writeModelCache(*cacheKey, *this);
+    loadStatistics_.cacheWritingTime = Clock::now() - cacheWritingStart;
   }
-  processNode(*scene.mRootNode, scene);
+}
+
+void Model::loadFromCache(
+    const CachedModel& cachedModel,
+    const bool measureSerialTextureDecoding)
+{
+  SIMPLE3D_PROFILE_ZONE("Model::loadFromCache");
+  loadTextures(cachedModel.texturePaths, measureSerialTextureDecoding);
+
+  const auto toTexturesData =
+      [this](const std::vector<CachedModel::TextureReference>& references)
+  {
+    std::vector<Material::TextureData> texturesData;
+    texturesData.reserve(references.size());
+    for (const auto& [textureIndex, uvChannel] : references)
+    {
+      texturesData.push_back(
+          { &textures_[textureIndex],
+            uvChannel >= 0 ? std::make_optional(uvChannel) : std::nullopt });
+    }
+    return texturesData;
+  };
+
+  materials_.reserve(cachedModel.materials.size());
+  for (const auto& cachedMaterial : cachedModel.materials)
+  {
+    auto& material = materials_.emplace_back(
+        toTexturesData(cachedMaterial.diffuseTextures),
+        toTexturesData(cachedMaterial.specularTextures),
+        toTexturesData(cachedMaterial.emissiveTextures),
+        toTexturesData(cachedMaterial.normalsTextures),
+        toTexturesData(cachedMaterial.metalnessTextures),
+        toTexturesData(cachedMaterial.diffuseRoughnessTextures));
+    material.ambientColor = cachedMaterial.ambientColor;
+    material.diffuseColor = cachedMaterial.diffuseColor;
+    material.specularColor = cachedMaterial.specularColor;
+    material.emissiveColor = cachedMaterial.emissiveColor;
+    material.opacity = cachedMaterial.opacity;
+    material.shininess = cachedMaterial.shininess;
+    material.shininessStrength = cachedMaterial.shininessStrength;
+  }
+
+  // The arrays are copied in bulk straight out of the mapped file
+  meshes_.reserve(cachedModel.meshes.size());
+  for (const auto& [materialIndex, vertices, indices, lods] :
+       cachedModel.meshes)
+  {
+    Material* material = materialIndex != CachedModel::Mesh::kNoMaterial
+                             ? &materials_[materialIndex]
+                             : nullptr;
+    auto& mesh = meshes_.emplace_back(
+        std::vector<Vertex>(begin(vertices), end(vertices)),
+        std::vector<GLuint>(begin(indices), end(indices)),
+        material,
+        false);
+    mesh.lods_ = lods;
+    calculateBounds(mesh);
+    loadStatistics_.lodsCount += mesh.getLodsCount();
+  }
+  loadStatistics_.meshesCount = meshes_.size();
 }
 
 void Model::processMaterials(
     const aiScene& scene,
-    const std::filesystem::path& modelDirectory)
+    const std::filesystem::path& modelDirectory,
+    const bool measureSerialTextureDecoding)
 {
+  SIMPLE3D_PROFILE_ZONE("Model::processMaterials");
   const auto materialsCount = scene.mNumMaterials;
   materials_.reserve(materialsCount);
+  std::vector<std::filesystem::path> texturePaths;
   for (auto i = decltype(materialsCount){}; i < materialsCount; ++i)
   {
     const aiMaterial& assimpMaterial = *scene.mMaterials[i];
-    loadMaterialTextures(assimpMaterial, modelDirectory);
+    collectMaterialTexturePaths(assimpMaterial, modelDirectory, texturePaths);
   }
+  loadTextures(texturePaths, measureSerialTextureDecoding);
   for (auto i = decltype(materialsCount){}; i < materialsCount; ++i)
   {
     const aiMaterial& assimpMaterial = *scene.mMaterials[i];
@@ -67,37 +191,194 @@ void Model::processMaterials(
   }
 }
 
-void Model::processNode(const aiNode& node, const aiScene& scene)
+void Model::loadTextures(
+    const std::vector<std::filesystem::path>& texturePaths,
+    const bool measureSerialDecoding)
+{
+  SIMPLE3D_PROFILE_ZONE("Model::loadTextures");
+  using Clock = std::chrono::steady_clock;
+
+  // Goes first, so it's the one reading the files cold and the parallel
+  // decode isn't slowed down by the disk in comparison
+  if (measureSerialDecoding)
+  {
+    SIMPLE3D_PROFILE_ZONE("Model::loadTextures serial");
+    const auto serialDecodingStart = Clock::now();
+    for (const auto& texturePath : texturePaths)
+    {
+      const Texture texture(texturePath, false);
+    }
+    loadStatistics_.texturesSerialDecodingMeasured = true;
+    loadStatistics_.texturesSerialDecodingTime =
+        Clock::now() - serialDecodingStart;
+  }
+
+  // Texture has no default state, so the workers fill optionals which are
+  // moved into textures_ in the original order afterwards. Material keeps
+  // pointers into textures_ so it has to be fully populated before any
+  // material gets processed.
+  std::vector<std::optional<Texture>> decodedTextures(texturePaths.size());
+  std::vector<Clock::duration> decodingTimes(texturePaths.size());
+  auto& threadPool = getThreadPool();
+  const auto decodingStart = Clock::now();
+  threadPool.parallelFor(
+      texturePaths.size(),
+      [&texturePaths, &decodedTextures, &decodingTimes](size_t i)
+      {
+        const auto start = Clock::now();
+        decodedTextures[i].emplace(texturePaths[i], false);
+        decodingTimes[i] = Clock::now() - start;
+      });
+  const auto decodingEnd = Clock::now();
+
+  textures_.reserve(decodedTextures.size());
+  for (auto& decodedTexture : decodedTextures)
+  {
+    textures_.emplace_back(std::move(*decodedTexture));
+  }
+
+  loadStatistics_.texturesCount = textures_.size();
+  loadStatistics_.texturesDecodingThreadsCount =
+      std::min(threadPool.getConcurrency(), texturePaths.size());
+  loadStatistics_.texturesDecodingTime = decodingEnd - decodingStart;
+  loadStatistics_.texturesDecodingSummedTime = std::accumulate(
+      begin(decodingTimes), end(decodingTimes), Clock::duration{});
+}
+
+void Model::processNodes(const aiScene& scene)
+{
+  SIMPLE3D_PROFILE_ZONE("Model::processNodes");
+  using Clock = std::chrono::steady_clock;
+  const auto conversionStart = Clock::now();
+
+  // The tree is flattened in the order the recursive walk used to visit it,
+  // so the meshes_ order doesn't depend on the scheduling of the workers
+  std::vector<const aiMesh*> assimpMeshes;
+  collectNodeMeshes(*scene.mRootNode, scene, assimpMeshes);
+
+  // Mesh has no default state, same as with the textures the workers fill
+  // optionals which are moved into meshes_ afterwards
+  std::vector<std::optional<Mesh>> convertedMeshes(assimpMeshes.size());
+  getThreadPool().parallelFor(
+      assimpMeshes.size(),
+      [this, &assimpMeshes, &convertedMeshes](size_t i)
+      { convertedMeshes[i].emplace(processMesh(*assimpMeshes[i])); });
+
+  meshes_.reserve(convertedMeshes.size());
+  for (auto& convertedMesh : convertedMeshes)
+  {
+    meshes_.emplace_back(std::move(*convertedMesh));
+  }
+
+  loadStatistics_.meshesCount = meshes_.size();
+  loadStatistics_.meshesConversionTime = Clock::now() - conversionStart;
+}
+
+void Model::optimizeMeshes()
+{
+  SIMPLE3D_PROFILE_ZONE("Model::optimizeMeshes");
+  using Clock = std::chrono::steady_clock;
+  const auto optimizationStart = Clock::now();
+
+  std::vector<VertexCacheStatistics> statisticsBefore(meshes_.size());
+  std::vector<VertexCacheStatistics> statisticsAfter(meshes_.size());
+  getThreadPool().parallelFor(
+      meshes_.size(),
+      [this, &statisticsBefore, &statisticsAfter](size_t i)
+      {
+        auto& mesh = meshes_[i];
+        // optimizeMesh leaves the others as they are, they are left out of
+        // the statistics the same way, with them empty
+        if (!isTriangleList(mesh.indices_, mesh.vertices_.size()))
+        {
+          return;
+        }
+        statisticsBefore[i] =
+            analyzeVertexCache(mesh.indices_, mesh.vertices_.size());
+        optimizeMesh(mesh.vertices_, mesh.indices_);
+        statisticsAfter[i] =
+            analyzeVertexCache(mesh.indices_, mesh.vertices_.size());
+      });
+
+  loadStatistics_.meshesOptimized = true;
+  loadStatistics_.meshesOptimizationTime = Clock::now() - optimizationStart;
+  for (size_t i = 0; i < meshes_.size(); ++i)
+  {
+    loadStatistics_.vertexCacheBeforeOptimization += statisticsBefore[i];
+    loadStatistics_.vertexCacheAfterOptimization += statisticsAfter[i];
+  }
+}
+
+void Model::generateLods(bool optimizeLevels)
+{
+  SIMPLE3D_PROFILE_ZONE("Model::generateLods");
+  using Clock = std::chrono::steady_clock;
+  const auto generationStart = Clock::now();
+
+  getThreadPool().parallelFor(
+      meshes_.size(),
+      [this, optimizeLevels](size_t i)
+      {
+        auto& mesh = meshes_[i];
+        mesh.lods_ = Simple3D::generateLods(
+            mesh.vertices_, mesh.indices_, optimizeLevels);
+      });
+
+  loadStatistics_.lodsGenerated = true;
+  loadStatistics_.lodsGenerationTime = Clock::now() - generationStart;
+}
+
+void Model::buildMeshesBounds()
+{
+  SIMPLE3D_PROFILE_ZONE("Model::buildMeshesBounds");
+  std::vector<AxisAlignedBox> meshesBoxes;
+  meshesBoxes.reserve(meshes_.size());
+  for (const auto& mesh : meshes_)
+  {
+    meshesBoxes.push_back(mesh.boundingBox_);
+  }
+  meshesBounds_.assign(meshesBoxes);
+
+  using Clock = std::chrono::steady_clock;
+  const auto buildStart = Clock::now();
+  meshesHierarchy_ = BoundingVolumeHierarchy(meshesBoxes);
+  loadStatistics_.meshesHierarchyBuildTime = Clock::now() - buildStart;
+  loadStatistics_.meshesHierarchyNodesCount =
+      meshesHierarchy_.getNodes().size();
+}
+
+void Model::collectNodeMeshes(
+    const aiNode& node,
+    const aiScene& scene,
+    std::vector<const aiMesh*>& assimpMeshes)
 {
   const auto meshesCount = node.mNumMeshes;
   for (auto i = decltype(meshesCount){}; i < meshesCount; ++i)
   {
-    const aiMesh& assimpMesh = *scene.mMeshes[node.mMeshes[i]];
-    meshes_.emplace_back(processMesh(assimpMesh));
+    assimpMeshes.push_back(scene.mMeshes[node.mMeshes[i]]);
   }
   const auto childrenCount = node.mNumChildren;
   for (auto i = decltype(childrenCount){}; i < childrenCount; ++i)
   {
-    processNode(*node.mChildren[i], scene);
+    collectNodeMeshes(*node.mChildren[i], scene, assimpMeshes);
   }
 }
 
-void Model::loadMaterialTextures(
+void Model::collectMaterialTexturePaths(
     const aiMaterial& assimpMaterial,
-    const std::filesystem::path& modelDirectory)
+    const std::filesystem::path& modelDirectory,
+    std::vector<std::filesystem::path>& texturePaths)
 {
-  loadMaterialTexturesOfType(
-      assimpMaterial, aiTextureType_DIFFUSE, modelDirectory);
-  loadMaterialTexturesOfType(
-      assimpMaterial, aiTextureType_SPECULAR, modelDirectory);
-  loadMaterialTexturesOfType(
-      assimpMaterial, aiTextureType_EMISSIVE, modelDirectory);
-  loadMaterialTexturesOfType(
-      assimpMaterial, aiTextureType_NORMALS, modelDirectory);
-  loadMaterialTexturesOfType(
-      assimpMaterial, aiTextureType_METALNESS, modelDirectory);
-  loadMaterialTexturesOfType(
-      assimpMaterial, aiTextureType_DIFFUSE_ROUGHNESS, modelDirectory);
+  for (const auto type : { aiTextureType_DIFFUSE,
+                           aiTextureType_SPECULAR,
+                           aiTextureType_EMISSIVE,
+                           aiTextureType_NORMALS,
+                           aiTextureType_METALNESS,
+                           aiTextureType_DIFFUSE_ROUGHNESS })
+  {
+    collectMaterialTexturePathsOfType(
+        assimpMaterial, type, modelDirectory, texturePaths);
+  }
 }
 
 Material Model::processMaterial(
@@ -152,10 +433,11 @@ Material Model::processMaterial(
   return material;
 }
 
-void Model::loadMaterialTexturesOfType(
+void Model::collectMaterialTexturePathsOfType(
     const aiMaterial& assimpMaterial,
     aiTextureType type,
-    const std::filesystem::path& modelDirectory)
+    const std::filesystem::path& modelDirectory,
+    std::vector<std::filesystem::path>& texturePaths)
 {
   const auto texturesCount = assimpMaterial.GetTextureCount(type);
   for (auto i = decltype(texturesCount){}; i < texturesCount; ++i)
@@ -163,18 +445,14 @@ void Model::loadMaterialTexturesOfType(
     aiString texturePath;
     assimpMaterial.GetTexture(type, i, &texturePath);
     const std::filesystem::path relativePathToTexture(texturePath.C_Str());
-    const auto pathToTexture = modelDirectory / relativePathToTexture;
+    auto pathToTexture = modelDirectory / relativePathToTexture;
 
-    const auto it = std::ranges::find_if(
-        textures_,
-        [&pathToTexture](const Texture& texture)
-        { return pathToTexture == texture.getPath(); });
-    if (it != textures_.end())
+    if (std::ranges::find(texturePaths, pathToTexture) != texturePaths.end())
     {
       continue;
     }
 
-    textures_.emplace_back(pathToTexture, false);
+    texturePaths.push_back(std::move(pathToTexture));
   }
 }
 
@@ -222,62 +500,71 @@ std::vector<Material::TextureData> Model::getBelongingTextures(
 
 Mesh Model::processMesh(const aiMesh& assimpMesh)
 {
-  std::vector<Vertex> vertices;
-  std::vector<GLuint> indices;
-  Material* material = nullptr;
-
-  const auto uvChannelsCount = assimpMesh.GetNumUVChannels();
-  const auto uvChannelsCountClamped =
-      std::clamp(uvChannelsCount, {}, Vertex::maxUVChannels);
+  // Each attribute is copied in its own loop, the checks for attributes the
+  // mesh doesn't have are done once per mesh instead of once per vertex.
+  // Attributes that are missing stay zeroed by the value initialization.
   const auto verticesCount = assimpMesh.mNumVertices;
+  std::vector<Vertex> vertices(verticesCount);
   for (auto i = decltype(verticesCount){}; i < verticesCount; ++i)
   {
-    Vertex vertex{};
-    glm::vec3 vector{};
-    vector.x = assimpMesh.mVertices[i].x;
-    vector.y = assimpMesh.mVertices[i].y;
-    vector.z = assimpMesh.mVertices[i].z;
-    vertex.position = vector;
-    if (assimpMesh.HasNormals())
+    const aiVector3D& position = assimpMesh.mVertices[i];
+    vertices[i].position = glm::vec3(position.x, position.y, position.z);
+  }
+  if (assimpMesh.HasNormals())
+  {
+    for (auto i = decltype(verticesCount){}; i < verticesCount; ++i)
     {
-      vector.x = assimpMesh.mNormals[i].x;
-      vector.y = assimpMesh.mNormals[i].y;
-      vector.z = assimpMesh.mNormals[i].z;
-      vertex.normal = vector;
+      const aiVector3D& normal = assimpMesh.mNormals[i];
+      vertices[i].normal = glm::vec3(normal.x, normal.y, normal.z);
     }
-    if (assimpMesh.HasVertexColors(0))
+  }
+  if (assimpMesh.HasVertexColors(0))
+  {
+    for (auto i = decltype(verticesCount){}; i < verticesCount; ++i)
     {
-      vector.r = assimpMesh.mColors[0][i].r;
-      vector.g = assimpMesh.mColors[0][i].g;
-      vector.b = assimpMesh.mColors[0][i].b;
-      vertex.color = vector;
+      const aiColor4D& color = assimpMesh.mColors[0][i];
+      vertices[i].color = glm::vec3(color.r, color.g, color.b);
     }
-    glm::vec2 vector2D{};
-    for (auto j = decltype(uvChannelsCountClamped){};
-         j < uvChannelsCountClamped;
-         ++j)
+  }
+  const auto uvChannelsCount = assimpMesh.GetNumUVChannels();
+  const auto uvChannelsCountClamped =
+      std::clamp(uvChannelsCount, {}, Vertex::maxUVChannels);
+  for (auto j = decltype(uvChannelsCountClamped){}; j < uvChannelsCountClamped;
+       ++j)
+  {
+    const aiVector3D* texCoords = assimpMesh.mTextureCoords[j];
+    for (auto i = decltype(verticesCount){}; i < verticesCount; ++i)
     {
-      vector2D.x = assimpMesh.mTextureCoords[j][i].x;
-      vector2D.y = assimpMesh.mTextureCoords[j][i].y;
-      vertex.texCoords[j] = vector2D;
+      vertices[i].texCoords[j] = glm::vec2(texCoords[i].x, texCoords[i].y);
     }
-
-    vertices.push_back(vertex);
   }
 
+  // Faces are triangles after aiProcess_Triangulate apart from point and line
+  // primitives, so the index count is summed up front instead of assumed
   const auto facesCount = assimpMesh.mNumFaces;
-  for (auto i = decltype(facesCount){}; i < facesCount; i++)
+  size_t indicesCount = 0;
+  for (auto i = decltype(facesCount){}; i < facesCount; ++i)
+  {
+    indicesCount += assimpMesh.mFaces[i].mNumIndices;
+  }
+  std::vector<GLuint> indices(indicesCount);
+  auto indicesOutput = begin(indices);
+  for (auto i = decltype(facesCount){}; i < facesCount; ++i)
   {
     const aiFace& assimpFace = assimpMesh.mFaces[i];
-    for (size_t j = 0; j < assimpFace.mNumIndices; ++j)
-    {
-      indices.push_back(assimpFace.mIndices[j]);
-    }
+    indicesOutput = std::copy_n(
+        assimpFace.mIndices, assimpFace.mNumIndices, indicesOutput);
   }
 
-  material = &materials_[assimpMesh.mMaterialIndex];
+  // Only reads materials_, which is fully populated before the conversion
+  // starts, so the meshes can be processed concurrently
+  Material* material = assimpMesh.mMaterialIndex < materials_.size()
+                           ? &materials_[assimpMesh.mMaterialIndex]
+                           : nullptr;
 
-  return { std::move(vertices), std::move(indices), material, false };
+  Mesh mesh(std::move(vertices), std::move(indices), material, false);
+  calculateBounds(mesh);
+  return mesh;
 }
 
 }  // namespace Simple3D
@@ -0,0 +1,504 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fmt/format.h>
+#include <fstream>
+#include <functional>
+#include <simple_3d_viewer/rendering/Model.hpp>
+#include <simple_3d_viewer/rendering/ModelCache.hpp>
+#include <simple_3d_viewer/utils/constants.hpp>
+#include <stdexcept>
+#include <type_traits>
+
+namespace Simple3D
+{
+
+namespace
+{
+
+const char* const kErrorPrefix = "Error (ModelCache):";
+
+// Increase whenever the layout of the file or of Vertex changes
+constexpr uint32_t kCacheVersion = 2;
+constexpr std::array<char, 8> kCacheMagic = { 'S', '3', 'D', 'M',
+                                              'C', 'A', 'C', 'H' };
+constexpr size_t kBlobAlignment = 16;
+constexpr size_t kTextureTypesCount = 6;
+
+static_assert(std::is_trivially_copyable_v<Vertex>);
+
+struct Header
+{
+  std::array<char, 8> magic;
+  uint32_t version;
+  uint32_t vertexSize;
+  uint64_t configurationFlags;
+  uint64_t fileSize;
+  int64_t lastWriteTime;
+  uint32_t modelFilePathSize;
+  uint32_t texturesCount;
+  uint32_t materialsCount;
+  uint32_t meshesCount;
+};
+
+struct MaterialRecord
+{
+  std::array<float, 3> ambientColor;
+  std::array<float, 3> diffuseColor;
+  std::array<float, 3> specularColor;
+  std::array<float, 3> emissiveColor;
+  float opacity;
+  float shininess;
+  float shininessStrength;
+  std::array<uint32_t, kTextureTypesCount> texturesCounts;
+};
+
+struct MeshRecord
+{
+  uint32_t materialIndex;
+  uint32_t lodsCount;
+  uint64_t verticesCount;
+  uint64_t indicesCount;
+  uint64_t verticesOffset;
+  uint64_t indicesOffset;
+};
+
+// Follows its MeshRecord, the offset is relative to the mesh indices
+struct LodRecord
+{
+  uint64_t indicesOffset;
+  uint64_t indicesCount;
+  float error;
+  uint32_t padding;
+};
+
+std::array<float, 3> toArray(const glm::vec3& vector)
+{
+  return { vector.x, vector.y, vector.z };
+}
+
+glm::vec3 toVec3(const std::array<float, 3>& array)
+{
+  return { array[0], array[1], array[2] };
+}
+
+size_t alignUp(size_t value, size_t alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+class Reader
+{
+ public:
+  explicit Reader(std::span<const std::byte> data)
+      : data_(data)
+  {
+  }
+
+  template<typename T>
+  T read()
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value{};
+    std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+    return value;
+  }
+
+  std::string readString(size_t size)
+  {
+    const auto bytes = take(size);
+    return { reinterpret_cast<const char*>(bytes.data()), size };
+  }
+
+  template<typename T>
+  std::span<const T> viewArray(uint64_t offset, uint64_t count) const
+  {
+    if (offset % alignof(T) != 0 || offset > data_.size() ||
+        count > (data_.size() - offset) / sizeof(T))
+    {
+      throw std::out_of_range("Array is outside of the cache file");
+    }
+    return { reinterpret_cast<const T*>(data_.subspan(offset).data()),
+             static_cast<size_t>(count) };
+  }
+
+ private:
+  std::span<const std::byte> data_;
+  size_t position_ = 0;
+
+  std::span<const std::byte> take(size_t size)
+  {
+    if (size > data_.size() - position_)
+    {
+      throw std::out_of_range("Unexpected end of the cache file");
+    }
+    auto result = data_.subspan(position_, size);
+    position_ += size;
+    return result;
+  }
+};
+
+class Writer
+{
+ public:
+  template<typename T>
+  void write(const T& value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    writeBytes(&value, sizeof(T));
+  }
+
+  void writeBytes(const void* data, size_t size)
+  {
+    const auto* bytes = static_cast<const std::byte*>(data);
+    buffer_.insert(
+        end(buffer_), bytes, std::next(bytes, static_cast<std::ptrdiff_t>(size)));
+  }
+
+  void align(size_t alignment)
+  {
+    buffer_.resize(alignUp(buffer_.size(), alignment));
+  }
+
+  [[nodiscard]] size_t getSize() const
+  {
+    return buffer_.size();
+  }
+
+  [[nodiscard]] const std::vector<std::byte>& getBuffer() const
+  {
+    return buffer_;
+  }
+
+ private:
+  std::vector<std::byte> buffer_;
+};
+
+std::vector<CachedModel::TextureReference> readTextureReferences(
+    Reader& reader,
+    uint32_t count,
+    uint32_t texturesCount)
+{
+  std::vector<CachedModel::TextureReference> references(count);
+  for (auto& reference : references)
+  {
+    reference = reader.read<CachedModel::TextureReference>();
+    if (reference.textureIndex >= texturesCount)
+    {
+      throw std::out_of_range("Texture index out of range");
+    }
+  }
+  return references;
+}
+
+CachedModel parseCacheFile(MappedFile file, const ModelCacheKey& key)
+{
+  Reader reader(file.getData());
+  const auto header = reader.read<Header>();
+  const auto modelFilePath = reader.readString(header.modelFilePathSize);
+  if (header.magic != kCacheMagic || header.version != kCacheVersion ||
+      header.vertexSize != sizeof(Vertex) ||
+      header.configurationFlags != key.configurationFlags ||
+      header.fileSize != key.fileSize ||
+      header.lastWriteTime != key.lastWriteTime ||
+      modelFilePath != std::filesystem::absolute(key.modelFilePath).string())
+  {
+    throw std::invalid_argument("Cache entry is stale");
+  }
+
+  CachedModel cachedModel{ std::move(file), {}, {}, {} };
+
+  cachedModel.texturePaths.reserve(header.texturesCount);
+  for (uint32_t i = 0; i < header.texturesCount; ++i)
+  {
+    const auto pathSize = reader.read<uint32_t>();
+    cachedModel.texturePaths.emplace_back(reader.readString(pathSize));
+  }
+
+  cachedModel.materials.reserve(header.materialsCount);
+  for (uint32_t i = 0; i < header.materialsCount; ++i)
+  {
+    const auto record = reader.read<MaterialRecord>();
+    const auto texturesCount = header.texturesCount;
+    const auto& counts = record.texturesCounts;
+    // Brace initialization guarantees the left to right evaluation order
+    cachedModel.materials.push_back(CachedModel::Material{
+        toVec3(record.ambientColor),
+        toVec3(record.diffuseColor),
+        toVec3(record.specularColor),
+        toVec3(record.emissiveColor),
+        record.opacity,
+        record.shininess,
+        record.shininessStrength,
+        readTextureReferences(reader, counts[0], texturesCount),
+        readTextureReferences(reader, counts[1], texturesCount),
+        readTextureReferences(reader, counts[2], texturesCount),
+        readTextureReferences(reader, counts[3], texturesCount),
+        readTextureReferences(reader, counts[4], texturesCount),
+        readTextureReferences(reader, counts[5], texturesCount) });
+  }
+
+  cachedModel.meshes.reserve(header.meshesCount);
+  for (uint32_t i = 0; i < header.meshesCount; ++i)
+  {
+    const auto record = reader.read<MeshRecord>();
+    if (record.materialIndex != CachedModel::Mesh::kNoMaterial &&
+        record.materialIndex >= header.materialsCount)
+    {
+      throw std::out_of_range("Material index out of range");
+    }
+    if (record.indicesCount % 3 != 0)
+    {
+      throw std::invalid_argument("Indices don't form whole triangles");
+    }
+    std::vector<MeshLod> lods(record.lodsCount);
+    for (auto& lod : lods)
+    {
+      const auto lodRecord = reader.read<LodRecord>();
+      if (lodRecord.indicesOffset > record.indicesCount ||
+          lodRecord.indicesCount >
+              record.indicesCount - lodRecord.indicesOffset)
+      {
+        throw std::out_of_range("Level of detail is outside of the indices");
+      }
+      if (lodRecord.indicesOffset % 3 != 0 || lodRecord.indicesCount % 3 != 0)
+      {
+        throw std::invalid_argument(
+            "Level of detail doesn't form whole triangles");
+      }
+      lod = { static_cast<size_t>(lodRecord.indicesOffset),
+              static_cast<size_t>(lodRecord.indicesCount),
+              lodRecord.error };
+    }
+    const auto vertices =
+        reader.viewArray<Vertex>(record.verticesOffset, record.verticesCount);
+    const auto indices =
+        reader.viewArray<uint32_t>(record.indicesOffset, record.indicesCount);
+    // The levels of detail are ranges of the same indices, so this covers
+    // them too. Everything from the bounds to the draw calls trusts them.
+    if (std::ranges::any_of(
+            indices,
+            [verticesCount = vertices.size()](uint32_t index)
+            { return index >= verticesCount; }))
+    {
+      throw std::out_of_range("Vertex index out of range");
+    }
+    cachedModel.meshes.push_back(
+        { record.materialIndex, vertices, indices, std::move(lods) });
+  }
+
+  return cachedModel;
+}
+
+void writeTextureReferences(
+    Writer& writer,
+    const std::vector<Material::TextureData>& textures,
+    const Model& model)
+{
+  for (const auto& [texture, uvChannel] : textures)
+  {
+    writer.write(CachedModel::TextureReference{
+        static_cast<uint32_t>(texture - model.textures_.data()),
+        uvChannel.value_or(-1) });
+  }
+}
+
+std::vector<std::byte> serializeModel(
+    const ModelCacheKey& key,
+    const Model& model)
+{
+  Writer writer;
+  const auto modelFilePath =
+      std::filesystem::absolute(key.modelFilePath).string();
+  writer.write(Header{ kCacheMagic,
+                       kCacheVersion,
+                       sizeof(Vertex),
+                       key.configurationFlags,
+                       key.fileSize,
+                       key.lastWriteTime,
+                       static_cast<uint32_t>(modelFilePath.size()),
+                       static_cast<uint32_t>(model.textures_.size()),
+                       static_cast<uint32_t>(model.materials_.size()),
+                       static_cast<uint32_t>(model.meshes_.size()) });
+  writer.writeBytes(modelFilePath.data(), modelFilePath.size());
+
+  for (const auto& texture : model.textures_)
+  {
+    const auto path = texture.getPath().string();
+    writer.write(static_cast<uint32_t>(path.size()));
+    writer.writeBytes(path.data(), path.size());
+  }
+
+  for (const auto& material : model.materials_)
+  {
+    writer.write(MaterialRecord{
+        toArray(material.ambientColor),
+        toArray(material.diffuseColor),
+        toArray(material.specularColor),
+        toArray(material.emissiveColor),
+        material.opacity,
+        material.shininess,
+        material.shininessStrength,
+        { static_cast<uint32_t>(material.diffuseTextures.size()),
+          static_cast<uint32_t>(material.specularTextures.size()),
+          static_cast<uint32_t>(material.emissiveTextures.size()),
+          static_cast<uint32_t>(material.normalsTextures.size()),
+          static_cast<uint32_t>(material.metalnessTextures.size()),
+          static_cast<uint32_t>(material.diffuseRoughnessTextures.size()) } });
+    writeTextureReferences(writer, material.diffuseTextures, model);
+    writeTextureReferences(writer, material.specularTextures, model);
+    writeTextureReferences(writer, material.emissiveTextures, model);
+    writeTextureReferences(writer, material.normalsTextures, model);
+    writeTextureReferences(writer, material.metalnessTextures, model);
+    writeTextureReferences(writer, material.diffuseRoughnessTextures, model);
+  }
+
+  // Mesh records go first so that the blobs can be laid out right after
+  // them, every blob starts at an aligned offset
+  size_t recordsSize = 0;
+  for (const auto& mesh : model.meshes_)
+  {
+    recordsSize += sizeof(MeshRecord) + mesh.lods_.size() * sizeof(LodRecord);
+  }
+  size_t blobOffset = alignUp(writer.getSize() + recordsSize, kBlobAlignment);
+  for (const auto& mesh : model.meshes_)
+  {
+    MeshRecord record{};
+    record.materialIndex =
+        mesh.material_ != nullptr
+            ? static_cast<uint32_t>(mesh.material_ - model.materials_.data())
+            : CachedModel::Mesh::kNoMaterial;
+    record.lodsCount = static_cast<uint32_t>(mesh.lods_.size());
+    record.verticesCount = mesh.vertices_.size();
+    record.indicesCount = mesh.indices_.size();
+    record.verticesOffset = blobOffset;
+    blobOffset = alignUp(
+        blobOffset + mesh.vertices_.size() * sizeof(Vertex), kBlobAlignment);
+    record.indicesOffset = blobOffset;
+    blobOffset = alignUp(
+        blobOffset + mesh.indices_.size() * sizeof(uint32_t), kBlobAlignment);
+    writer.write(record);
+    for (const auto& [indicesOffset, indicesCount, error] : mesh.lods_)
+    {
+      writer.write(LodRecord{ indicesOffset, indicesCount, error, 0 });
+    }
+  }
+
+  for (const auto& mesh : model.meshes_)
+  {
+    writer.align(kBlobAlignment);
+    writer.writeBytes(
+        mesh.vertices_.data(), mesh.vertices_.size() * sizeof(Vertex));
+    writer.align(kBlobAlignment);
+    writer.writeBytes(
+        mesh.indices_.data(), mesh.indices_.size() * sizeof(uint32_t));
+  }
+  writer.align(kBlobAlignment);
+
+  return writer.getBuffer();
+}
+
+}  // namespace
+
+std::filesystem::path getModelCacheFilePath(const ModelCacheKey& key)
+{
+  const auto pathHash = std::hash<std::string>{}(
+      std::filesystem::absolute(key.modelFilePath).string());
+  return kModelCacheDirPath() /
+         fmt::format("{:016x}_{:x}.s3dcache", pathHash, key.configurationFlags);
+}
+
+std::optional<ModelCacheKey> createModelCacheKey(
+    const std::filesystem::path& modelFilePath,
+    uint64_t configurationFlags)
+{
+  std::error_code error;
+  const auto lastWriteTime =
+      std::filesystem::last_write_time(modelFilePath, error);
+  if (error)
+  {
+    return std::nullopt;
+  }
+  const auto fileSize = std::filesystem::file_size(modelFilePath, error);
+  if (error)
+  {
+    return std::nullopt;
+  }
+
+  return ModelCacheKey{
+    modelFilePath,
+    static_cast<int64_t>(lastWriteTime.time_since_epoch().count()),
+    static_cast<uint64_t>(fileSize),
+    configurationFlags
+  };
+}
+
+std::optional<CachedModel> readModelCache(const ModelCacheKey& key)
+{
+  const auto filePath = getModelCacheFilePath(key);
+  if (std::error_code error; !std::filesystem::exists(filePath, error))
+  {
+    return std::nullopt;
+  }
+
+  try
+  {
+    return parseCacheFile(MappedFile(filePath), key);
+  }
+  catch (const std::exception& e)
+  {
+    fmt::println(
+        stderr,
+        "{} Ignoring cache file {}: {}",
+        kErrorPrefix,
+        filePath.string(),
+        e.what());
+    return std::nullopt;
+  }
+}
+
+void writeModelCache(const ModelCacheKey& key, const Model& model)
+{
+  const auto filePath = getModelCacheFilePath(key);
+  auto temporaryFilePath = filePath;
+  temporaryFilePath += ".tmp";
+
+  try
+  {
+    const auto data = serializeModel(key, model);
+
+    std::filesystem::create_directories(filePath.parent_path());
+    {
+      std::ofstream out(
+          temporaryFilePath, std::ios::out | std::ios::binary | std::ios::trunc);
+      out.write(
+          reinterpret_cast<const char*>(data.data()),
+          static_cast<std::streamsize>(data.size()));
+      if (!out)
+      {
+        throw std::runtime_error("Failed to write the cache file");
+      }
+    }
+    // Readers never see a partially written entry
+    std::filesystem::rename(temporaryFilePath, filePath);
+  }
+  catch (const std::exception& e)
+  {
+    fmt::println(
+        stderr,
+        "{} Failed to write cache file {}: {}",
+        kErrorPrefix,
+        filePath.string(),
+        e.what());
+    std::error_code error;
+    std::filesystem::remove(temporaryFilePath, error);
+  }
+}
+
+void removeModelCache(const ModelCacheKey& key)
+{
+  std::error_code error;
+  std::filesystem::remove(getModelCacheFilePath(key), error);
+}
+
+}  // namespace Simple3D
@@ -0,0 +1,97 @@
+#include <glm/mat4x4.hpp>
+#include <glm/matrix.hpp>
+#include <glm/vec4.hpp>
+#include <simple_3d_viewer/rendering/ModelRaycaster.hpp>
+#include <simple_3d_viewer/utils/Profiler.hpp>
+#include <simple_3d_viewer/utils/ThreadPool.hpp>
+
+namespace Simple3D
+{
+
+ModelRaycaster::ModelRaycaster(const Model& model)
+    : model_(&model)
+{
+  SIMPLE3D_PROFILE_ZONE("ModelRaycaster::ModelRaycaster");
+  using Clock = std::chrono::steady_clock;
+  const auto buildStart = Clock::now();
+
+  const auto& meshes = model.meshes_;
+  meshesHierarchies_.resize(meshes.size());
+  getThreadPool().parallelFor(
+      meshes.size(),
+      [this, &meshes](size_t i)
+      {
+        const auto& mesh = meshes[i];
+        // The indices of the other levels of detail follow the full detail
+        // ones
+        const std::span<const uint32_t> indices(
+            mesh.indices_.data(),
+            mesh.indices_.empty() ? 0 : mesh.getLod(0).indicesCount);
+        meshesHierarchies_[i] = TriangleHierarchy(mesh.vertices_, indices);
+      });
+  for (const auto& hierarchy : meshesHierarchies_)
+  {
+    nodesCount_ += hierarchy.getNodesCount();
+  }
+
+  buildTime_ = Clock::now() - buildStart;
+}
+
+// An affine transform keeps the distances along the ray in the lengths of
+// its direction, so they are the same in both spaces
+Ray ModelRaycaster::toModelSpace(const Ray& ray) const
+{
+  const auto inverseTransform = glm::inverse(model_->transform_);
+  return { glm::vec3(inverseTransform * glm::vec4(ray.origin, 1.f)),
+           glm::vec3(inverseTransform * glm::vec4(ray.direction, 0.f)) };
+}
+
+std::optional<ModelRaycaster::Hit> ModelRaycaster::intersectClosest(
+    const Ray& ray,
+    float maxDistance) const
+{
+  const auto modelRay = toModelSpace(ray);
+  std::vector<BoundingVolumeHierarchy::RayHit> meshesHits;
+  model_->meshesHierarchy_.intersectRay(modelRay, maxDistance, meshesHits);
+
+  std::optional<Hit> closestHit;
+  auto closestDistance = maxDistance;
+  for (const auto& [meshDistance, meshIndex] : meshesHits)
+  {
+    // The meshes are ordered by where the ray enters their boxes, none of
+    // the remaining ones can be hit closer
+    if (meshDistance > closestDistance)
+    {
+      break;
+    }
+    if (const auto hit = meshesHierarchies_[meshIndex].intersectClosest(
+            modelRay, closestDistance);
+        hit.has_value())
+    {
+      closestDistance = hit->distance;
+      closestHit = { meshIndex,
+                     hit->triangleIndex,
+                     hit->distance,
+                     ray.origin + hit->distance * ray.direction };
+    }
+  }
+  return closestHit;
+}
+
+bool ModelRaycaster::intersectAny(const Ray& ray, float maxDistance) const
+{
+  const auto modelRay = toModelSpace(ray);
+  std::vector<BoundingVolumeHierarchy::RayHit> meshesHits;
+  model_->meshesHierarchy_.intersectRay(modelRay, maxDistance, meshesHits);
+  for (const auto& meshHit : meshesHits)
+  {
+    if (meshesHierarchies_[meshHit.primitive].intersectAny(
+            modelRay, maxDistance))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace Simple3D
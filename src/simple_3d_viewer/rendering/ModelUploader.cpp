@@ -0,0 +1,134 @@
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <simple_3d_viewer/rendering/ModelUploader.hpp>
+#include <simple_3d_viewer/utils/Profiler.hpp>
+
+namespace Simple3D
+{
+
+namespace
+{
+
+Texture* findIncompleteTexture(const Material& material)
+{
+  for (const auto* textures : { &material.diffuseTextures,
+                                &material.specularTextures,
+                                &material.emissiveTextures,
+                                &material.normalsTextures,
+                                &material.metalnessTextures,
+                                &material.diffuseRoughnessTextures })
+  {
+    for (const auto& textureData : *textures)
+    {
+      if (!textureData.texture->isComplete())
+      {
+        return textureData.texture;
+      }
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+void ModelUploader::start(const Model& model)
+{
+  finished_ = false;
+  nextMeshIndex_ = 0;
+  nextTextureIndex_ = 0;
+  statistics_ = {};
+  statistics_.meshesCount = model.meshes_.size();
+  statistics_.texturesCount = model.textures_.size();
+  for (const auto& mesh : model.meshes_)
+  {
+    statistics_.totalBytes += mesh.getDataSize();
+    statistics_.vertexBytes += mesh.vertices_.size() * mesh.getVertexSize();
+    statistics_.fullFormatVertexBytes +=
+        mesh.vertices_.size() * ModelVertexLayout::stride;
+    statistics_.indexBytes += mesh.indices_.size() * mesh.getIndexSize();
+    statistics_.fullWidthIndexBytes += mesh.indices_.size() * sizeof(GLuint);
+  }
+  for (const auto& texture : model.textures_)
+  {
+    statistics_.totalBytes += texture.getPendingDataSize();
+  }
+}
+
+void ModelUploader::upload(Model& model, const Budget& budget)
+{
+  SIMPLE3D_PROFILE_ZONE("ModelUploader::upload");
+  using Clock = std::chrono::steady_clock;
+
+  if (finished_)
+  {
+    return;
+  }
+
+  const auto frameStart = Clock::now();
+  size_t frameBytes = 0;
+  Duration frameUploadTime{};
+  do
+  {
+    frameBytes += uploadNext(model);
+    frameUploadTime = Clock::now() - frameStart;
+  } while (!finished_ && frameBytes < budget.bytesPerFrame &&
+           frameUploadTime < budget.timePerFrame);
+
+  statistics_.uploadedBytes += frameBytes;
+  ++statistics_.framesCount;
+  statistics_.uploadTime += frameUploadTime;
+  statistics_.lastFrameUploadTime = frameUploadTime;
+  statistics_.maxFrameUploadTime =
+      std::max(statistics_.maxFrameUploadTime, frameUploadTime);
+}
+
+size_t ModelUploader::uploadNext(Model& model)
+{
+  // Textures go in front of the mesh which needs them, the mesh is only
+  // uploaded once all of its material's textures are
+  while (nextMeshIndex_ < model.meshes_.size())
+  {
+    auto& mesh = model.meshes_[nextMeshIndex_];
+    if (mesh.material_ != nullptr)
+    {
+      if (auto* texture = findIncompleteTexture(*mesh.material_);
+          texture != nullptr)
+      {
+        const auto dataSize = texture->getPendingDataSize();
+        texture->complete();
+        ++statistics_.uploadedTexturesCount;
+        return dataSize;
+      }
+    }
+
+    ++nextMeshIndex_;
+    if (mesh.isComplete())
+    {
+      continue;
+    }
+    mesh.complete();
+    ++statistics_.uploadedMeshesCount;
+    return mesh.getDataSize();
+  }
+
+  // Textures which aren't used by any mesh
+  while (nextTextureIndex_ < model.textures_.size())
+  {
+    auto& texture = model.textures_[nextTextureIndex_];
+    ++nextTextureIndex_;
+    if (texture.isComplete())
+    {
+      continue;
+    }
+    const auto dataSize = texture.getPendingDataSize();
+    texture.complete();
+    ++statistics_.uploadedTexturesCount;
+    return dataSize;
+  }
+
+  finished_ = true;
+  return 0;
+}
+
+}  // namespace Simple3D
@@ -0,0 +1,365 @@
+#include <algorithm>
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/matrix.hpp>
+#include <limits>
+#include <simple_3d_viewer/linear_algebra/meshGeneration.hpp>
+#include <simple_3d_viewer/rendering/OcclusionQueries.hpp>
+#include <simple_3d_viewer/utils/constants.hpp>
+#include <simple_3d_viewer/utils/factories.hpp>
+
+namespace Simple3D
+{
+
+namespace
+{
+
+constexpr auto kNoParent = std::numeric_limits<uint32_t>::max();
+// Visible leaves are requeried after a random number of frames up to this,
+// which spreads the queries of leaves that became visible together
+constexpr uint64_t kMaxVisibleQueryInterval = 8;
+// Of the largest extent. Keeps the faces of a box from fighting with the
+// surfaces lying on them and gives flat boxes some volume.
+constexpr float kBoxMargin = 0.01f;
+
+AxisAlignedBox inflate(const AxisAlignedBox& box)
+{
+  const auto size = box.maximum - box.minimum;
+  const auto margin =
+      glm::vec3(kBoxMargin * std::max({ size.x, size.y, size.z }));
+  return { box.minimum - margin, box.maximum + margin };
+}
+
+bool contains(const AxisAlignedBox& box, const glm::vec3& point)
+{
+  return point.x >= box.minimum.x && point.y >= box.minimum.y &&
+         point.z >= box.minimum.z && point.x <= box.maximum.x &&
+         point.y <= box.maximum.y && point.z <= box.maximum.z;
+}
+
+}  // namespace
+
+OcclusionQueries::OcclusionQueries()
+    : box_(skyboxMesh()),
+      boxProgram_(createProgram(kLightShaderCommonName))
+{
+  // Zero bits means that occlusion queries aren't supported, which the
+  // specification allows
+  GLint counterBits = 0;
+  glGetQueryiv(GL_SAMPLES_PASSED, GL_QUERY_COUNTER_BITS, &counterBits);
+  supported_ = counterBits > 0;
+}
+
+void OcclusionQueries::release()
+{
+  for (auto& state : nodesStates_)
+  {
+    if (state.query != 0)
+    {
+      glDeleteQueries(1, &state.query);
+    }
+  }
+  nodesStates_.clear();
+  pendingNodes_.clear();
+  modelId_ = 0;
+}
+
+void OcclusionQueries::render(
+    const Model& model,
+    const std::span<const uint8_t> visibility,
+    const glm::mat4x4& projectionView,
+    const glm::vec3& cameraPosition,
+    const DrawMesh& drawMesh)
+{
+  statistics_ = {};
+  const auto& nodes = model.meshesHierarchy_.getNodes();
+  if (!supported_ || nodes.empty())
+  {
+    for (size_t i = 0; i < model.meshes_.size(); ++i)
+    {
+      if (visibility[i] != 0 && model.meshes_[i].isComplete())
+      {
+        drawMesh(i);
+      }
+    }
+    return;
+  }
+
+  ++frame_;
+  if (model.getId() != modelId_ || nodesStates_.size() != nodes.size())
+  {
+    reset(model);
+  }
+  countMeshes(model, visibility);
+  readResults(model);
+
+  // The boxes stay in the model space, the camera is moved there instead
+  const auto modelCameraPosition = glm::vec3(
+      glm::inverse(model.transform_) * glm::vec4(cameraPosition, 1.f));
+  const auto& primitiveIndices = model.meshesHierarchy_.getPrimitiveIndices();
+  boxQueryNodes_.clear();
+  stack_.assign(1, 0);
+  while (!stack_.empty())
+  {
+    const auto nodeIndex = stack_.back();
+    stack_.pop_back();
+    if (nodesMeshesCounts_[nodeIndex] == 0)
+    {
+      continue;
+    }
+
+    const auto& node = nodes[nodeIndex];
+    auto& state = nodesStates_[nodeIndex];
+    // The near plane clips the faces of a box around the camera, so its
+    // query could come back empty even though the box is in plain sight
+    if (!state.visible && contains(inflate(node.box), modelCameraPosition))
+    {
+      setVisible(model, nodeIndex);
+    }
+    if (!state.visible)
+    {
+      statistics_.skippedMeshesCount += nodesMeshesCounts_[nodeIndex];
+      if (!state.queryPending)
+      {
+        boxQueryNodes_.push_back(nodeIndex);
+      }
+      continue;
+    }
+
+    if (!node.isLeaf())
+    {
+      // Front to back, so the nearer meshes are in the depth buffer when the
+      // farther ones are queried
+      const auto first = node.firstChildOrPrimitive;
+      const auto getDistance = [&](uint32_t child)
+      {
+        const auto& box = nodes[child].box;
+        return glm::length(
+            (box.minimum + box.maximum) * 0.5f - modelCameraPosition);
+      };
+      const bool firstIsNearer = getDistance(first) <= getDistance(first + 1);
+      stack_.push_back(firstIsNearer ? first + 1 : first);
+      stack_.push_back(firstIsNearer ? first : first + 1);
+      continue;
+    }
+
+    // The draws of the leaf are its query, no boxes are drawn for it
+    const bool query = !state.queryPending && frame_ >= state.nextQueryFrame;
+    if (query)
+    {
+      beginQuery(nodeIndex, true);
+    }
+    for (auto i = node.firstChildOrPrimitive;
+         i < node.firstChildOrPrimitive + node.primitivesCount;
+         ++i)
+    {
+      const auto meshIndex = primitiveIndices[i];
+      if (visibility[meshIndex] != 0 && model.meshes_[meshIndex].isComplete())
+      {
+        drawMesh(meshIndex);
+      }
+    }
+    if (query)
+    {
+      glEndQuery(GL_ANY_SAMPLES_PASSED);
+    }
+  }
+
+  // After all of the visible meshes, which are what occludes the boxes
+  queryBoxes(model, projectionView);
+}
+
+void OcclusionQueries::reset(const Model& model)
+{
+  release();
+  modelId_ = model.getId();
+  const auto& nodes = model.meshesHierarchy_.getNodes();
+  // Everything starts visible, the first queries sort it out
+  nodesStates_.assign(nodes.size(), { 0, true, false, false, 0 });
+  parents_.assign(nodes.size(), kNoParent);
+  for (uint32_t i = 0; i < nodes.size(); ++i)
+  {
+    if (!nodes[i].isLeaf())
+    {
+      parents_[nodes[i].firstChildOrPrimitive] = i;
+      parents_[nodes[i].firstChildOrPrimitive + 1] = i;
+    }
+  }
+}
+
+// Children always come after their parents in the hierarchy, so a single
+// backwards pass sums up the subtrees
+void OcclusionQueries::countMeshes(
+    const Model& model,
+    const std::span<const uint8_t> visibility)
+{
+  const auto& nodes = model.meshesHierarchy_.getNodes();
+  const auto& primitiveIndices = model.meshesHierarchy_.getPrimitiveIndices();
+  nodesMeshesCounts_.assign(nodes.size(), 0);
+  for (auto i = nodes.size(); i-- > 0;)
+  {
+    const auto& node = nodes[i];
+    if (!node.isLeaf())
+    {
+      const auto firstChild = node.firstChildOrPrimitive;
+      nodesMeshesCounts_[i] =
+          nodesMeshesCounts_[firstChild] + nodesMeshesCounts_[firstChild + 1];
+      continue;
+    }
+    for (auto j = node.firstChildOrPrimitive;
+         j < node.firstChildOrPrimitive + node.primitivesCount;
+         ++j)
+    {
+      const auto meshIndex = primitiveIndices[j];
+      if (visibility[meshIndex] != 0 && model.meshes_[meshIndex].isComplete())
+      {
+        ++nodesMeshesCounts_[i];
+      }
+    }
+  }
+}
+
+// Queries finish in the order they were issued, so the first one which isn't
+// available yet ends the reading
+void OcclusionQueries::readResults(const Model& model)
+{
+  size_t readCount = 0;
+  for (; readCount < pendingNodes_.size(); ++readCount)
+  {
+    const auto nodeIndex = pendingNodes_[readCount];
+    auto& state = nodesStates_[nodeIndex];
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(state.query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == GL_FALSE)
+    {
+      break;
+    }
+
+    GLuint anySamplesPassed = GL_FALSE;
+    glGetQueryObjectuiv(state.query, GL_QUERY_RESULT, &anySamplesPassed);
+    state.queryPending = false;
+    if (anySamplesPassed != GL_FALSE)
+    {
+      setVisible(model, nodeIndex);
+    }
+    else if (state.queryWithDraws)
+    {
+      setOccluded(model, nodeIndex);
+    }
+  }
+  statistics_.stallsAvoidedCount = pendingNodes_.size() - readCount;
+  pendingNodes_.erase(
+      pendingNodes_.begin(),
+      pendingNodes_.begin() + static_cast<std::ptrdiff_t>(readCount));
+}
+
+void OcclusionQueries::setVisible(const Model& model, const uint32_t nodeIndex)
+{
+  // The traversal has to get through the ancestors to reach the node
+  for (auto ancestor = parents_[nodeIndex];
+       ancestor != kNoParent && !nodesStates_[ancestor].visible;
+       ancestor = parents_[ancestor])
+  {
+    nodesStates_[ancestor].visible = true;
+  }
+
+  // The whole subtree is drawn in the next frame and its leaves queried
+  // right away, instead of querying it one level per frame on the way down
+  const auto& nodes = model.meshesHierarchy_.getNodes();
+  std::vector<uint32_t> subtree{ nodeIndex };
+  while (!subtree.empty())
+  {
+    const auto descendant = subtree.back();
+    subtree.pop_back();
+    if (auto& state = nodesStates_[descendant]; !state.visible)
+    {
+      state.visible = true;
+      state.nextQueryFrame = frame_;
+    }
+    if (const auto& node = nodes[descendant]; !node.isLeaf())
+    {
+      subtree.push_back(node.firstChildOrPrimitive);
+      subtree.push_back(node.firstChildOrPrimitive + 1);
+    }
+  }
+}
+
+void OcclusionQueries::setOccluded(const Model& model, const uint32_t nodeIndex)
+{
+  // Parents whose children are all occluded are queried as a whole instead
+  const auto& nodes = model.meshesHierarchy_.getNodes();
+  nodesStates_[nodeIndex].visible = false;
+  for (auto parent = parents_[nodeIndex]; parent != kNoParent;
+       parent = parents_[parent])
+  {
+    const auto firstChild = nodes[parent].firstChildOrPrimitive;
+    if (nodesStates_[firstChild].visible ||
+        nodesStates_[firstChild + 1].visible)
+    {
+      break;
+    }
+    nodesStates_[parent].visible = false;
+  }
+}
+
+void OcclusionQueries::beginQuery(
+    const uint32_t nodeIndex,
+    const bool withDraws)
+{
+  auto& state = nodesStates_[nodeIndex];
+  if (state.query == 0)
+  {
+    glGenQueries(1, &state.query);
+  }
+  glBeginQuery(GL_ANY_SAMPLES_PASSED, state.query);
+  state.queryPending = true;
+  state.queryWithDraws = withDraws;
+  if (withDraws)
+  {
+    state.nextQueryFrame =
+        frame_ + std::uniform_int_distribution<uint64_t>(
+                     1, kMaxVisibleQueryInterval)(random_);
+  }
+  pendingNodes_.push_back(nodeIndex);
+  ++statistics_.queriesIssuedCount;
+}
+
+void OcclusionQueries::queryBoxes(
+    const Model& model,
+    const glm::mat4x4& projectionView)
+{
+  if (boxQueryNodes_.empty())
+  {
+    return;
+  }
+
+  const auto& nodes = model.meshesHierarchy_.getNodes();
+  glDepthMask(GL_FALSE);
+  glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+  boxProgram_.doOperations(
+      [&](Program& program)
+      {
+        program.setMat4f("pv", projectionView);
+        glBindVertexArray(box_.vao_);
+        for (const auto nodeIndex : boxQueryNodes_)
+        {
+          // The box mesh spans [-1, 1] on every axis
+          const auto box = inflate(nodes[nodeIndex].box);
+          const auto center = (box.minimum + box.maximum) * 0.5f;
+          const auto halfSize = (box.maximum - box.minimum) * 0.5f;
+          program.setMat4f(
+              "model",
+              glm::scale(
+                  glm::translate(model.transform_, center), halfSize));
+          beginQuery(nodeIndex, false);
+          glDrawArrays(
+              GL_TRIANGLES, 0, static_cast<GLsizei>(box_.vertices_.size()));
+          glEndQuery(GL_ANY_SAMPLES_PASSED);
+        }
+        glBindVertexArray(0);
+      });
+  glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  glDepthMask(GL_TRUE);
+}
+
+}  // namespace Simple3D
@@ -9,7 +9,10 @@
 #include <iostream>
 #include <range/v3/algorithm/remove.hpp>
 #include <simple_3d_viewer/rendering/PostprocessPipeline.hpp>
-#include <simple_3d_viewer/utils/factories.hpp>
+#include <simple_3d_viewer/utils/constants.hpp>
+#include <simple_3d_viewer/utils/fileOperations.hpp>
+#include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 
@@ -21,11 +24,13 @@ namespace
 
 constexpr GLuint kScreenTextureSlot = 4;
 
+constexpr std::string_view kPointWiseSignature = "vec4 apply(vec4 color)";
+const char* const kVertexShaderFilename = "postprocess.vs";
+
 StringHeterogeneousLookupUnorderedMap<Postprocess> createIDToPostprocessMap(
     const std::vector<PostprocessID>& postprocessIDs)
 {
   StringHeterogeneousLookupUnorderedMap<Postprocess> idToPostprocess;
-  const std::string vertexShaderFilename = "postprocess";
   for (const auto& id : postprocessIDs)
   {
     auto lowerCaseId = id;
@@ -33,148 +38,59 @@ StringHeterogeneousLookupUnorderedMap<Postprocess> createIDToPostprocessMap(
         lowerCaseId,
         begin(lowerCaseId),
         [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    auto fragmentShader =
+        loadFileIntoString(kShaderDirPath() / (lowerCaseId + ".fs"));
+    const auto pointWise =
+        fragmentShader.find(kPointWiseSignature) != std::string::npos;
     idToPostprocess.try_emplace(
-        id, createProgram(vertexShaderFilename, lowerCaseId), false);
+        id, Postprocess{ pointWise, std::move(fragmentShader) });
   }
 
   return idToPostprocess;
 }
 
-Framebuffers createFramebuffers(
-    const size_t framebuffersCount,
-    const Size framebufferSize)
-{
-  Framebuffers framebuffers(framebuffersCount);
-  glGenFramebuffers(
-      static_cast<GLsizei>(framebuffersCount),
-      framebuffers.framebuffers.data());
-  glGenTextures(
-      static_cast<GLsizei>(framebuffersCount),
-      framebuffers.colorBuffers.data());
-  glGenRenderbuffers(
-      static_cast<GLsizei>(framebuffersCount),
-      framebuffers.renderBuffers.data());
-
-  for (auto i = decltype(framebuffersCount){}; i < framebuffersCount; ++i)
-  {
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffers.framebuffers[i]);
-
-    glBindTexture(GL_TEXTURE_2D, framebuffers.colorBuffers[i]);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexImage2D(
-        GL_TEXTURE_2D,
-        0,
-        GL_RGBA,
-        framebufferSize.width,
-        framebufferSize.height,
-        0,
-        GL_RGBA,
-        GL_UNSIGNED_BYTE,
-        nullptr);
-    glFramebufferTexture2D(
-        GL_FRAMEBUFFER,
-        GL_COLOR_ATTACHMENT0,
-        GL_TEXTURE_2D,
-        framebuffers.colorBuffers[i],
-        0);
-
-    glBindRenderbuffer(GL_RENDERBUFFER, framebuffers.renderBuffers[i]);
-    glRenderbufferStorage(
-        GL_RENDERBUFFER,
-        GL_DEPTH24_STENCIL8,
-        framebufferSize.width,
-        framebufferSize.height);
-    glFramebufferRenderbuffer(
-        GL_FRAMEBUFFER,
-        GL_DEPTH_STENCIL_ATTACHMENT,
-        GL_RENDERBUFFER,
-        framebuffers.renderBuffers[i]);
-
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-    {
-      fmt::println(stderr, "Framebuffer is not complete");
-    }
-  }
-
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glBindRenderbuffer(GL_RENDERBUFFER, 0);
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-  return framebuffers;
-}
-
-void updatePostprocesses(
-    const std::vector<PostprocessID>& postprocessesToUpdate,
-    StringHeterogeneousLookupUnorderedMap<Postprocess>& idToPostprocess,
-    const Size framebufferSize)
-{
-  for (const auto& id : postprocessesToUpdate)
-  {
-    auto& program = idToPostprocess.at(id).program;
-    program.doOperations(
-        [framebufferSize](Program& it)
-        {
-          it.setVec3f(
-              "inverseScreenSize",
-              { 1.0f / static_cast<float>(framebufferSize.width),
-                1.0f / static_cast<float>(framebufferSize.height),
-                1.0f });
-        });
-  }
-}
-
-std::vector<PostprocessID> initPostprocesses(
-    StringHeterogeneousLookupUnorderedMap<Postprocess>& idToPostprocess,
-    const Size framebufferSize)
+// Every apply function is renamed by the preprocessor, so the bodies are
+// pasted in unchanged. Without any postprocesses the shader only copies.
+std::string generateFusedShader(
+    const std::vector<const Postprocess*>& postprocesses)
 {
-  std::vector<PostprocessID> postprocessesToUpdate;
-
-  for (auto& [id, postprocess] : idToPostprocess)
+  std::string functions;
+  std::string calls;
+  for (size_t i = 0; i < postprocesses.size(); ++i)
   {
-    if (postprocess.program.hasUniform("inverseScreenSize"))
-    {
-      postprocessesToUpdate.push_back(id);
-    }
-    postprocess.program.doOperations(
-        [](Program& program)
-        { program.setInt("screenTexture", kScreenTextureSlot); });
+    functions += fmt::format(
+        "#define apply apply{}\n{}\n#undef apply\n",
+        i,
+        postprocesses[i]->fragmentShader);
+    calls += fmt::format("  color = apply{}(color);\n", i);
   }
-
-  updatePostprocesses(postprocessesToUpdate, idToPostprocess, framebufferSize);
-
-  return postprocessesToUpdate;
+  return fmt::format(
+      "#version 330 core\n"
+      "in vec2 TexCoord;\n"
+      "uniform sampler2D screenTexture;\n"
+      "out vec4 FragColor;\n"
+      "{}"
+      "void main()\n"
+      "{{\n"
+      "  vec4 color = texture(screenTexture, TexCoord);\n"
+      "{}"
+      "  FragColor = color;\n"
+      "}}\n",
+      functions,
+      calls);
 }
 
-void resizeFramebuffersAttachments(
-    Framebuffers& framebuffers,
-    const Size framebufferSize)
+void setInverseScreenSize(Program& program, const Size framebufferSize)
 {
-  const auto size = framebuffers.colorBuffers.size();
-  for (auto i = decltype(size){}; i < size; ++i)
-  {
-    glBindTexture(GL_TEXTURE_2D, framebuffers.colorBuffers[i]);
-    glTexImage2D(
-        GL_TEXTURE_2D,
-        0,
-        GL_RGBA,
-        framebufferSize.width,
-        framebufferSize.height,
-        0,
-        GL_RGBA,
-        GL_UNSIGNED_BYTE,
-        nullptr);
-
-    glBindRenderbuffer(GL_RENDERBUFFER, framebuffers.renderBuffers[i]);
-    glRenderbufferStorage(
-        GL_RENDERBUFFER,
-        GL_DEPTH24_STENCIL8,
-        framebufferSize.width,
-        framebufferSize.height);
-  }
-
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+  program.doOperations(
+      [framebufferSize](Program& it)
+      {
+        it.setVec3f(
+            "inverseScreenSize",
+            { 1.0f / static_cast<float>(framebufferSize.width),
+              1.0f / static_cast<float>(framebufferSize.height),
+              1.0f });
+      });
 }
 
 ScreenQuad createScreenQuad()
@@ -213,87 +129,84 @@ PostprocessPipeline::PostprocessPipeline(
     const std::vector<std::string>& postprocessIDs,
     const Size framebufferSize)
     : idToPostprocess_(createIDToPostprocessMap(postprocessIDs)),
-      postprocessesToUpdate_(
-          initPostprocesses(idToPostprocess_, framebufferSize)),
-      framebuffers_(createFramebuffers(postprocessIDs.size(), framebufferSize)),
+      framebufferSize_(framebufferSize),
       screenQuad_(createScreenQuad())
 {
-}
-
-void PostprocessPipeline::start()
-{
-  if (postprocessesOrder_.empty())
+  // Neighborhood programs are compiled up front, as they were before the
+  // point-wise ones could be fused
+  for (const auto& [id, postprocess] : idToPostprocess_)
   {
-    return;
+    if (!postprocess.pointWise)
+    {
+      getPassProgram(id, { &postprocess });
+    }
   }
-  glBindFramebuffer(GL_FRAMEBUFFER, framebuffers_.framebuffers.front());
 }
 
-void PostprocessPipeline::finalize()
+void PostprocessPipeline::addPasses(
+    RenderGraph& renderGraph,
+    const RenderGraph::ResourceID input,
+    const RenderGraph::ResourceID output,
+    const Size outputSize)
 {
-  if (postprocessesOrder_.empty())
+  const auto upscaled = outputSize != framebufferSize_;
+  if (passes_.empty() && !upscaled)
   {
     return;
   }
+  static const std::vector<PostprocessPass> kUpscalePasses{ { "Upscale",
+                                                              nullptr } };
+  const auto& passes = passes_.empty() ? kUpscalePasses : passes_;
 
-  glBindVertexArray(screenQuad_.vao);
-  glDisable(GL_DEPTH_TEST);
-  glActiveTexture(GL_TEXTURE0 + kScreenTextureSlot);
-
-  size_t colorBufferToUse = 0;
-  const auto postprocessesCount = postprocessesOrder_.size();
-  for (auto i = decltype(postprocessesCount){}; i < postprocessesCount - 1; ++i)
+  auto source = input;
+  for (size_t i = 0; i < passes.size(); ++i)
   {
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffers_.framebuffers[i + 1]);
-    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    glBindTexture(GL_TEXTURE_2D, framebuffers_.colorBuffers[i]);
-
-    auto& program = idToPostprocess_.at(postprocessesOrder_[i]).program;
-    program.doOperations([](Program& /*unused*/)
-                         { glDrawArrays(GL_TRIANGLES, 0, 6); });
-
-    ++colorBufferToUse;
+    const auto& pass = passes[i];
+    const auto last = i + 1 == passes.size();
+    // Each intermediate target only lives until the next pass has read it,
+    // so the graph alternates them between two textures
+    const auto target =
+        last ? output
+             : renderGraph.createTexture(
+                   pass.name,
+                   { framebufferSize_, RenderGraph::Format::RGBA8 });
+    // Every pass covers the whole target with the quad. Only the output is
+    // cleared, which lets tiled GPUs skip loading its previous contents.
+    renderGraph.addPass(
+        { pass.name,
+          { { source,
+              kScreenTextureSlot,
+              last && upscaled ? RenderGraph::Filter::Linear
+                               : RenderGraph::Filter::Nearest } },
+          { { target,
+              last ? RenderGraph::LoadOperation::Clear
+                   : RenderGraph::LoadOperation::DontCare,
+              { 1.0f, 1.0f, 1.0f, 1.0f } } },
+          [&program = pass.program != nullptr ? *pass.program
+                                              : getPassProgram(pass.name, {}),
+           vao = screenQuad_.vao]()
+          {
+            glBindVertexArray(vao);
+            glDisable(GL_DEPTH_TEST);
+            program.doOperations([](Program& /*unused*/)
+                                 { glDrawArrays(GL_TRIANGLES, 0, 6); });
+            glBindVertexArray(0);
+          } });
+    source = target;
   }
-
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
-  glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-  glBindTexture(GL_TEXTURE_2D, framebuffers_.colorBuffers[colorBufferToUse]);
-
-  auto& program = idToPostprocess_.at(postprocessesOrder_.back()).program;
-  program.doOperations([](Program& /*unused*/)
-                       { glDrawArrays(GL_TRIANGLES, 0, 6); });
-
-  glBindVertexArray(0);
-  glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void PostprocessPipeline::resize(Size framebufferSize)
 {
-  updatePostprocesses(
-      postprocessesToUpdate_, idToPostprocess_, framebufferSize);
-
-  resizeFramebuffersAttachments(framebuffers_, framebufferSize);
+  framebufferSize_ = framebufferSize;
+  for (const auto& name : passProgramsToUpdate_)
+  {
+    setInverseScreenSize(passPrograms_.at(name), framebufferSize);
+  }
 }
 
 namespace
 {
-void releaseFramebuffers(Framebuffers& framebuffers)
-{
-  const auto framebuffersCount =
-      static_cast<GLsizei>(framebuffers.framebuffers.size());
-  glDeleteFramebuffers(framebuffersCount, framebuffers.framebuffers.data());
-  glDeleteTextures(framebuffersCount, framebuffers.colorBuffers.data());
-  glDeleteRenderbuffers(framebuffersCount, framebuffers.renderBuffers.data());
-
-  framebuffers.framebuffers.clear();
-  framebuffers.colorBuffers.clear();
-  framebuffers.renderBuffers.clear();
-}
-
 void releaseScreenQuad(ScreenQuad& screenQuad)
 {
   glDeleteBuffers(1, &screenQuad.vbo);
@@ -306,7 +219,6 @@ void releaseScreenQuad(ScreenQuad& screenQuad)
 
 void PostprocessPipeline::release()
 {
-  releaseFramebuffers(framebuffers_);
   releaseScreenQuad(screenQuad_);
 }
 
@@ -324,13 +236,76 @@ void PostprocessPipeline::setPostprocessActiveFlag(
   if (postprocess.active)
   {
     postprocessesOrder_.push_back(id);
-    return;
   }
+  else
+  {
+    // std::ranges::remove seems to not work correctly so until it is fixed
+    // this is the way
+    postprocessesOrder_.erase(
+        ranges::remove(postprocessesOrder_, id), end(postprocessesOrder_));
+  }
+  updatePasses();
+}
+
+void PostprocessPipeline::updatePasses()
+{
+  passes_.clear();
+  std::string fusedName;
+  std::vector<const Postprocess*> fused;
+  const auto addFusedPass = [this, &fusedName, &fused]()
+  {
+    if (fused.empty())
+    {
+      return;
+    }
+    passes_.push_back({ fusedName, &getPassProgram(fusedName, fused) });
+    fusedName.clear();
+    fused.clear();
+  };
 
-  // std::ranges::remove seems to not work correctly so until it is fixed this
-  // is the way
-  postprocessesOrder_.erase(
-      ranges::remove(postprocessesOrder_, id), end(postprocessesOrder_));
+  for (const auto& id : postprocessesOrder_)
+  {
+    const auto& postprocess = idToPostprocess_.at(id);
+    if (postprocess.pointWise)
+    {
+      fusedName += fusedName.empty() ? id : "+" + id;
+      fused.push_back(&postprocess);
+      continue;
+    }
+    addFusedPass();
+    passes_.push_back({ id, &passPrograms_.at(id) });
+  }
+  addFusedPass();
+}
+
+Program& PostprocessPipeline::getPassProgram(
+    const std::string& name,
+    const std::vector<const Postprocess*>& postprocesses)
+{
+  if (const auto found = passPrograms_.find(name); found != passPrograms_.end())
+  {
+    return found->second;
+  }
+
+  const auto vertexShader =
+      loadFileIntoString(kShaderDirPath() / kVertexShaderFilename);
+  auto& program =
+      passPrograms_
+          .try_emplace(
+              name,
+              vertexShader,
+              postprocesses.empty() || postprocesses.front()->pointWise
+                  ? generateFusedShader(postprocesses)
+                  : postprocesses.front()->fragmentShader)
+          .first->second;
+  program.doOperations(
+      [](Program& it) { it.setInt("screenTexture", kScreenTextureSlot); });
+  if (program.hasUniform("inverseScreenSize"))
+  {
+    passProgramsToUpdate_.push_back(name);
+    setInverseScreenSize(program, framebufferSize_);
+  }
+  return program;
 }
 
 }  // namespace Simple3D
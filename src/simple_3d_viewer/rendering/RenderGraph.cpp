@@ -0,0 +1,547 @@
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fmt/core.h>
+#include <iterator>
+#include <limits>
+#include <simple_3d_viewer/rendering/RenderGraph.hpp>
+#include <simple_3d_viewer/utils/Profiler.hpp>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace Simple3D
+{
+
+namespace
+{
+
+constexpr size_t kBytesPerPixel = 4;
+
+size_t calculateSize(const RenderGraph::TextureDescription& description)
+{
+  return static_cast<size_t>(description.size.width) *
+         static_cast<size_t>(description.size.height) * kBytesPerPixel;
+}
+
+bool isColor(const RenderGraph::TextureDescription& description)
+{
+  return description.format == RenderGraph::Format::RGBA8;
+}
+
+uint createPhysicalTexture(const RenderGraph::TextureDescription& description)
+{
+  // The binding is put back, the material textures stay bound between the
+  // frames
+  GLint previousTexture = 0;
+  glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+
+  uint texture = 0;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  const auto color = isColor(description);
+  glTexImage2D(
+      GL_TEXTURE_2D,
+      0,
+      color ? GL_RGBA8 : GL_DEPTH24_STENCIL8,
+      description.size.width,
+      description.size.height,
+      0,
+      color ? GL_RGBA : GL_DEPTH_STENCIL,
+      color ? GL_UNSIGNED_BYTE : GL_UNSIGNED_INT_24_8,
+      nullptr);
+
+  glBindTexture(GL_TEXTURE_2D, static_cast<uint>(previousTexture));
+  return texture;
+}
+
+}  // namespace
+
+void RenderGraph::reset()
+{
+  resources_.clear();
+  passes_.clear();
+  compiledPasses_.clear();
+}
+
+RenderGraph::ResourceID RenderGraph::createTexture(
+    std::string name,
+    const TextureDescription& description)
+{
+  resources_.push_back({ std::move(name), description, std::nullopt, 0, 0, 0 });
+  return resources_.size() - 1;
+}
+
+RenderGraph::ResourceID RenderGraph::importFramebuffer(
+    std::string name,
+    const uint framebuffer,
+    const Size size)
+{
+  // The format of an imported framebuffer is never looked at
+  resources_.push_back(
+      { std::move(name), { size, Format::RGBA8 }, framebuffer, 0, 0, 0 });
+  return resources_.size() - 1;
+}
+
+void RenderGraph::addPass(Pass pass)
+{
+  validate(pass);
+  passes_.push_back(std::move(pass));
+}
+
+void RenderGraph::validate(const Pass& pass) const
+{
+  const auto checkResource = [this, &pass](const ResourceID resource)
+  {
+    if (resource >= resources_.size())
+    {
+      throw std::invalid_argument(fmt::format(
+          "Pass {} uses the resource {} which doesn't exist",
+          pass.name,
+          resource));
+    }
+  };
+
+  for (const auto& read : pass.reads)
+  {
+    checkResource(read.resource);
+    const auto& resource = resources_[read.resource];
+    if (resource.importedFramebuffer.has_value())
+    {
+      throw std::invalid_argument(fmt::format(
+          "Pass {} reads the imported framebuffer {}, only textures can be "
+          "read",
+          pass.name,
+          resource.name));
+    }
+  }
+
+  if (pass.writes.empty())
+  {
+    throw std::invalid_argument(
+        fmt::format("Pass {} doesn't write anything", pass.name));
+  }
+  size_t colorsCount = 0;
+  size_t depthsCount = 0;
+  size_t importedCount = 0;
+  for (const auto& write : pass.writes)
+  {
+    checkResource(write.resource);
+    const auto& resource = resources_[write.resource];
+    if (std::ranges::any_of(
+            pass.reads,
+            [&write](const Read& read)
+            { return read.resource == write.resource; }))
+    {
+      throw std::invalid_argument(fmt::format(
+          "Pass {} both reads and writes {}", pass.name, resource.name));
+    }
+    if (resource.importedFramebuffer.has_value())
+    {
+      ++importedCount;
+    }
+    else if (isColor(resource.description))
+    {
+      ++colorsCount;
+    }
+    else
+    {
+      ++depthsCount;
+    }
+  }
+  if (colorsCount > 1 || depthsCount > 1 ||
+      (importedCount > 0 && pass.writes.size() > 1))
+  {
+    throw std::invalid_argument(fmt::format(
+        "Pass {} writes more than one color or depth texture, or an imported "
+        "framebuffer together with something else",
+        pass.name));
+  }
+  const auto size = resources_[pass.writes.front().resource].description.size;
+  if (std::ranges::any_of(
+          pass.writes,
+          [this, size](const Write& write)
+          { return resources_[write.resource].description.size != size; }))
+  {
+    throw std::invalid_argument(fmt::format(
+        "Pass {} writes textures of different sizes", pass.name));
+  }
+}
+
+void RenderGraph::compile()
+{
+  SIMPLE3D_PROFILE_ZONE("RenderGraph::compile");
+  const auto executed = cullPasses();
+  std::vector<size_t> executedPasses;
+  for (size_t i = 0; i < passes_.size(); ++i)
+  {
+    if (executed[i] != 0)
+    {
+      executedPasses.push_back(i);
+    }
+  }
+  statistics_ = {};
+  statistics_.passesCount = passes_.size();
+  statistics_.culledPassesCount = passes_.size() - executedPasses.size();
+
+  // The lifetimes are in the order of the executed passes, a transient
+  // texture has to be written before anything reads or loads it
+  for (auto& resource : resources_)
+  {
+    resource.firstPass = std::numeric_limits<size_t>::max();
+    resource.lastPass = 0;
+  }
+  std::vector<uint8_t> written(resources_.size(), 0);
+  for (size_t order = 0; order < executedPasses.size(); ++order)
+  {
+    const auto& pass = passes_[executedPasses[order]];
+    const auto use = [this, order](const ResourceID id)
+    {
+      auto& resource = resources_[id];
+      resource.firstPass = std::min(resource.firstPass, order);
+      resource.lastPass = std::max(resource.lastPass, order);
+    };
+    for (const auto& read : pass.reads)
+    {
+      if (written[read.resource] == 0)
+      {
+        throw std::invalid_argument(fmt::format(
+            "Pass {} reads {} before any pass writes it",
+            pass.name,
+            resources_[read.resource].name));
+      }
+      use(read.resource);
+    }
+    for (const auto& write : pass.writes)
+    {
+      const auto& resource = resources_[write.resource];
+      if (write.loadOperation == LoadOperation::Load &&
+          written[write.resource] == 0 &&
+          !resource.importedFramebuffer.has_value())
+      {
+        throw std::invalid_argument(fmt::format(
+            "Pass {} loads {} before any pass writes it",
+            pass.name,
+            resource.name));
+      }
+      use(write.resource);
+      written[write.resource] = 1;
+    }
+  }
+
+  assignPhysicalTextures(executedPasses);
+
+  // Consecutive passes drawing into the same framebuffer only bind it once,
+  // and only the writes asking for it are cleared
+  std::optional<uint> boundFramebuffer;
+  for (const auto passIndex : executedPasses)
+  {
+    const auto& pass = passes_[passIndex];
+    CompiledPass compiledPass{ passIndex,
+                               getFramebuffer(pass),
+                               resources_[pass.writes.front().resource]
+                                   .description.size,
+                               0,
+                               { 0.f, 0.f, 0.f, 1.f } };
+    for (const auto& write : pass.writes)
+    {
+      if (write.loadOperation != LoadOperation::Clear)
+      {
+        continue;
+      }
+      const auto& resource = resources_[write.resource];
+      if (resource.importedFramebuffer.has_value())
+      {
+        compiledPass.clearMask |= GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT;
+        compiledPass.clearColor = write.clearColor;
+      }
+      else if (isColor(resource.description))
+      {
+        compiledPass.clearMask |= GL_COLOR_BUFFER_BIT;
+        compiledPass.clearColor = write.clearColor;
+      }
+      else
+      {
+        compiledPass.clearMask |= GL_DEPTH_BUFFER_BIT;
+      }
+    }
+    if (compiledPass.clearMask != 0)
+    {
+      ++statistics_.clearsCount;
+    }
+    if (boundFramebuffer != compiledPass.framebuffer)
+    {
+      ++statistics_.framebufferBindsCount;
+      boundFramebuffer = compiledPass.framebuffer;
+    }
+    compiledPasses_.push_back(compiledPass);
+  }
+
+  if (linearSampler_ == 0 &&
+      std::ranges::any_of(
+          executedPasses,
+          [this](const size_t passIndex)
+          {
+            return std::ranges::any_of(
+                passes_[passIndex].reads,
+                [](const Read& read) { return read.filter == Filter::Linear; });
+          }))
+  {
+    glGenSamplers(1, &linearSampler_);
+    glSamplerParameteri(linearSampler_, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glSamplerParameteri(linearSampler_, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glSamplerParameteri(linearSampler_, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(linearSampler_, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  }
+}
+
+std::vector<uint8_t> RenderGraph::cullPasses() const
+{
+  // Walks back from the imported framebuffers. A resource is needed while a
+  // later executed pass reads its contents, and a pass is executed when it
+  // writes a needed resource.
+  std::vector<uint8_t> needed(resources_.size(), 0);
+  for (size_t i = 0; i < resources_.size(); ++i)
+  {
+    needed[i] = resources_[i].importedFramebuffer.has_value() ? 1 : 0;
+  }
+
+  std::vector<uint8_t> executed(passes_.size(), 0);
+  for (auto i = passes_.size(); i-- > 0;)
+  {
+    const auto& pass = passes_[i];
+    if (std::ranges::none_of(
+            pass.writes,
+            [&needed](const Write& write)
+            { return needed[write.resource] != 0; }))
+    {
+      continue;
+    }
+    executed[i] = 1;
+    // Clearing or overwriting everything hides what the earlier passes wrote
+    for (const auto& write : pass.writes)
+    {
+      if (write.loadOperation != LoadOperation::Load)
+      {
+        needed[write.resource] = 0;
+      }
+    }
+    for (const auto& read : pass.reads)
+    {
+      needed[read.resource] = 1;
+    }
+  }
+  return executed;
+}
+
+void RenderGraph::assignPhysicalTextures(
+    const std::vector<size_t>& executedPasses)
+{
+  for (auto& physicalTexture : physicalTextures_)
+  {
+    physicalTexture.busyUntil.reset();
+  }
+
+  std::vector<ResourceID> transientResources;
+  for (size_t i = 0; i < resources_.size(); ++i)
+  {
+    const auto& resource = resources_[i];
+    if (!resource.importedFramebuffer.has_value() &&
+        resource.firstPass < executedPasses.size())
+    {
+      transientResources.push_back(i);
+    }
+  }
+  std::ranges::stable_sort(
+      transientResources,
+      {},
+      [this](const ResourceID id) { return resources_[id].firstPass; });
+
+  // In the order of the first use each resource takes the first texture of
+  // its description which is free by then, which needs the fewest textures
+  for (const auto id : transientResources)
+  {
+    auto& resource = resources_[id];
+    auto found = std::ranges::find_if(
+        physicalTextures_,
+        [&resource](const PhysicalTexture& physicalTexture)
+        {
+          return physicalTexture.description == resource.description &&
+                 (!physicalTexture.busyUntil.has_value() ||
+                  *physicalTexture.busyUntil < resource.firstPass);
+        });
+    if (found == physicalTextures_.end())
+    {
+      physicalTextures_.push_back(
+          { resource.description,
+            createPhysicalTexture(resource.description),
+            std::nullopt });
+      found = std::prev(physicalTextures_.end());
+    }
+    found->busyUntil = resource.lastPass;
+    resource.physicalTexture = found->texture;
+    statistics_.unaliasedMemoryBytes += calculateSize(resource.description);
+  }
+  statistics_.transientTexturesCount = transientResources.size();
+
+  // Textures no resource needed in this frame are released, e.g. the ones
+  // of the previous size after a resize, together with their framebuffers
+  std::erase_if(
+      physicalTextures_,
+      [this](PhysicalTexture& physicalTexture)
+      {
+        if (physicalTexture.busyUntil.has_value())
+        {
+          return false;
+        }
+        std::erase_if(
+            framebuffers_,
+            [&physicalTexture](const auto& entry)
+            {
+              const auto& [attachments, framebuffer] = entry;
+              if (attachments.first != physicalTexture.texture &&
+                  attachments.second != physicalTexture.texture)
+              {
+                return false;
+              }
+              glDeleteFramebuffers(1, &framebuffer);
+              return true;
+            });
+        glDeleteTextures(1, &physicalTexture.texture);
+        return true;
+      });
+
+  statistics_.physicalTexturesCount = physicalTextures_.size();
+  for (const auto& physicalTexture : physicalTextures_)
+  {
+    statistics_.memoryBytes += calculateSize(physicalTexture.description);
+  }
+}
+
+uint RenderGraph::getFramebuffer(const Pass& pass)
+{
+  uint colorTexture = 0;
+  uint depthTexture = 0;
+  for (const auto& write : pass.writes)
+  {
+    const auto& resource = resources_[write.resource];
+    if (resource.importedFramebuffer.has_value())
+    {
+      return *resource.importedFramebuffer;
+    }
+    (isColor(resource.description) ? colorTexture : depthTexture) =
+        resource.physicalTexture;
+  }
+
+  const auto [found, inserted] =
+      framebuffers_.try_emplace({ colorTexture, depthTexture }, 0);
+  auto& framebuffer = found->second;
+  if (!inserted)
+  {
+    return framebuffer;
+  }
+
+  glGenFramebuffers(1, &framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  if (colorTexture != 0)
+  {
+    glFramebufferTexture2D(
+        GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+  }
+  else
+  {
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+  }
+  if (depthTexture != 0)
+  {
+    glFramebufferTexture2D(
+        GL_FRAMEBUFFER,
+        GL_DEPTH_STENCIL_ATTACHMENT,
+        GL_TEXTURE_2D,
+        depthTexture,
+        0);
+  }
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+  {
+    fmt::println(stderr, "Framebuffer of pass {} is not complete", pass.name);
+  }
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  return framebuffer;
+}
+
+void RenderGraph::execute(GpuProfiler& profiler)
+{
+  std::optional<uint> boundFramebuffer;
+  std::optional<Size> viewport;
+  for (const auto& compiledPass : compiledPasses_)
+  {
+    const auto& pass = passes_[compiledPass.passIndex];
+    profiler.measure(
+        pass.name,
+        [this, &compiledPass, &pass, &boundFramebuffer, &viewport]()
+        {
+          if (boundFramebuffer != compiledPass.framebuffer)
+          {
+            glBindFramebuffer(GL_FRAMEBUFFER, compiledPass.framebuffer);
+            boundFramebuffer = compiledPass.framebuffer;
+          }
+          if (viewport != compiledPass.viewport)
+          {
+            glViewport(
+                0,
+                0,
+                compiledPass.viewport.width,
+                compiledPass.viewport.height);
+            viewport = compiledPass.viewport;
+          }
+          if (compiledPass.clearMask != 0)
+          {
+            const auto& color = compiledPass.clearColor;
+            glClearColor(color.r, color.g, color.b, color.a);
+            glClear(compiledPass.clearMask);
+          }
+          for (const auto& read : pass.reads)
+          {
+            glActiveTexture(GL_TEXTURE0 + read.textureUnit);
+            glBindTexture(
+                GL_TEXTURE_2D, resources_[read.resource].physicalTexture);
+            if (read.filter == Filter::Linear)
+            {
+              glBindSampler(read.textureUnit, linearSampler_);
+            }
+          }
+          pass.execute();
+          // The later users of the texture units filter as their textures say
+          for (const auto& read : pass.reads)
+          {
+            if (read.filter == Filter::Linear)
+            {
+              glBindSampler(read.textureUnit, 0);
+            }
+          }
+        });
+  }
+}
+
+void RenderGraph::release()
+{
+  for (const auto& [attachments, framebuffer] : framebuffers_)
+  {
+    glDeleteFramebuffers(1, &framebuffer);
+  }
+  framebuffers_.clear();
+  for (const auto& physicalTexture : physicalTextures_)
+  {
+    glDeleteTextures(1, &physicalTexture.texture);
+  }
+  physicalTextures_.clear();
+  glDeleteSamplers(1, &linearSampler_);
+  linearSampler_ = 0;
+  reset();
+}
+
+}  // namespace Simple3D
@@ -1,33 +1,139 @@
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <simple_3d_viewer/utils/Profiler.hpp>
+#include <span>
 #include <simple_3d_viewer/linear_algebra/Transform.hpp>
 #include <simple_3d_viewer/rendering/Renderer.hpp>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace Simple3D
 {
 
 void Renderer::render(Scene& scene, const Size framebufferSize)
 {
-  performCacheChecks(scene, framebufferSize);
-  postprocessPipeline_.start();
+  SIMPLE3D_PROFILE_ZONE("Renderer::render");
+  gpuProfiler_.beginFrame();
+  const auto gpuFramesCount = gpuProfiler_.getCollectedFramesCount();
+  resolutionScaler_.update(
+      gpuFramesCount != cache_.gpuFramesCount
+          ? std::optional(gpuProfiler_.getLastFrameTime())
+          : std::nullopt);
+  cache_.gpuFramesCount = gpuFramesCount;
+  const auto renderSize = resolutionScaler_.apply(framebufferSize);
+  performCacheChecks(scene, framebufferSize, renderSize);
+  statistics_ = {};
+
+  if (!keepLastFrame_)
+  {
+    lastFrame_.reset();
+  }
+  else if (!lastFrame_.has_value())
+  {
+    lastFrame_.emplace(framebufferSize);
+  }
+  else if (lastFrame_->getSize() != framebufferSize)
+  {
+    lastFrame_->resize(framebufferSize);
+  }
+
+  renderGraph_.reset();
+  const auto output = renderGraph_.importFramebuffer(
+      "Output",
+      lastFrame_.has_value() ? lastFrame_->get() : outputFramebuffer_,
+      framebufferSize);
+  // Without postprocesses and scaling the scene is drawn straight into the
+  // output
+  std::vector<RenderGraph::ResourceID> sceneTargets{ output };
+  if (!postprocessPipeline_.getPasses().empty() ||
+      renderSize != framebufferSize)
+  {
+    sceneTargets = {
+      renderGraph_.createTexture(
+          "Scene color", { renderSize, RenderGraph::Format::RGBA8 }),
+      renderGraph_.createTexture(
+          "Scene depth", { renderSize, RenderGraph::Format::Depth24Stencil8 })
+    };
+  }
+  // The first of the scene passes clears the targets
+  auto loadOperation = RenderGraph::LoadOperation::Clear;
+  const auto addScenePass =
+      [this, &sceneTargets, &loadOperation](
+          std::string name, std::function<void()> execute)
+  {
+    static constexpr auto clearColor = 0.01f;
+    std::vector<RenderGraph::Write> writes;
+    for (const auto target : sceneTargets)
+    {
+      writes.push_back(
+          { target,
+            loadOperation,
+            { clearColor, clearColor, clearColor, 1.0f } });
+    }
+    renderGraph_.addPass(
+        { std::move(name), {}, std::move(writes), std::move(execute) });
+    loadOperation = RenderGraph::LoadOperation::Load;
+  };
 
-  glEnable(GL_DEPTH_TEST);
-  static constexpr auto clearColor = 0.01f;
-  glClearColor(clearColor, clearColor, clearColor, 1.0f);
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
   if (scene.model)
   {
-    render(scene.model.value(), scene.modelProgram);
+    addScenePass(
+        "Model",
+        [this, &scene, renderSize]()
+        {
+          render(
+              scene.model.value(),
+              scene.modelProgram,
+              { scene.camera.getPosition(),
+                calculateProjectionScale(renderSize) });
+        });
   }
   if (drawLight_)
   {
-    render(scene.light, scene.lightProgram);
+    addScenePass(
+        "Light", [this, &scene]() { render(scene.light, scene.lightProgram); });
+  }
+  addScenePass(
+      "Skybox",
+      [this, &scene]()
+      {
+        renderSkybox(scene.skybox, scene.skyboxProgram, scene.skyboxTexture);
+      });
+  if (sceneTargets.front() != output)
+  {
+    postprocessPipeline_.addPasses(
+        renderGraph_, sceneTargets.front(), output, framebufferSize);
   }
-  renderSkybox(scene.skybox, scene.skyboxProgram, scene.skyboxTexture);
 
-  postprocessPipeline_.finalize();
+  renderGraph_.compile();
+  glEnable(GL_DEPTH_TEST);
+  renderGraph_.execute(gpuProfiler_);
+  if (lastFrame_.has_value())
+  {
+    gpuProfiler_.measure(
+        "Present", [this]() { lastFrame_->blitTo(outputFramebuffer_); });
+  }
+}
+
+bool Renderer::presentLastFrame(const Size framebufferSize)
+{
+  if (!lastFrame_.has_value() || lastFrame_->getSize() != framebufferSize)
+  {
+    return false;
+  }
+  lastFrame_->blitTo(outputFramebuffer_);
+  return true;
 }
 
-void Renderer::performCacheChecks(Scene& scene, const Size framebufferSize)
+void Renderer::performCacheChecks(
+    Scene& scene,
+    const Size framebufferSize,
+    const Size renderSize)
 {
+  SIMPLE3D_PROFILE_ZONE("Renderer::performCacheChecks");
   auto& modelProgramUniformsCache = cache_.modelProgramUniformsCache;
   const auto projection = calculateProjectionTransform(framebufferSize);
   const auto view = scene.camera.getViewTransform();
@@ -38,17 +144,27 @@ void Renderer::performCacheChecks(Scene& scene, const Size framebufferSize)
       framebufferSize,
       [&modelProgramUniformsCache,
        framebufferSize,
-       &postprocessPipeline = postprocessPipeline_]()
+       &occlusionBuffer = occlusionBuffer_]()
       {
         modelProgramUniformsCache.clear();
-        glViewport(0, 0, framebufferSize.width, framebufferSize.height);
-        postprocessPipeline.resize(framebufferSize);
+        occlusionBuffer.resize(framebufferSize);
       });
+  // The render graph sets the viewports
+  cache_.renderSize.update(
+      renderSize,
+      [renderSize, &postprocessPipeline = postprocessPipeline_]()
+      { postprocessPipeline.resize(renderSize); });
   modelProgramUniformsCache.projectionViewTransform.update(
       { projection, view },
-      [&projection, &view, &scene]()
+      [&projection,
+       &view,
+       &scene,
+       &frustum = frustum_,
+       &storedProjectionView = projectionView_]()
       {
         const auto projectionView = projection * view;
+        frustum = extractFrustum(projectionView);
+        storedProjectionView = projectionView;
         scene.modelProgram.doOperations(
             [&projectionView](Program& program)
             { program.setMat4f("pv", projectionView); });
@@ -97,12 +213,226 @@ void Renderer::performCacheChecks(Scene& scene, const Size framebufferSize)
   }
 }
 
-void Renderer::render(Model& model, Program& program)
+namespace
+{
+
+// Below this the flat pass over all boxes is faster than walking the
+// hierarchy, it tests more boxes but without any branching on the results
+constexpr size_t kHierarchicalCullingMinMeshesCount = 4096;
+
+// Only the largest meshes on the screen are rasterized as occluders, and only
+// if the level of detail they are rasterized with is cheap enough
+constexpr size_t kMaxOccludersCount = 16;
+constexpr size_t kMaxOccluderTrianglesCount = 4096;
+
+size_t countTriangles(const Mesh& mesh, size_t lodLevel)
+{
+  static constexpr size_t kTriangleVerticesCount = 3;
+  return (mesh.indices_.empty() ? mesh.vertices_.size()
+                                : mesh.getLod(lodLevel).indicesCount) /
+         kTriangleVerticesCount;
+}
+
+}  // namespace
+
+void Renderer::render(
+    Model& model,
+    Program& program,
+    const LodSelection& lodSelection)
+{
+  SIMPLE3D_PROFILE_ZONE("Renderer::render(Model)");
+  // Largest scale along any of the axes, keeps the bounding spheres and the
+  // errors conservative under non uniform scaling
+  const auto& transform = model.transform_;
+  const auto modelScale = std::max(
+      { glm::length(glm::vec3(transform[0])),
+        glm::length(glm::vec3(transform[1])),
+        glm::length(glm::vec3(transform[2])) });
+
+  // The bounds stay in the model space, the planes are moved there instead
+  meshesVisibility_.assign(model.meshes_.size(), 1);
+  if (frustumCulling_)
+  {
+    const auto modelFrustum = transformFrustum(frustum_, transform);
+    if (model.meshes_.size() < kHierarchicalCullingMinMeshesCount)
+    {
+      model.meshesBounds_.cull(modelFrustum, meshesVisibility_);
+    }
+    else
+    {
+      model.meshesHierarchy_.cull(modelFrustum, meshesVisibility_);
+    }
+  }
+  if (occlusionCulling_)
+  {
+    cullOccludedMeshes(model, modelScale, lodSelection.cameraPosition);
+  }
+
+  const auto drawMesh = [&](size_t meshIndex)
+  {
+    auto& mesh = model.meshes_[meshIndex];
+    const auto lodLevel = selectLod(mesh, transform, modelScale, lodSelection);
+    statistics_.submittedTrianglesCount += countTriangles(mesh, lodLevel);
+    statistics_.fullDetailTrianglesCount += countTriangles(mesh, 0);
+    setVertexDecoding(mesh, program);
+    render(mesh, program, lodLevel);
+  };
+  for (size_t i = 0; i < model.meshes_.size(); ++i)
+  {
+    // Meshes which haven't been uploaded yet are skipped
+    if (!model.meshes_[i].isComplete())
+    {
+      continue;
+    }
+    if (meshesVisibility_[i] == 0)
+    {
+      ++statistics_.culledMeshesCount;
+      continue;
+    }
+    if (!occlusionQueries_)
+    {
+      drawMesh(i);
+    }
+  }
+
+  if (occlusionQueries_)
+  {
+    occlusionQueriesScheduler_.render(
+        model,
+        meshesVisibility_,
+        projectionView_,
+        lodSelection.cameraPosition,
+        drawMesh);
+    statistics_.occlusionQueries = occlusionQueriesScheduler_.getStatistics();
+    statistics_.culledMeshesCount +=
+        statistics_.occlusionQueries.skippedMeshesCount;
+  }
+}
+
+void Renderer::cullOccludedMeshes(
+    const Model& model,
+    const float modelScale,
+    const glm::vec3& cameraPosition)
 {
-  for (auto& mesh : model.meshes_)
+  SIMPLE3D_PROFILE_ZONE("Renderer::cullOccludedMeshes");
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+
+  // Candidates are ranked by how large their bounding spheres appear
+  struct Occluder
+  {
+    float size;
+    size_t meshIndex;
+    size_t lodLevel;
+  };
+  std::vector<Occluder> occluders;
+  for (size_t i = 0; i < model.meshes_.size(); ++i)
+  {
+    const auto& mesh = model.meshes_[i];
+    if (meshesVisibility_[i] == 0 || !mesh.isComplete() ||
+        mesh.indices_.empty())
+    {
+      continue;
+    }
+    const auto& [center, radius] = mesh.boundingSphere_;
+    const auto worldCenter =
+        glm::vec3(model.transform_ * glm::vec4(center, 1.f));
+    const auto centerDistance = glm::length(worldCenter - cameraPosition);
+    // The errors are in the mesh space, same as in selectLod
+    const auto lodLevel = occlusionBuffer_.selectOccluderLod(
+        mesh.lods_, (centerDistance - radius * modelScale) / modelScale);
+    if (countTriangles(mesh, lodLevel) > kMaxOccluderTrianglesCount)
+    {
+      continue;
+    }
+    const auto distance = std::max(centerDistance, radius * modelScale);
+    occluders.push_back({ radius * modelScale / distance, i, lodLevel });
+  }
+  const auto occludersCount = std::min(occluders.size(), kMaxOccludersCount);
+  std::partial_sort(
+      occluders.begin(),
+      occluders.begin() + static_cast<std::ptrdiff_t>(occludersCount),
+      occluders.end(),
+      [](const Occluder& first, const Occluder& second)
+      { return first.size > second.size; });
+
+  // The levels of detail only use a subset of the vertices of the full one,
+  // so an occluder stays within its bounding box and is tested like every
+  // other mesh
+  const auto clipTransform = projectionView_ * model.transform_;
+  occlusionBuffer_.clear();
+  for (size_t i = 0; i < occludersCount; ++i)
+  {
+    const auto& mesh = model.meshes_[occluders[i].meshIndex];
+    const auto lod = mesh.getLod(occluders[i].lodLevel);
+    occlusionBuffer_.addOccluder(
+        mesh.vertices_,
+        std::span(mesh.indices_).subspan(lod.indicesOffset, lod.indicesCount),
+        clipTransform);
+  }
+  occlusionBuffer_.rasterize();
+
+  for (size_t i = 0; i < model.meshes_.size(); ++i)
   {
-    render(mesh, program);
+    if (meshesVisibility_[i] != 0 &&
+        !occlusionBuffer_.isVisible(
+            model.meshes_[i].boundingBox_, clipTransform))
+    {
+      meshesVisibility_[i] = 0;
+      ++statistics_.occludedMeshesCount;
+    }
   }
+  statistics_.occludersCount = occludersCount;
+  statistics_.occluderTrianglesCount = occlusionBuffer_.getTrianglesCount();
+  statistics_.occlusionCullingTime = Clock::now() - start;
+}
+
+size_t Renderer::selectLod(
+    const Mesh& mesh,
+    const glm::mat4x4& modelTransform,
+    const float modelScale,
+    const LodSelection& lodSelection) const
+{
+  if (maxLodError_ <= 0.f || mesh.getLodsCount() == 1)
+  {
+    return 0;
+  }
+
+  // The errors are projected from the point of the bounding sphere closest to
+  // the camera, inside of the sphere only the full detail is good enough
+  const auto& [center, radius] = mesh.boundingSphere_;
+  const auto worldCenter = glm::vec3(modelTransform * glm::vec4(center, 1.f));
+  const auto distance =
+      glm::length(worldCenter - lodSelection.cameraPosition) -
+      radius * modelScale;
+  if (distance <= 0.f)
+  {
+    return 0;
+  }
+
+  const auto pixelsPerUnit =
+      modelScale * lodSelection.projectionScale / distance;
+  return selectLodLevel(mesh.lods_, pixelsPerUnit, maxLodError_);
+}
+
+void Renderer::setVertexDecoding(const Mesh& mesh, Program& program)
+{
+  cache_.modelProgramUniformsCache.vertexDecoding.update(
+      std::make_pair(
+          mesh.vertexLayout_->octahedralNormals, mesh.positionQuantization_),
+      [&mesh, &program]()
+      {
+        program.doOperations(
+            [&mesh](Program& modelProgram)
+            {
+              const auto& [scale, offset] = mesh.positionQuantization_;
+              modelProgram.setVec3f("positionScale", scale);
+              modelProgram.setVec3f("positionOffset", offset);
+              modelProgram.setInt(
+                  "octahedralNormals",
+                  mesh.vertexLayout_->octahedralNormals ? 1 : 0);
+            });
+      });
 }
 
 void Renderer::renderSkybox(
@@ -119,17 +449,24 @@ void Renderer::renderSkybox(
 namespace
 {
 
-void drawPrimitives(const Mesh& mesh)
+const void* indexOffset(size_t value)
+{
+  return std::next(
+      static_cast<const char*>(nullptr), static_cast<std::ptrdiff_t>(value));
+}
+
+void drawPrimitives(const Mesh& mesh, size_t lodLevel)
 {
   glBindVertexArray(mesh.vao_);
 
   if (!mesh.indices_.empty())
   {
+    const auto lod = mesh.getLod(lodLevel);
     glDrawElements(
         GL_TRIANGLES,
-        static_cast<GLsizei>(mesh.indices_.size()),
-        GL_UNSIGNED_INT,
-        nullptr);
+        static_cast<GLsizei>(lod.indicesCount),
+        mesh.indexType_,
+        indexOffset(lod.indicesOffset * mesh.getIndexSize()));
   }
   else
   {
@@ -141,20 +478,21 @@ void drawPrimitives(const Mesh& mesh)
 
 }  // namespace
 
-void Renderer::render(Mesh& mesh, Program& program)
+void Renderer::render(Mesh& mesh, Program& program, const size_t lodLevel)
 {
+  ++statistics_.drawCallsCount;
   if (mesh.material_ == nullptr)
   {
-    program.doOperations([&mesh](const Program& /*program*/)
-                         { drawPrimitives(mesh); });
+    program.doOperations([&mesh, lodLevel](const Program& /*program*/)
+                         { drawPrimitives(mesh, lodLevel); });
     return;
   }
 
   cache_.modelProgramUniformsCache.materialID.update(
       mesh.material_->getId(),
       [&mesh, &program]() { mesh.material_->use(program); });
-  program.doOperations([&mesh](const Program& /*program*/)
-                       { drawPrimitives(mesh); });
+  program.doOperations([&mesh, lodLevel](const Program& /*program*/)
+                       { drawPrimitives(mesh, lodLevel); });
 }
 
 }  // namespace Simple3D
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <cmath>
+#include <simple_3d_viewer/rendering/ResolutionScaler.hpp>
+
+namespace Simple3D
+{
+
+namespace
+{
+
+// Weight of the newest measurement in the smoothed frame time
+constexpr double kSmoothing = 0.2;
+// The measurements lag a few frames behind the rendering, so after a change
+// the controller waits for the ones of the new scale
+constexpr size_t kSettleMeasurementsCount = 8;
+// Below the target the scale only goes up once the frame time is under
+// 1 / kHeadroom of it, otherwise a step up would soon be taken back
+constexpr double kHeadroom = 1.25;
+
+float quantize(float scale)
+{
+  // The epsilon keeps exact multiples from being rounded down a step
+  static constexpr float kEpsilon = 1e-3f;
+  return std::floor(scale / ResolutionScaler::kScaleStep + kEpsilon) *
+         ResolutionScaler::kScaleStep;
+}
+
+}  // namespace
+
+void ResolutionScaler::update(const std::optional<Duration> frameTime)
+{
+  if (settings_.mode == Mode::Pinned)
+  {
+    setScale(settings_.pinnedScale);
+  }
+  else if (frameTime.has_value())
+  {
+    adjust(*frameTime);
+  }
+
+  history_[framesCount_ % kHistorySize] = scale_;
+  ++framesCount_;
+}
+
+Size ResolutionScaler::apply(const Size framebufferSize) const
+{
+  const auto scaleDimension = [this](int dimension)
+  {
+    return std::max(
+        static_cast<int>(std::lround(static_cast<float>(dimension) * scale_)),
+        1);
+  };
+  return { scaleDimension(framebufferSize.width),
+           scaleDimension(framebufferSize.height) };
+}
+
+void ResolutionScaler::setSettings(const Settings& settings)
+{
+  settings_ = settings;
+  // The automatic mode continues from the pinned scale with fresh
+  // measurements
+  measurementsCount_ = 0;
+}
+
+std::vector<float> ResolutionScaler::getHistory() const
+{
+  const auto count = std::min(framesCount_, kHistorySize);
+  std::vector<float> history;
+  history.reserve(count);
+  for (auto i = framesCount_ - count; i < framesCount_; ++i)
+  {
+    history.push_back(history_[i % kHistorySize]);
+  }
+  return history;
+}
+
+void ResolutionScaler::adjust(const Duration frameTime)
+{
+  frameTime_ = measurementsCount_ == 0
+                   ? frameTime
+                   : frameTime_ + (frameTime - frameTime_) * kSmoothing;
+  ++measurementsCount_;
+  if (measurementsCount_ < kSettleMeasurementsCount ||
+      frameTime_.count() <= 0.)
+  {
+    return;
+  }
+
+  const auto ratio = settings_.targetFrameTime / frameTime_;
+  if (ratio >= 1. && ratio <= kHeadroom)
+  {
+    return;
+  }
+  // At least a step in the direction of the target, as the quantization
+  // alone could keep the scale where it is
+  const auto desiredScale =
+      quantize(scale_ * static_cast<float>(std::sqrt(ratio)));
+  setScale(
+      ratio < 1. ? std::min(desiredScale, quantize(scale_ - kScaleStep))
+                 : std::max(desiredScale, quantize(scale_ + kScaleStep)));
+}
+
+void ResolutionScaler::setScale(const float scale)
+{
+  const auto clampedScale = std::clamp(scale, kMinScale, kMaxScale);
+  if (clampedScale == scale_)
+  {
+    return;
+  }
+  scale_ = clampedScale;
+  measurementsCount_ = 0;
+}
+
+}  // namespace Simple3D
@@ -0,0 +1,116 @@
+#include <glad/glad.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <array>
+#include <simple_3d_viewer/utils/HeadlessContext.hpp>
+#include <stdexcept>
+#include <string_view>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+namespace Simple3D
+{
+
+HeadlessContext::HeadlessContext()
+{
+  try
+  {
+    create();
+  }
+  catch (...)
+  {
+    release();
+    throw;
+  }
+}
+
+void HeadlessContext::create()
+{
+  // The surfaceless platform needs neither a display server nor a GPU, the
+  // default display is only the fallback for other implementations
+  const auto getPlatformDisplay =
+      reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+          eglGetProcAddress("eglGetPlatformDisplayEXT"));
+  if (getPlatformDisplay != nullptr)
+  {
+    display_ = getPlatformDisplay(
+        EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+  }
+  if (display_ == EGL_NO_DISPLAY)
+  {
+    display_ = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  }
+  if (display_ == EGL_NO_DISPLAY ||
+      eglInitialize(display_, nullptr, nullptr) == EGL_FALSE)
+  {
+    display_ = EGL_NO_DISPLAY;
+    throw std::runtime_error("Couldn't initialize an EGL display");
+  }
+
+  const std::string_view extensions = eglQueryString(display_, EGL_EXTENSIONS);
+  if (extensions.find("EGL_KHR_surfaceless_context") == std::string_view::npos)
+  {
+    throw std::runtime_error("EGL_KHR_surfaceless_context isn't supported");
+  }
+
+  static constexpr std::array configAttributes{
+    EGL_SURFACE_TYPE, EGL_DONT_CARE, EGL_RENDERABLE_TYPE,
+    EGL_OPENGL_BIT,   EGL_NONE,
+  };
+  EGLConfig config{};
+  EGLint configsCount = 0;
+  if (eglBindAPI(EGL_OPENGL_API) == EGL_FALSE ||
+      eglChooseConfig(
+          display_, configAttributes.data(), &config, 1, &configsCount) ==
+          EGL_FALSE ||
+      configsCount == 0)
+  {
+    throw std::runtime_error("No EGL config supports desktop OpenGL");
+  }
+
+  // Same version and profile as the viewer asks GLFW for
+  static constexpr std::array contextAttributes{
+    EGL_CONTEXT_MAJOR_VERSION,
+    3,
+    EGL_CONTEXT_MINOR_VERSION,
+    3,
+    EGL_CONTEXT_OPENGL_PROFILE_MASK,
+    EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+    EGL_NONE,
+  };
+  context_ = eglCreateContext(
+      display_, config, EGL_NO_CONTEXT, contextAttributes.data());
+  if (context_ == EGL_NO_CONTEXT ||
+      eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, context_) ==
+          EGL_FALSE)
+  {
+    throw std::runtime_error("Couldn't create an OpenGL 3.3 core context");
+  }
+  if (gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress)) ==
+      0)
+  {
+    throw std::runtime_error("Couldn't load the OpenGL functions");
+  }
+}
+
+void HeadlessContext::release()
+{
+  if (display_ == EGL_NO_DISPLAY)
+  {
+    return;
+  }
+  eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  if (context_ != EGL_NO_CONTEXT)
+  {
+    eglDestroyContext(display_, context_);
+    context_ = EGL_NO_CONTEXT;
+  }
+  eglTerminate(display_);
+  display_ = EGL_NO_DISPLAY;
+}
+
+}  // namespace Simple3D
@@ -0,0 +1,187 @@
+#include <fmt/format.h>
+#include <simple_3d_viewer/utils/MappedFile.hpp>
+#include <stdexcept>
+#include <utility>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Simple3D
+{
+
+namespace
+{
+
+std::string failureMessage(const std::filesystem::path& filePath)
+{
+  return fmt::format("Failed to map file at path: {}", filePath.string());
+}
+
+}  // namespace
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path& filePath)
+{
+  HANDLE file = CreateFileW(
+      filePath.c_str(),
+      GENERIC_READ,
+      FILE_SHARE_READ,
+      nullptr,
+      OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL,
+      nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    throw std::invalid_argument(failureMessage(filePath));
+  }
+  fileHandle_ = file;
+
+  LARGE_INTEGER fileSize{};
+  if (GetFileSizeEx(file, &fileSize) == 0 || fileSize.QuadPart == 0)
+  {
+    release();
+    throw std::invalid_argument(failureMessage(filePath));
+  }
+  size_ = static_cast<size_t>(fileSize.QuadPart);
+
+  mappingHandle_ =
+      CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mappingHandle_ == nullptr)
+  {
+    release();
+    throw std::invalid_argument(failureMessage(filePath));
+  }
+
+  data_ = static_cast<const std::byte*>(
+      MapViewOfFile(mappingHandle_, FILE_MAP_READ, 0, 0, 0));
+  if (data_ == nullptr)
+  {
+    release();
+    throw std::invalid_argument(failureMessage(filePath));
+  }
+}
+
+void MappedFile::release()
+{
+  if (data_ != nullptr)
+  {
+    UnmapViewOfFile(data_);
+  }
+  if (mappingHandle_ != nullptr)
+  {
+    CloseHandle(mappingHandle_);
+  }
+  if (fileHandle_ != nullptr)
+  {
+    CloseHandle(fileHandle_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  mappingHandle_ = nullptr;
+  fileHandle_ = nullptr;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      fileHandle_(std::exchange(other.fileHandle_, nullptr)),
+      mappingHandle_(std::exchange(other.mappingHandle_, nullptr))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+  if (this == &other)
+  {
+    return *this;
+  }
+
+  release();
+
+  using std::swap;
+
+  swap(data_, other.data_);
+  swap(size_, other.size_);
+  swap(fileHandle_, other.fileHandle_);
+  swap(mappingHandle_, other.mappingHandle_);
+
+  return *this;
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& filePath)
+{
+  const int file = open(filePath.c_str(), O_RDONLY);
+  if (file == -1)
+  {
+    throw std::invalid_argument(failureMessage(filePath));
+  }
+
+  struct stat fileStatus
+  {
+  };
+  if (fstat(file, &fileStatus) == -1 || fileStatus.st_size == 0)
+  {
+    close(file);
+    throw std::invalid_argument(failureMessage(filePath));
+  }
+  size_ = static_cast<size_t>(fileStatus.st_size);
+
+  void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file, 0);
+  // The mapping stays valid after the descriptor is closed
+  close(file);
+  if (data == MAP_FAILED)
+  {
+    size_ = 0;
+    throw std::invalid_argument(failureMessage(filePath));
+  }
+  data_ = static_cast<const std::byte*>(data);
+}
+
+void MappedFile::release()
+{
+  if (data_ == nullptr)
+  {
+    return;
+  }
+
+  munmap(const_cast<std::byte*>(data_), size_);
+  data_ = nullptr;
+  size_ = 0;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+  if (this == &other)
+  {
+    return *this;
+  }
+
+  release();
+
+  using std::swap;
+
+  swap(data_, other.data_);
+  swap(size_, other.size_);
+
+  return *this;
+}
+
+#endif
+
+}  // namespace Simple3D
@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <fmt/format.h>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <simple_3d_viewer/utils/Profiler.hpp>
+#include <simple_3d_viewer/utils/jsonEscaping.hpp>
+#include <stdexcept>
+#include <vector>
+
+namespace Simple3D
+{
+
+struct Profiler::ThreadZones
+{
+  struct Record
+  {
+    const char* name;
+    Clock::time_point start;
+    Clock::time_point end;
+  };
+
+  // The fields are atomic since exporting reads the slots while the thread
+  // overwrites them, relaxed accesses cost as much as plain ones
+  struct Slot
+  {
+    std::atomic<const char*> name;
+    std::atomic<Clock::rep> start;
+    std::atomic<Clock::rep> end;
+  };
+
+  // Guarded by the mutex of the registry
+  uint32_t threadId{};
+  std::string threadName;
+  std::array<Slot, kZonesCapacity> slots{};
+  // Records written so far, the ones before writtenCount - kZonesCapacity
+  // have been overwritten
+  std::atomic<uint64_t> writtenCount{ 0 };
+};
+
+// Buffers of threads that have ended are kept, so their zones still get
+// exported, until a new thread takes them over. Threads are started for every
+// model load, so a buffer for each would grow without bound.
+struct Profiler::Registry
+{
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadZones>> threadsZones;
+  std::vector<ThreadZones*> freeThreadsZones;
+  uint32_t nextThreadId{ 0 };
+  Clock::time_point start{ Clock::now() };
+};
+
+void Profiler::setThreadName(std::string name)
+{
+  auto& threadZones = getThreadZones();
+  const std::scoped_lock lock(getRegistry().mutex);
+  threadZones.threadName = std::move(name);
+}
+
+size_t Profiler::exportChromeTrace(const std::filesystem::path& path)
+{
+  std::ofstream out(path, std::ios::out | std::ios::trunc);
+  if (!out.is_open())
+  {
+    throw std::invalid_argument(fmt::format(
+        "Couldn't open {} for writing",
+        std::filesystem::absolute(path).string()));
+  }
+
+  auto& registry = getRegistry();
+  const auto toMicroseconds = [start = registry.start](Clock::time_point time)
+  {
+    return std::chrono::duration<double, std::micro>(time - start).count();
+  };
+  out << R"({"displayTimeUnit":"ms","traceEvents":[)";
+  bool first = true;
+  const auto writeEvent = [&out, &first](const std::string& event)
+  {
+    out << (first ? "\n" : ",\n") << event;
+    first = false;
+  };
+
+  size_t zonesCount = 0;
+  std::vector<ThreadZones::Record> records;
+  const std::scoped_lock lock(registry.mutex);
+  for (const auto& threadZones : registry.threadsZones)
+  {
+    if (!threadZones->threadName.empty())
+    {
+      writeEvent(fmt::format(
+          R"({{"name":"thread_name","ph":"M","pid":0,"tid":{},)"
+          R"("args":{{"name":"{}"}}}})",
+          threadZones->threadId,
+          escapeJson(threadZones->threadName)));
+    }
+
+    // Copied first and then checked against the records written meanwhile,
+    // the thread keeps writing into its buffer during the copy. The fence
+    // pairs with the one in record, seeing any field of a record being
+    // written makes the count from before it visible.
+    const auto writtenCount =
+        threadZones->writtenCount.load(std::memory_order_acquire);
+    const auto firstRecord =
+        writtenCount > kZonesCapacity ? writtenCount - kZonesCapacity : 0;
+    records.clear();
+    for (auto i = firstRecord; i < writtenCount; ++i)
+    {
+      const auto& slot = threadZones->slots[i % kZonesCapacity];
+      records.push_back(
+          { slot.name.load(std::memory_order_relaxed),
+            Clock::time_point(
+                Clock::duration(slot.start.load(std::memory_order_relaxed))),
+            Clock::time_point(
+                Clock::duration(slot.end.load(std::memory_order_relaxed))) });
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const auto writtenCountAfterCopy =
+        threadZones->writtenCount.load(std::memory_order_relaxed);
+    const auto firstIntactRecord = writtenCountAfterCopy >= kZonesCapacity
+                                       ? writtenCountAfterCopy -
+                                             kZonesCapacity + 1
+                                       : 0;
+
+    for (auto i = std::max(firstRecord, firstIntactRecord); i < writtenCount;
+         ++i)
+    {
+      const auto& record = records[i - firstRecord];
+      writeEvent(fmt::format(
+          R"({{"name":"{}","ph":"X","pid":0,"tid":{},)"
+          R"("ts":{:.3f},"dur":{:.3f}}})",
+          record.name,
+          threadZones->threadId,
+          toMicroseconds(record.start),
+          toMicroseconds(record.end) - toMicroseconds(record.start)));
+      ++zonesCount;
+    }
+  }
+  out << "\n]}\n";
+  return zonesCount;
+}
+
+void Profiler::record(
+    const char* name,
+    const Clock::time_point start,
+    const Clock::time_point end)
+{
+  auto& threadZones = getThreadZones();
+  // Only this thread writes the count, the release publishes the record to
+  // the exporting thread. The fence orders the count of the records before
+  // this one ahead of overwriting the slot.
+  const auto index = threadZones.writtenCount.load(std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  auto& slot = threadZones.slots[index % kZonesCapacity];
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.start.store(
+      start.time_since_epoch().count(), std::memory_order_relaxed);
+  slot.end.store(end.time_since_epoch().count(), std::memory_order_relaxed);
+  threadZones.writtenCount.store(index + 1, std::memory_order_release);
+}
+
+Profiler::ThreadZones& Profiler::getThreadZones()
+{
+  // Takes a buffer on the first zone of the thread and gives it back when
+  // the thread ends
+  struct Lease
+  {
+    Lease()
+    {
+      auto& registry = getRegistry();
+      const std::scoped_lock lock(registry.mutex);
+      if (registry.freeThreadsZones.empty())
+      {
+        threadZones =
+            registry.threadsZones.emplace_back(std::make_unique<ThreadZones>())
+                .get();
+      }
+      else
+      {
+        // The zones of the ended thread are dropped, exporting holds the
+        // mutex so it doesn't see them go
+        threadZones = registry.freeThreadsZones.back();
+        registry.freeThreadsZones.pop_back();
+        threadZones->threadName.clear();
+        threadZones->writtenCount.store(0, std::memory_order_relaxed);
+      }
+      threadZones->threadId = registry.nextThreadId++;
+    }
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+    Lease(Lease&&) = delete;
+    Lease& operator=(Lease&&) = delete;
+    ~Lease()
+    {
+      auto& registry = getRegistry();
+      const std::scoped_lock lock(registry.mutex);
+      registry.freeThreadsZones.push_back(threadZones);
+    }
+
+    ThreadZones* threadZones;
+  };
+
+  thread_local Lease lease;
+  return *lease.threadZones;
+}
+
+Profiler::Registry& Profiler::getRegistry()
+{
+  static Registry registry;
+  return registry;
+}
+
+}  // namespace Simple3D
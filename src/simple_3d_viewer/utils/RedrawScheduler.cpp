@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <simple_3d_viewer/utils/Profiler.hpp>
+#include <simple_3d_viewer/utils/RedrawScheduler.hpp>
+
+namespace Simple3D
+{
+
+namespace
+{
+
+RedrawScheduler& getScheduler(GLFWwindow* window)
+{
+  return *static_cast<RedrawScheduler*>(glfwGetWindowUserPointer(window));
+}
+
+}  // namespace
+
+void RedrawScheduler::watch(GLFWwindow* window)
+{
+  glfwSetWindowUserPointer(window, this);
+
+  // Any input may change the GUI, whether it also changes the scene is
+  // decided while the frame is built
+  glfwSetKeyCallback(
+      window,
+      [](GLFWwindow* eventWindow, int, int, int, int)
+      { getScheduler(eventWindow).requestGuiRedraw(); });
+  glfwSetCharCallback(
+      window,
+      [](GLFWwindow* eventWindow, unsigned int)
+      { getScheduler(eventWindow).requestGuiRedraw(); });
+  glfwSetMouseButtonCallback(
+      window,
+      [](GLFWwindow* eventWindow, int, int, int)
+      { getScheduler(eventWindow).requestGuiRedraw(); });
+  glfwSetCursorPosCallback(
+      window,
+      [](GLFWwindow* eventWindow, double, double)
+      { getScheduler(eventWindow).requestGuiRedraw(); });
+  glfwSetCursorEnterCallback(
+      window,
+      [](GLFWwindow* eventWindow, int)
+      { getScheduler(eventWindow).requestGuiRedraw(); });
+  glfwSetScrollCallback(
+      window,
+      [](GLFWwindow* eventWindow, double, double)
+      { getScheduler(eventWindow).requestGuiRedraw(); });
+  glfwSetWindowFocusCallback(
+      window,
+      [](GLFWwindow* eventWindow, int)
+      { getScheduler(eventWindow).requestGuiRedraw(); });
+  glfwSetWindowRefreshCallback(
+      window,
+      [](GLFWwindow* eventWindow)
+      { getScheduler(eventWindow).requestGuiRedraw(); });
+
+  glfwSetFramebufferSizeCallback(
+      window,
+      [](GLFWwindow* eventWindow, int, int)
+      { getScheduler(eventWindow).requestSceneRedraw(); });
+  glfwSetWindowIconifyCallback(
+      window,
+      [](GLFWwindow* eventWindow, int)
+      { getScheduler(eventWindow).requestSceneRedraw(); });
+}
+
+RedrawScheduler::Redraw RedrawScheduler::getRedraw() const
+{
+  if (!onDemand_ || sceneRedrawRequested_.load(std::memory_order_relaxed))
+  {
+    return Redraw::Scene;
+  }
+  return guiFramesLeft_.load(std::memory_order_relaxed) > 0 ? Redraw::Gui
+                                                            : Redraw::None;
+}
+
+void RedrawScheduler::startFrame(Redraw redraw)
+{
+  if (redraw == Redraw::Scene)
+  {
+    sceneRedrawRequested_.store(false, std::memory_order_relaxed);
+    ++renderedFramesCount_;
+  }
+  auto framesLeft = guiFramesLeft_.load(std::memory_order_relaxed);
+  while (framesLeft > 0 && !guiFramesLeft_.compare_exchange_weak(
+                               framesLeft, framesLeft - 1))
+  {
+  }
+  ++presentedFramesCount_;
+  updateStatistics();
+}
+
+void RedrawScheduler::waitForEvents()
+{
+  SIMPLE3D_PROFILE_ZONE("RedrawScheduler::waitForEvents");
+  const auto waitStart = glfwGetTime();
+  glfwWaitEventsTimeout(kMaxWaitSeconds);
+  const auto waitTime = glfwGetTime() - waitStart;
+  idleTime_ += waitTime;
+  if (waitTime >= kMaxWaitSeconds)
+  {
+    // One frame refreshing the reports, unless more were requested
+    auto framesLeft = 0;
+    guiFramesLeft_.compare_exchange_strong(framesLeft, 1);
+  }
+  updateStatistics();
+}
+
+void RedrawScheduler::updateStatistics()
+{
+  static constexpr double kPeriodSeconds = 1.;
+  const auto now = glfwGetTime();
+  const auto period = now - periodStart_;
+  if (period < kPeriodSeconds)
+  {
+    return;
+  }
+
+  const auto cpuNow = getProcessCpuTime();
+  const auto cpuTime = cpuNow - periodCpuStart_;
+  statistics_ = { static_cast<double>(renderedFramesCount_) / period,
+                  static_cast<double>(presentedFramesCount_) / period,
+                  std::min(idleTime_ / period, 1.),
+                  cpuTime / period };
+  periodStart_ = now;
+  periodCpuStart_ = cpuNow;
+  renderedFramesCount_ = 0;
+  presentedFramesCount_ = 0;
+  idleTime_ = 0.;
+}
+
+}  // namespace Simple3D
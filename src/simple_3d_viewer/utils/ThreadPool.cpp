@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <simple_3d_viewer/utils/Profiler.hpp>
+#include <simple_3d_viewer/utils/ThreadPool.hpp>
+#include <string>
+
+namespace Simple3D
+{
+
+ThreadPool::ThreadPool(size_t workersCount)
+{
+  workers_.reserve(workersCount);
+  for (size_t i = 0; i < workersCount; ++i)
+  {
+    workers_.emplace_back(
+        [this, i]()
+        {
+          SIMPLE3D_PROFILE_THREAD("Worker " + std::to_string(i));
+          workerLoop();
+        });
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    const std::scoped_lock lock(jobsMutex_);
+    stopping_ = true;
+  }
+  jobsCondition_.notify_all();
+  // std::jthread joins on destruction
+  workers_.clear();
+}
+
+void ThreadPool::parallelFor(
+    size_t count,
+    const std::function<void(size_t)>& function)
+{
+  if (count == 0)
+  {
+    return;
+  }
+  if (count == 1 || workers_.empty())
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      function(i);
+    }
+    return;
+  }
+
+  auto job = std::make_shared<Job>();
+  job->function = &function;
+  job->count = count;
+  {
+    const std::scoped_lock lock(jobsMutex_);
+    jobs_.push_back(job);
+  }
+  jobsCondition_.notify_all();
+
+  execute(*job);
+
+  // Other threads might still be working on indices they have claimed
+  auto finishedCount = job->finishedCount.load();
+  while (finishedCount != count)
+  {
+    job->finishedCount.wait(finishedCount);
+    finishedCount = job->finishedCount.load();
+  }
+
+  {
+    const std::scoped_lock lock(jobsMutex_);
+    std::erase(jobs_, job);
+  }
+
+  if (job->exception)
+  {
+    std::rethrow_exception(job->exception);
+  }
+}
+
+void ThreadPool::workerLoop()
+{
+  while (true)
+  {
+    std::shared_ptr<Job> job;
+    {
+      std::unique_lock lock(jobsMutex_);
+      jobsCondition_.wait(
+          lock,
+          [this]()
+          {
+            return stopping_ ||
+                   std::ranges::any_of(
+                       jobs_,
+                       [](const std::shared_ptr<Job>& it)
+                       { return it->nextIndex.load() < it->count; });
+          });
+      if (stopping_)
+      {
+        return;
+      }
+      job = *std::ranges::find_if(
+          jobs_,
+          [](const std::shared_ptr<Job>& it)
+          { return it->nextIndex.load() < it->count; });
+    }
+
+    execute(*job);
+  }
+}
+
+void ThreadPool::execute(Job& job)
+{
+  for (auto i = job.nextIndex.fetch_add(1); i < job.count;
+       i = job.nextIndex.fetch_add(1))
+  {
+    try
+    {
+      (*job.function)(i);
+    }
+    catch (...)
+    {
+      const std::scoped_lock lock(job.exceptionMutex);
+      if (!job.exception)
+      {
+        job.exception = std::current_exception();
+      }
+    }
+
+    if (job.finishedCount.fetch_add(1) + 1 == job.count)
+    {
+      job.finishedCount.notify_all();
+    }
+  }
+}
+
+ThreadPool& getThreadPool()
+{
+  static ThreadPool threadPool(
+      std::max(std::thread::hardware_concurrency(), 1u) - 1);
+  return threadPool;
+}
+
+}  // namespace Simple3D
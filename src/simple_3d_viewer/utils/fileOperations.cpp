@@ -1,13 +1,71 @@
+#include <algorithm>
+#include <cstddef>
 #include <filesystem>
 #include <fmt/format.h>
 #include <fstream>
+#include <iterator>
 #include <simple_3d_viewer/utils/fileOperations.hpp>
 #include <stb_image.h>
 #include <string>
+#include <system_error>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <cstdint>
+#include <cstring>
+#include <mach-o/dyld.h>
+#endif
 
 namespace Simple3D
 {
 
+namespace
+{
+
+void swapRows(uint8_t* lhs, uint8_t* rhs, const std::ptrdiff_t rowSize)
+{
+  std::ptrdiff_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+  static constexpr auto kRegisterSize =
+      static_cast<std::ptrdiff_t>(sizeof(__m128i));
+  for (; i + kRegisterSize <= rowSize; i += kRegisterSize)
+  {
+    auto* lhsChunk = reinterpret_cast<__m128i*>(std::next(lhs, i));
+    auto* rhsChunk = reinterpret_cast<__m128i*>(std::next(rhs, i));
+    const __m128i lhsValue = _mm_loadu_si128(lhsChunk);
+    const __m128i rhsValue = _mm_loadu_si128(rhsChunk);
+    _mm_storeu_si128(lhsChunk, rhsValue);
+    _mm_storeu_si128(rhsChunk, lhsValue);
+  }
+#endif
+  std::swap_ranges(
+      std::next(lhs, i), std::next(lhs, rowSize), std::next(rhs, i));
+}
+
+}  // namespace
+
+void flipImageVertically(
+    uint8_t* image,
+    const Size size,
+    const int colorChannelCount)
+{
+  const auto rowSize = static_cast<std::ptrdiff_t>(size.width) *
+                       static_cast<std::ptrdiff_t>(colorChannelCount);
+  for (std::ptrdiff_t top = 0, bottom = size.height - 1; top < bottom;
+       ++top, --bottom)
+  {
+    swapRows(
+        std::next(image, top * rowSize),
+        std::next(image, bottom * rowSize),
+        rowSize);
+  }
+}
+
 std::string loadFileIntoString(const std::filesystem::path& filePath)
 {
   std::ifstream in(filePath, std::ios::in | std::ios::binary);
@@ -27,6 +85,48 @@ std::string loadFileIntoString(const std::filesystem::path& filePath)
   return file;
 }
 
+std::filesystem::path getExecutableDirPath()
+{
+#ifdef _WIN32
+  std::wstring path(MAX_PATH, L'\0');
+  while (true)
+  {
+    const auto length = GetModuleFileNameW(
+        nullptr, path.data(), static_cast<DWORD>(path.size()));
+    if (length == 0)
+    {
+      return std::filesystem::current_path();
+    }
+    // A truncated path fills the whole buffer
+    if (length < path.size())
+    {
+      path.resize(length);
+      break;
+    }
+    path.resize(path.size() * 2);
+  }
+  return std::filesystem::path(path).parent_path();
+#elif defined(__APPLE__)
+  uint32_t size = 0;
+  _NSGetExecutablePath(nullptr, &size);
+  std::string path(size, '\0');
+  if (_NSGetExecutablePath(path.data(), &size) != 0)
+  {
+    return std::filesystem::current_path();
+  }
+  path.resize(std::strlen(path.c_str()));
+  return std::filesystem::path(path).parent_path();
+#else
+  std::error_code error;
+  const auto path = std::filesystem::read_symlink("/proc/self/exe", error);
+  if (error)
+  {
+    return std::filesystem::current_path();
+  }
+  return path.parent_path();
+#endif
+}
+
 Image loadImage(
     const std::filesystem::path& filePath,
     const bool flipVertically)
@@ -34,14 +134,9 @@ Image loadImage(
   int width{};
   int height{};
   int colorChannelCount{};
-  if (flipVertically)
-  {
-    stbi_set_flip_vertically_on_load(1);
-  }
-  else
-  {
-    stbi_set_flip_vertically_on_load(0);
-  }
+  // stbi_set_flip_vertically_on_load is process wide state, images are
+  // always decoded unflipped and flipped afterwards so that decoding can
+  // happen on any number of threads at once
   uint8_t* image =
       stbi_load(filePath.c_str(), &width, &height, &colorChannelCount, 0);
   if (image == nullptr)
@@ -49,6 +144,10 @@ Image loadImage(
     throw std::invalid_argument(
         fmt::format("Failed to load image at path: {}", filePath.c_str()));
   }
+  if (flipVertically)
+  {
+    flipImageVertically(image, { width, height }, colorChannelCount);
+  }
   return { image, { width, height }, colorChannelCount };
 }
 
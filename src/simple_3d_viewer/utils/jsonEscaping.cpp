@@ -0,0 +1,51 @@
+#include <fmt/format.h>
+#include <simple_3d_viewer/utils/jsonEscaping.hpp>
+
+namespace Simple3D
+{
+
+std::string escapeJson(std::string_view text)
+{
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (const auto character : text)
+  {
+    switch (character)
+    {
+      case '"':
+        escaped += R"(\")";
+        break;
+      case '\\':
+        escaped += R"(\\)";
+        break;
+      case '\b':
+        escaped += R"(\b)";
+        break;
+      case '\f':
+        escaped += R"(\f)";
+        break;
+      case '\n':
+        escaped += R"(\n)";
+        break;
+      case '\r':
+        escaped += R"(\r)";
+        break;
+      case '\t':
+        escaped += R"(\t)";
+        break;
+      default:
+        if (static_cast<unsigned char>(character) < 0x20)
+        {
+          escaped += fmt::format(
+              R"(\u{:04x})", static_cast<unsigned char>(character));
+        }
+        else
+        {
+          escaped.push_back(character);
+        }
+    }
+  }
+  return escaped;
+}
+
+}  // namespace Simple3D
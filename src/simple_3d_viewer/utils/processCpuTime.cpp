@@ -0,0 +1,54 @@
+#include <simple_3d_viewer/utils/processCpuTime.hpp>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace Simple3D
+{
+
+#ifdef _WIN32
+
+double getProcessCpuTime()
+{
+  FILETIME creationTime;
+  FILETIME exitTime;
+  FILETIME kernelTime;
+  FILETIME userTime;
+  if (GetProcessTimes(
+          GetCurrentProcess(),
+          &creationTime,
+          &exitTime,
+          &kernelTime,
+          &userTime) == 0)
+  {
+    return 0.;
+  }
+  // In 100 ns units
+  const auto toTicks = [](const FILETIME& time)
+  {
+    return (static_cast<unsigned long long>(time.dwHighDateTime) << 32) |
+           time.dwLowDateTime;
+  };
+  return static_cast<double>(toTicks(kernelTime) + toTicks(userTime)) * 1e-7;
+}
+
+#else
+
+double getProcessCpuTime()
+{
+  timespec time{};
+  if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0)
+  {
+    return 0.;
+  }
+  return static_cast<double>(time.tv_sec) +
+         static_cast<double>(time.tv_nsec) * 1e-9;
+}
+
+#endif
+
+}  // namespace Simple3D
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <simple_3d_viewer/rendering/Model.hpp>
+#include <simple_3d_viewer/rendering/ModelCache.hpp>
+#include <vector>
+
+namespace Simple3D
+{
+namespace
+{
+// A single triangle, so its 3 indices are the last blob of the entry and
+// fill the first 12 of the last 16 aligned bytes
+std::filesystem::path writeTriangleModel()
+{
+  auto path = std::filesystem::temp_directory_path() /
+              "simple3d_ModelCache_test.obj";
+  std::ofstream out(path);
+  out << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+  return path;
+}
+
+Model::Configuration createConfiguration()
+{
+  // Neither reorders nor adds indices
+  Model::Configuration configuration;
+  configuration.set(Model::Configuration::Flag::UseModelCache, true);
+  configuration.set(Model::Configuration::Flag::OptimizeMeshes, false);
+  configuration.set(Model::Configuration::Flag::GenerateLods, false);
+  return configuration;
+}
+
+std::vector<char> readFile(const std::filesystem::path& path)
+{
+  std::ifstream in(path, std::ios::binary);
+  return { std::istreambuf_iterator<char>(in),
+           std::istreambuf_iterator<char>() };
+}
+
+void writeFile(const std::filesystem::path& path, const std::vector<char>& data)
+{
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+}  // namespace
+
+TEST(ModelCacheTest, IgnoresEntryWithOutOfRangeIndex)
+{
+  const auto modelFilePath = writeTriangleModel();
+  const auto configuration = createConfiguration();
+  const auto key = createModelCacheKey(
+      modelFilePath, configuration.getOutputAffectingFlags());
+  ASSERT_TRUE(key.has_value());
+  removeModelCache(*key);
+
+  {
+    const Model model(modelFilePath, configuration);
+    ASSERT_FALSE(model.getLoadStatistics().loadedFromCache);
+  }
+  {
+    const auto cachedModel = readModelCache(*key);
+    ASSERT_TRUE(cachedModel.has_value());
+    ASSERT_EQ(cachedModel->meshes.size(), 1);
+    ASSERT_EQ(cachedModel->meshes[0].vertices.size(), 3);
+    ASSERT_EQ(cachedModel->meshes[0].indices.size(), 3);
+  }
+
+  // The framing stays intact, only the index points past the vertices
+  const auto cacheFilePath = getModelCacheFilePath(*key);
+  auto data = readFile(cacheFilePath);
+  ASSERT_GE(data.size(), 16);
+  const uint32_t outOfRangeIndex = 3;
+  std::memcpy(
+      data.data() + data.size() - 16, &outOfRangeIndex, sizeof(uint32_t));
+  writeFile(cacheFilePath, data);
+
+  EXPECT_FALSE(readModelCache(*key).has_value());
+  const Model model(modelFilePath, configuration);
+  EXPECT_FALSE(model.getLoadStatistics().loadedFromCache);
+
+  removeModelCache(*key);
+  std::filesystem::remove(modelFilePath);
+}
+
+}  // namespace Simple3D
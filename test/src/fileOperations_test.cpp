@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <simple_3d_viewer/utils/fileOperations.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Simple3D
+{
+namespace
+{
+constexpr int kImageSide = 256;
+constexpr size_t kThreadsCount = 8;
+constexpr size_t kDecodesPerThreadCount = 16;
+
+// Uncompressed 32 bit TGA of random pixels
+std::filesystem::path writeImage()
+{
+  auto path = std::filesystem::temp_directory_path() /
+              "simple3d_fileOperations_test.tga";
+  const auto sideLow = static_cast<char>(kImageSide & 0xFF);
+  const auto sideHigh = static_cast<char>((kImageSide >> 8) & 0xFF);
+  // Type 2 is uncompressed true color, the 8 is the alpha channel depth
+  const std::array<char, 18> header{
+    0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, sideLow, sideHigh, sideLow, sideHigh,
+    32, 8,
+  };
+  const auto sideSize = static_cast<size_t>(kImageSide);
+  std::vector<char> pixels(sideSize * sideSize * 4);
+  std::minstd_rand generator(42);
+  for (auto& pixel : pixels)
+  {
+    pixel = static_cast<char>(generator());
+  }
+
+  std::ofstream out(path, std::ios::binary);
+  out.write(header.data(), header.size());
+  out.write(pixels.data(), static_cast<std::streamsize>(pixels.size()));
+  return path;
+}
+
+std::vector<uint8_t> decodeImage(
+    const std::filesystem::path& path,
+    const bool flipVertically)
+{
+  const auto image = loadImage(path, flipVertically);
+  const auto bytesCount = static_cast<size_t>(image.size.width) *
+                          static_cast<size_t>(image.size.height) *
+                          static_cast<size_t>(image.colorChannelCount);
+  return { image.image, image.image + bytesCount };
+}
+}  // namespace
+
+// Flipping used to go through the process wide flag of stb_image, which
+// mixed up the images of threads decoding at the same time
+TEST(FileOperationsTest, ConcurrentImageDecodesMatchSerialOnes)
+{
+  const auto path = writeImage();
+  const std::array<std::vector<uint8_t>, 2> serialDecodes{
+    decodeImage(path, false), decodeImage(path, true)
+  };
+  ASSERT_EQ(serialDecodes[0].size(), size_t{ kImageSide * kImageSide * 4 });
+  ASSERT_NE(serialDecodes[0], serialDecodes[1]);
+
+  // Written by each thread only, checked after they are joined
+  std::vector<size_t> mismatchesCounts(kThreadsCount);
+  {
+    std::vector<std::jthread> threads;
+    for (size_t thread = 0; thread < kThreadsCount; ++thread)
+    {
+      threads.emplace_back(
+          [&path, &serialDecodes, &mismatchesCounts, thread]()
+          {
+            for (size_t i = 0; i < kDecodesPerThreadCount; ++i)
+            {
+              const auto flip = (thread + i) % 2;
+              if (decodeImage(path, flip != 0) != serialDecodes[flip])
+              {
+                ++mismatchesCounts[thread];
+              }
+            }
+          });
+    }
+  }
+  for (size_t thread = 0; thread < kThreadsCount; ++thread)
+  {
+    EXPECT_EQ(mismatchesCounts[thread], 0) << "Thread " << thread;
+  }
+  std::filesystem::remove(path);
+}
+
+}  // namespace Simple3D
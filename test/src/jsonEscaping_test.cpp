@@ -0,0 +1,31 @@
+#include <gtest/gtest.h>
+
+#include <simple_3d_viewer/utils/jsonEscaping.hpp>
+#include <string>
+
+namespace Simple3D
+{
+
+TEST(JsonEscapingTest, KeepsPlainText)
+{
+  EXPECT_EQ(escapeJson("models/Sponza glTF.gltf"), "models/Sponza glTF.gltf");
+  // UTF-8 bytes aren't control characters
+  const std::string utf8Text{ "\xc5\xbc\xc3\xb3\xc5\x82w" };
+  EXPECT_EQ(escapeJson(utf8Text), utf8Text);
+}
+
+TEST(JsonEscapingTest, EscapesQuotesAndBackslashes)
+{
+  EXPECT_EQ(
+      escapeJson(R"(C:\models\"quoted".obj)"),
+      R"(C:\\models\\\"quoted\".obj)");
+}
+
+TEST(JsonEscapingTest, EscapesControlCharacters)
+{
+  EXPECT_EQ(escapeJson("a\nb\tc\r"), R"(a\nb\tc\r)");
+  EXPECT_EQ(escapeJson(std::string("\x01\x1f", 2)), R"(\u0001\u001f)");
+  EXPECT_EQ(escapeJson(std::string(1, '\0')), R"(\u0000)");
+}
+
+}  // namespace Simple3D
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+#include <numbers>
+#include <simple_3d_viewer/linear_algebra/Transform.hpp>
+#include <simple_3d_viewer/linear_algebra/meshSimplification.hpp>
+#include <simple_3d_viewer/linear_algebra/occlusionCulling.hpp>
+#include <span>
+#include <vector>
+
+namespace Simple3D
+{
+namespace
+{
+constexpr Size kFramebufferSize{ 1280, 720 };
+constexpr float kCameraDistance = 3.f;
+
+// A thick, coarse torus around the z axis, its levels of detail bridge the
+// hole
+struct Torus
+{
+  static constexpr uint32_t kMajorSegmentsCount = 32;
+  static constexpr uint32_t kMinorSegmentsCount = 8;
+  static constexpr float kMajorRadius = 1.f;
+  static constexpr float kMinorRadius = 0.25f;
+
+  Torus()
+  {
+    constexpr auto kTau = 2.f * std::numbers::pi_v<float>;
+    for (uint32_t i = 0; i < kMajorSegmentsCount; ++i)
+    {
+      for (uint32_t j = 0; j < kMinorSegmentsCount; ++j)
+      {
+        const auto u = kTau * static_cast<float>(i) / kMajorSegmentsCount;
+        const auto v = kTau * static_cast<float>(j) / kMinorSegmentsCount;
+        const auto ringRadius = kMajorRadius + kMinorRadius * std::cos(v);
+        Vertex vertex{};
+        vertex.position = { ringRadius * std::cos(u),
+                            ringRadius * std::sin(u),
+                            kMinorRadius * std::sin(v) };
+        vertices.push_back(vertex);
+      }
+    }
+    for (uint32_t i = 0; i < kMajorSegmentsCount; ++i)
+    {
+      const auto nextI = (i + 1) % kMajorSegmentsCount;
+      for (uint32_t j = 0; j < kMinorSegmentsCount; ++j)
+      {
+        const auto nextJ = (j + 1) % kMinorSegmentsCount;
+        const auto a = i * kMinorSegmentsCount + j;
+        const auto b = nextI * kMinorSegmentsCount + j;
+        const auto c = nextI * kMinorSegmentsCount + nextJ;
+        const auto d = i * kMinorSegmentsCount + nextJ;
+        indices.insert(indices.end(), { a, b, c, a, c, d });
+      }
+    }
+    lods = generateLods(vertices, indices, false);
+  }
+
+  std::vector<Vertex> vertices;
+  std::vector<uint32_t> indices;
+  std::vector<MeshLod> lods;
+};
+
+// Seen head-on through the hole, behind the torus
+constexpr AxisAlignedBox kBoxInHole{ { 0.25f, 0.5f, -0.55f },
+                                     { 0.35f, 0.6f, -0.45f } };
+// Fully behind the ring
+constexpr AxisAlignedBox kBoxBehindRing{ { 1.18f, -0.02f, -0.55f },
+                                         { 1.22f, 0.02f, -0.45f } };
+
+glm::mat4x4 createClipTransform()
+{
+  const auto view = glm::lookAt(
+      glm::vec3(0.f, 0.f, kCameraDistance),
+      glm::vec3(0.f),
+      glm::vec3(0.f, 1.f, 0.f));
+  return calculateProjectionTransform(kFramebufferSize) * view;
+}
+
+OcclusionBuffer rasterizeOccluder(const Torus& torus, const size_t lodLevel)
+{
+  const auto& lod = torus.lods[lodLevel];
+  OcclusionBuffer occlusionBuffer;
+  occlusionBuffer.resize(kFramebufferSize);
+  occlusionBuffer.addOccluder(
+      torus.vertices,
+      std::span(torus.indices).subspan(lod.indicesOffset, lod.indicesCount),
+      createClipTransform());
+  occlusionBuffer.rasterize();
+  return occlusionBuffer;
+}
+}  // namespace
+
+TEST(OcclusionCullingTest, CoarsestLodBridgesTheHole)
+{
+  const Torus torus;
+  ASSERT_GT(torus.lods.size(), 1);
+
+  const auto full = rasterizeOccluder(torus, 0);
+  EXPECT_TRUE(full.isVisible(kBoxInHole, createClipTransform()));
+
+  // Without it the test below would not test anything
+  const auto coarsest = rasterizeOccluder(torus, torus.lods.size() - 1);
+  EXPECT_FALSE(coarsest.isVisible(kBoxInHole, createClipTransform()));
+}
+
+TEST(OcclusionCullingTest, OccluderLodKeepsTheHoleOpen)
+{
+  const Torus torus;
+  OcclusionBuffer sizedBuffer;
+  sizedBuffer.resize(kFramebufferSize);
+  const auto lodLevel = sizedBuffer.selectOccluderLod(
+      torus.lods, kCameraDistance - Torus::kMinorRadius);
+
+  const auto occlusionBuffer = rasterizeOccluder(torus, lodLevel);
+  EXPECT_TRUE(occlusionBuffer.isVisible(kBoxInHole, createClipTransform()));
+  EXPECT_FALSE(
+      occlusionBuffer.isVisible(kBoxBehindRing, createClipTransform()));
+}
+
+TEST(OcclusionCullingTest, FarOccluderUsesCoarserLod)
+{
+  const Torus torus;
+  OcclusionBuffer occlusionBuffer;
+  occlusionBuffer.resize(kFramebufferSize);
+  EXPECT_EQ(occlusionBuffer.selectOccluderLod(torus.lods, 0.f), 0);
+  EXPECT_EQ(
+      occlusionBuffer.selectOccluderLod(torus.lods, 1000.f),
+      torus.lods.size() - 1);
+}
+
+}  // namespace Simple3D